@@ -43,7 +43,15 @@ public:
     void set_basis_unsafe(const std::vector<std::vector<uint8_t>>& spin_ops);
     void set_basis_from_file(std::string& file);
     void set_basis_default();
-    int set_basis_random();
+
+    /**
+     * Set a random basis by drawing random operators until they are linearly independent.
+     * 
+     * @param seed                  Seed of the random basis (a negative seed gives a different basis every time, default).
+     * 
+     * @return The number of random sets of operators that were drawn.
+     */
+    int set_basis_random(long long seed = -1);
 
     void gt_data_in_place(Data& data);
     Data gt_data(const Data& data);
@@ -57,6 +57,15 @@ public:
      */
     double calc_log_ev_icc(__uint128_t component);
 
+    /**
+     * Calculate the part of the log evidence of a component that only depends on its size.
+     * 
+     * @param r                     Number of variables in the component.
+     * 
+     * @return prefactor            The contribution of the prior to the log evidence as a double.
+     */
+    double calc_log_ev_prefactor(int r);
+
     /**
      * Calculate the log evidence of a given partition.
      * 
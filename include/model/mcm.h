@@ -36,8 +36,9 @@ public:
      *                                  -"independent": all variables in a separate component
      *                                  -"complete": all variables in a single component
      *                                  -"random": each variable is assigned to a random component
+     * @param seed                  Seed of the random partition (a negative seed gives a different partition every time, default).
      */
-    MCM(int n, std::string partition);
+    MCM(int n, std::string partition, long long seed = -1);
     
     /**
      * Returns the current partition
@@ -82,8 +83,9 @@ public:
      * @param N                     The number of samples that need to be generated.
      * @param data                  The dataset from which the model parameters are inferred.
      * @param file_name             Path to the file that will contain the generated data.
+     * @param seed                  Seed of the samples (a negative seed gives different samples every time, default).
      */
-    void generate_data_file(int N, const Data& data, const std::string& file_name);
+    void generate_data_file(int N, const Data& data, const std::string& file_name, long long seed = -1);
 
     /**
      * Generate N samples from this MCM combined with a given dataset.
@@ -91,10 +93,11 @@ public:
      * 
      * @param N                     The number of samples that need to be generated.
      * @param data                  The dataset from which the model parameters are inferred.
+     * @param seed                  Seed of the samples (a negative seed gives different samples every time, default).
      * 
      * @return samples              Data object containing the generated samples as the dataset.
      */
-    Data generate_data_object(int N, const Data& data);
+    Data generate_data_object(int N, const Data& data, long long seed = -1);
 
     int n; // Number of variables present in the system
     int n_comp; // Number of non-empty components in the partition
@@ -106,4 +109,5 @@ public:
     std::vector<double> log_ev_per_icc;
 
     bool optimized; // Indicates if a search for the best mcm has been ran
+    bool truncated; // Indicates that the search was stopped (time limit or cancellation) before it finished
 };
\ No newline at end of file
@@ -4,6 +4,148 @@
 
 #include "utilities/miscellaneous.h"
 
+/**
+ * Indexable sets of the components of a partition that is changed by the moves of the simulated annealing.
+ * The occupied components, the components with at least two units, the empty components and the units of every component
+ * are stored in arrays with their positions, such that a uniform random element is drawn and an element is added or removed in constant time.
+ * A unit is a single variable, unless the index is built for groups of variables that are never separated (see build).
+ * The memory is allocated once by build, the moves don't allocate.
+ */
+class ComponentIndex {
+public:
+    /**
+     * Rebuilds the index for a partition, every variable is a unit.
+     *
+     * @param partition             Partition as a vector of n integers representing the components.
+     */
+    void build(const std::vector<__uint128_t>& partition);
+
+    /**
+     * Rebuilds the index for a partition of groups of variables. The moves drawn from the index split, merge and switch whole groups.
+     *
+     * @param partition             Partition as a vector of n integers representing the components (every group is inside one component).
+     * @param units                 Groups of variables that are never separated (every variable is in exactly one group).
+     */
+    void build(const std::vector<__uint128_t>& partition, const std::vector<__uint128_t>& units);
+
+    int n_occupied() const {return this->occupied.size;};
+    int n_splittable() const {return this->splittable.size;};
+    int n_units() const {return this->units.size();};
+    int size(int comp) const {return this->comp_size[comp];};
+    int component_of(int var) const {return this->unit_comp[this->var_unit[var]];};
+    __uint128_t unit(int u) const {return this->units[u];};
+    __uint128_t occupied_mask() const {return this->mask;};
+    int empty_component() const {return this->empty[this->n_empty - 1];};
+
+    int random_occupied(RandomGenerator& generator) const {return this->occupied.random(generator);};
+    int random_splittable(RandomGenerator& generator) const {return this->splittable.random(generator);};
+    int random_unit(int comp, RandomGenerator& generator) const {return this->members[comp * this->n + generator.uniform_int(this->comp_size[comp])];};
+
+    /**
+     * Returns a random occupied component that differs from a given one (at least two components should be occupied).
+     */
+    int random_other_occupied(int comp, RandomGenerator& generator) const;
+
+    /**
+     * Returns a random split of a component with at least two units.
+     * Every subset of the units of the component other than the empty set and the full component has the same probability.
+     *
+     * @param comp                  Index of the component.
+     * @param generator             Random number generator.
+     *
+     * @return The variables of one of the two parts.
+     */
+    __uint128_t random_split(int comp, RandomGenerator& generator) const;
+
+    /**
+     * Returns the components that contain at least one of the given variables.
+     */
+    __uint128_t components_of(__uint128_t variables) const;
+
+    // Updates after an accepted move (a split moves variables to empty_component())
+    void merge(int comp_1, int comp_2);
+    void split(int comp, int new_comp, __uint128_t moved);
+    void move(int unit, int to);
+
+private:
+    // Elements in an array together with their position in the array (-1 if absent)
+    struct IndexableSet {
+        std::vector<int> elements;
+        std::vector<int> position;
+        int size = 0;
+
+        void reset(int n) {this->elements.assign(n, 0); this->position.assign(n, -1); this->size = 0;};
+        bool contains(int x) const {return this->position[x] >= 0;};
+        void insert(int x);
+        void erase(int x);
+        int random(RandomGenerator& generator) const {return this->elements[generator.uniform_int(this->size)];};
+    };
+
+    void add_unit(int unit, int comp);
+    void remove_unit(int unit);
+
+    int n = 0;
+    IndexableSet occupied;
+    IndexableSet splittable;
+    // Free list of the empty components
+    std::vector<int> empty;
+    int n_empty = 0;
+    // Variables of every unit and the unit of every variable
+    std::vector<__uint128_t> units;
+    std::vector<int> var_unit;
+    // Units of every component (n entries per component) and the position of every unit
+    std::vector<int> members;
+    std::vector<int> member_pos;
+    std::vector<int> comp_size;
+    std::vector<int> unit_comp;
+    __uint128_t mask = 0;
+};
+
+/**
+ * Cooling schedules of the simulated annealing. The temperature is updated every get_SA_update_schedule() iterations,
+ * t is the number of iterations since the start of the schedule (or since the last reheat) and T_s the temperature at that start.
+ */
+enum class CoolingSchedule {
+    logarithmic,    // T = T_s / (1 + log(1 + t))
+    geometric,      // T = T_s * rate^(t / update_schedule)
+    linear,         // T decreases linearly from T_s to the minimum temperature at the last iteration
+    adaptive        // T is multiplied or divided by the rate to follow a target acceptance rate that decreases linearly to zero
+};
+
+/**
+ * Struct containing a move of the simulated annealing that is proposed from the current partition.
+ * Every move replaces two components by new ones: a merge empties the second component,
+ * a split moves a part of the first component to an empty component.
+ * 
+ * @struct SA_move
+ * 
+ * @var SA_move::comp_1
+ *  Integer indicating the index of the first changed component.
+ * 
+ * @var SA_move::comp_2
+ *  Integer indicating the index of the second changed component.
+ * 
+ * @var SA_move::new_comp_1
+ *  New variables of the first component.
+ * 
+ * @var SA_move::new_comp_2
+ *  New variables of the second component (0 for a merge).
+ * 
+ * @var SA_move::type
+ *  Integer indicating the type of the move (0: merge, 1: split, 2: switch of the unit, -1: no valid move was found).
+ * 
+ * @var SA_move::unit
+ *  Integer indicating the unit that is switched to the second component (a single variable unless the annealing runs on groups).
+ */
+struct SA_move {
+    int comp_1;
+    int comp_2;
+    __uint128_t new_comp_1;
+    __uint128_t new_comp_2;
+    int type = -1;
+    int unit;
+};
+
 /**
  * Struct containing the parameter settings of the simulated annealing algorithm
  * 
@@ -12,24 +154,60 @@
  * @var SA_settings::temp
  *  Double indicating the current temperature.
  * 
+ * @var SA_settings::start_temp
+ *  Double indicating the temperature at the start of the cooling schedule (the initial temperature or the temperature of the last reheat).
+ * 
+ * @var SA_settings::start_iteration
+ *  Integer indicating the iteration at which the cooling schedule started.
+ * 
+ * @var SA_settings::best_temp
+ *  Double indicating the temperature at which the best partition was last improved.
+ * 
+ * @var SA_settings::n_reheats
+ *  Integer indicating the number of times the temperature has been raised after a stagnation.
+ * 
+ * @var SA_settings::window_accepted
+ *  Integer indicating the number of accepted moves since the last update of the temperature.
+ * 
  * @var SA_settings::epsilon
  *  Double indicating the precision that is used when comparing the log evidence of two partitions.
  * 
  * @var SA_settings::max_no_improve
- *  Integer indicating the number of iterations without improvement after which the algorithm stops.
+ *  Integer indicating the number of iterations without improvement after which the algorithm reheats or stops.
+ * 
+ * @var SA_settings::index
+ *  Index of the components of the current partition from which the moves are drawn (rebuilt from the partition, not stored in checkpoints).
+ * 
+ * @var SA_settings::iteration
+ *  Integer indicating the next iteration of the annealing loop (used to resume from a checkpoint).
+ * 
+ * @var SA_settings::steps_since_improve
+ *  Integer indicating the number of iterations since the last improvement of the best partition.
  * 
- * @var SA_settings::occupied_comp
- *  128bit integer for which the corresponding binary string has the ith bit set to 1 if the ith component is non-empty and zero otherwise.
+ * @var SA_settings::n_accepted
+ *  Integer indicating the number of accepted moves since the last update of the acceptance rate.
  * 
- * @var SA_settings::occupied_comp2
- *  128bit integer for which the corresponding binary string has the ith bit set to 1 if the ith component contains at least 2 variables and zero otherwise. 
+ * @var SA_settings::acceptance_rate
+ *  Vector containing the acceptance rate over every 1000 iterations.
+ * 
+ * @var SA_settings::generator
+ *  Random number generator of the moves and their acceptance.
  */
 struct SA_settings {
     double temp;
+    double start_temp;
+    int start_iteration = 0;
+    double best_temp;
+    int n_reheats = 0;
+    int window_accepted = 0;
     double epsilon = 1e-4;
     int max_no_improve = 10000;
-    __uint128_t occupied_comp = 0;
-    __uint128_t occupied_comp2 = 0;
+    ComponentIndex index;
+    int iteration = 0;
+    int steps_since_improve = 0;
+    int n_accepted = 0;
+    std::vector<double> acceptance_rate;
+    RandomGenerator generator;
 
     /**
      * Constructs a SA_settings struct
@@ -37,21 +215,57 @@ struct SA_settings {
      * @param T0            Initial temperature.
      * @param partition     Starting partition.
      */
-    SA_settings(int T0, std::vector<__uint128_t>& partition) {
+    SA_settings(double T0, std::vector<__uint128_t>& partition) {
         this->temp = T0;
-        
-        int r;
-        int n = partition.size();
-        __uint128_t element = 1;
-        for (int i = 0; i < n; i++){
-            r = bit_count(partition[i]);
-            if (r > 0){
-                this->occupied_comp += element;
-            }
-            if (r > 1){
-                this->occupied_comp2 += element;
-            }
-            element <<= 1;
-        }
+        this->start_temp = T0;
+        this->best_temp = T0;
+        this->index.build(partition);
     }
-};
\ No newline at end of file
+};
+/**
+ * Struct containing the annealing settings that are chosen by the automatic tuning and the statistics of the pilot runs.
+ * 
+ * @struct SA_tuning
+ * 
+ * @var SA_tuning::merge_delta
+ *  Median decrease of the log-evidence of the worsening merge moves in the random walks.
+ * 
+ * @var SA_tuning::split_delta
+ *  Median decrease of the log-evidence of the worsening split moves in the random walks.
+ * 
+ * @var SA_tuning::switch_delta
+ *  Median decrease of the log-evidence of the worsening switch moves in the random walks.
+ * 
+ * @var SA_tuning::init_temp
+ *  Chosen initial temperature.
+ * 
+ * @var SA_tuning::min_temp
+ *  Chosen final temperature of the geometric schedule.
+ * 
+ * @var SA_tuning::cooling_rate
+ *  Chosen cooling rate of the geometric schedule.
+ * 
+ * @var SA_tuning::update_schedule
+ *  Chosen number of iterations between two temperature updates.
+ * 
+ * @var SA_tuning::max_iter
+ *  Chosen number of iterations.
+ * 
+ * @var SA_tuning::pilot_budgets
+ *  Number of iterations of the pilot chains at every stage.
+ * 
+ * @var SA_tuning::pilot_log_evidences
+ *  Mean final log-evidence of the pilot chains at every stage.
+ */
+struct SA_tuning {
+    double merge_delta = 0;
+    double split_delta = 0;
+    double switch_delta = 0;
+    double init_temp = 0;
+    double min_temp = 0;
+    double cooling_rate = 0;
+    int update_schedule = 0;
+    int max_iter = 0;
+    std::vector<int> pilot_budgets;
+    std::vector<double> pilot_log_evidences;
+};
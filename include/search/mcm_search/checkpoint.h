@@ -0,0 +1,144 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+#include "model/mcm.h"
+#include "annealing.h"
+#include "evidence_cache.h"
+
+/**
+ * Identifiers of the search methods that can be stored in a checkpoint.
+ */
+enum class CheckpointMethod {
+    exhaustive = 0,
+    greedy = 1,
+    divide_and_conquer = 2,
+    simulated_annealing = 3,
+    parallel_tempering = 4
+};
+
+/**
+ * Records that extend a log next to a checkpoint. The checkpoint only contains the number of records in the log,
+ * such that data that grows during the search (the evidence cache, the trajectory) is not written again at every checkpoint.
+ *
+ * @struct CheckpointLog
+ *
+ * @var CheckpointLog::file_name
+ *  String containing the path to the log.
+ *
+ * @var CheckpointLog::records
+ *  String containing the serialized records that are appended to the log.
+ *
+ * @var CheckpointLog::restart
+ *  Boolean indicating whether the log is rewritten instead of extended.
+ */
+struct CheckpointLog {
+    std::string file_name;
+    std::string records;
+    bool restart = false;
+};
+
+/**
+ * Writes checkpoints to disk on a background thread such that the search does not wait for the file system.
+ * The checkpoint is first written to a temporary file which then replaces the previous checkpoint,
+ * so a job that is killed while writing always leaves a complete checkpoint behind.
+ * The logs of a checkpoint are extended before the checkpoint that refers to them is written.
+ */
+class CheckpointWriter {
+public:
+    CheckpointWriter() {};
+    ~CheckpointWriter() {this->wait();};
+
+    /**
+     * Writes a serialized checkpoint to a file. Waits for the previous write to finish first.
+     * Once a log could not be extended, no further checkpoints are written (they would refer to missing records).
+     *
+     * @param file_name             Path to the checkpoint file.
+     * @param buffer                Serialized checkpoint.
+     * @param logs                  Records to append to the logs of the checkpoint.
+     */
+    void write(const std::string& file_name, std::string buffer, std::vector<CheckpointLog> logs = std::vector<CheckpointLog>());
+
+    /**
+     * Waits until the last checkpoint has been written.
+     */
+    void wait() {if (this->writer.joinable()){this->writer.join();}};
+
+private:
+    std::thread writer;
+    // Set by the background thread if a log could not be extended (read after joining it)
+    bool failed = false;
+};
+
+/********************************
+* Binary serialization helpers *
+********************************/
+
+template <typename T>
+void write_binary(std::ostream& stream, const T& value){
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void read_binary(std::istream& stream, T& value){
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    if (! stream){
+        throw std::runtime_error("The checkpoint file is incomplete or corrupted.");
+    }
+}
+
+template <typename T>
+void write_binary(std::ostream& stream, const std::vector<T>& vector){
+    unsigned long long size = vector.size();
+    write_binary(stream, size);
+    if (size){
+        stream.write(reinterpret_cast<const char*>(vector.data()), size * sizeof(T));
+    }
+}
+
+template <typename T>
+void read_binary(std::istream& stream, std::vector<T>& vector){
+    unsigned long long size;
+    read_binary(stream, size);
+    vector.resize(size);
+    if (size){
+        stream.read(reinterpret_cast<char*>(vector.data()), size * sizeof(T));
+        if (! stream){
+            throw std::runtime_error("The checkpoint file is incomplete or corrupted.");
+        }
+    }
+}
+
+void write_binary(std::ostream& stream, const std::string& string);
+void read_binary(std::istream& stream, std::string& string);
+
+/**
+ * Serialize entries of the evidence cache as records of a checkpoint log.
+ *
+ * @param entries               Entries of the cache.
+ *
+ * @return The records of the entries.
+ */
+std::string cache_log_records(const std::vector<std::pair<__uint128_t, double>>& entries);
+
+/**
+ * Insert the entries of a checkpoint log into the evidence cache.
+ * The records that were appended after the checkpoint are removed from the log, such that it can be extended again.
+ *
+ * @param log_name              Path to the log.
+ * @param n_entries             Number of entries in the log at the time of the checkpoint.
+ * @param cache                 Cache to which the entries are added.
+ */
+void read_cache_log(const std::string& log_name, unsigned long long n_entries, EvidenceCache& cache);
+
+void write_binary(std::ostream& stream, const MCM& mcm);
+void read_binary(std::istream& stream, MCM& mcm);
+
+void write_binary(std::ostream& stream, const SA_settings& settings);
+void read_binary(std::istream& stream, SA_settings& settings);
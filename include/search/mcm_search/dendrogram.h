@@ -0,0 +1,85 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "model/mcm.h"
+
+/**
+ * Struct containing one merge of the hierarchical merging procedure.
+ * 
+ * @struct DendrogramStep
+ * 
+ * @var DendrogramStep::i
+ *  Integer indicating the index of the component that contains the merged component afterwards.
+ * 
+ * @var DendrogramStep::j
+ *  Integer indicating the index of the component that is emptied by the merge (i < j).
+ * 
+ * @var DendrogramStep::log_ev_merged
+ *  Double indicating the log-evidence of the merged component.
+ * 
+ * @var DendrogramStep::log_ev
+ *  Double indicating the log-evidence of the partition after the merge.
+ */
+struct DendrogramStep {
+    int i;
+    int j;
+    double log_ev_merged;
+    double log_ev;
+};
+
+/**
+ * Merge tree of the hierarchical merging procedure.
+ *
+ * The tree stores the partition in which the merging started and every merge in order, such that the partition
+ * at any level of the tree can be read out without running another search.
+ */
+class Dendrogram {
+public:
+    Dendrogram() : n(0), base_log_ev(0), best_n_merges(0) {};
+
+    /**
+     * Start a new tree from the partition in which the merging starts.
+     * 
+     * @param mcm                   Starting partition with the log-evidence of every component.
+     */
+    void start(const MCM& mcm);
+
+    /**
+     * Add the next merge to the tree.
+     * 
+     * @param step                  Merged components and log-evidences after the merge.
+     * @param improvement           True if the merge increases the log-evidence and belongs to the result of the search.
+     */
+    void add(const DendrogramStep& step, bool improvement);
+
+    /**
+     * Returns the partition after the first merges of the tree.
+     * The indices of the components are the ones used by the merging procedure (empty components are not moved to the end).
+     * 
+     * @param n_merges              Number of merges (between 0 and the number of merges in the tree).
+     * 
+     * @return MCM with the partition and the log-evidence of every component at this level of the tree.
+     */
+    MCM cut(int n_merges) const;
+
+    const std::vector<DendrogramStep>& get_steps() const {return this->steps;};
+    int get_n_merges() const {return this->steps.size();};
+
+    // Number of merges in the partition with the largest log-evidence (the result of the greedy merging)
+    int get_best_n_merges() const {return this->best_n_merges;};
+
+    void clear();
+    void save(std::ostream& stream) const;
+    void load(std::istream& stream);
+
+private:
+    int n;
+    std::vector<__uint128_t> base_partition;
+    std::vector<double> base_log_ev_per_icc;
+    double base_log_ev;
+
+    std::vector<DendrogramStep> steps;
+    int best_n_merges;
+};
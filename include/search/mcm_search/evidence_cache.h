@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <utility>
+
+#include "data/dataset.h"
+#include "utilities/miscellaneous.h"
+
+/**
+ * Cache of the log-evidence of components that can be shared by several worker threads.
+ *
+ * The cache is divided into shards that each have their own lock, such that threads that look up different components rarely wait for each other.
+ * The evidence of a component that is not in the cache is calculated without holding a lock.
+ * Two threads may therefore calculate the same component at the same time, which gives the same value.
+ */
+class EvidenceCache {
+public:
+    /**
+     * Constructs an empty cache.
+     *
+     * @param n_shards              Number of independently locked parts of the cache.
+     */
+    EvidenceCache(int n_shards = 64);
+
+    /**
+     * Returns the log-evidence of a component, which is calculated and stored if it is not in the cache yet.
+     *
+     * @param component             Integer representation of the component.
+     * @param data                  Dataset used to calculate the log-evidence.
+     *
+     * @return Log-evidence of the component.
+     */
+    double get(__uint128_t component, Data& data);
+
+    /**
+     * Looks up the log-evidence of a component without calculating it.
+     *
+     * @param component             Integer representation of the component.
+     * @param log_ev                Set to the log-evidence of the component if it is found.
+     *
+     * @return True if the component is in the cache.
+     */
+    bool find(__uint128_t component, double& log_ev) const;
+
+    void insert(__uint128_t component, double log_ev);
+    void clear();
+    size_t size() const;
+
+    /**
+     * Returns all entries of the cache in no particular order (used to write checkpoints).
+     */
+    std::vector<std::pair<__uint128_t, double>> entries() const;
+
+    /**
+     * Start collecting the entries that are inserted from now on, such that a checkpoint only has to write the new entries.
+     * The collection stops when the cache is cleared.
+     */
+    void track_insertions();
+    bool is_tracking() const;
+
+    /**
+     * Returns the entries that were inserted since the previous call (or since track_insertions) and releases them.
+     */
+    std::vector<std::pair<__uint128_t, double>> take_insertions();
+
+private:
+    struct Shard {
+        std::unordered_map<__uint128_t, double, Hash128> storage;
+        bool tracking = false;
+        std::vector<std::pair<__uint128_t, double>> inserted;
+        mutable std::mutex mutex;
+    };
+    // Shards are allocated separately such that the cache can be moved
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Shard& shard_of(__uint128_t component) const {return *this->shards[Hash128()(component) % this->shards.size()];};
+};
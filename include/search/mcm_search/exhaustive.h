@@ -3,24 +3,255 @@
 #include "mcm_search.h"
 #include "utilities/partition.h"
 
+#include <iostream>
+
+/**
+ * Struct containing the state of an exhaustive search that is divided into tasks based on prefixes of the restricted growth strings.
+ * 
+ * @struct ES_state
+ * 
+ * @var ES_state::prefixes
+ *  Vector containing the prefix of each task in enumeration order.
+ * 
+ * @var ES_state::done
+ *  Vector indicating which tasks are finished.
+ * 
+ * @var ES_state::best_log_ev
+ *  Vector containing the largest log-evidence found by each finished task.
+ * 
+ * @var ES_state::best_partition
+ *  Vector containing the best partition found by each finished task.
+ * 
+ * @var ES_state::trajectories
+ *  Vector containing the part of the trajectory recorded by each task.
+ * 
+ * @var ES_state::n_appended
+ *  Integer indicating the number of leading tasks that are finished and whose part is appended to the trajectory of the search.
+ * 
+ * @var ES_state::best_partitions
+ *  Collector of the k best partitions found by the finished tasks.
+ * 
+ * @var ES_state::store_trajectory
+ *  Boolean indicating whether the tasks record the log-evidence trajectory.
+ * 
+ * @var ES_state::in_shard
+ *  Vector indicating which tasks belong to the shard of this search (all of them if the search is not sharded).
+ * 
+ * @var ES_state::summaries
+ *  Vector containing the summary statistics of the log-evidences encountered by each finished task (only for sharded searches).
+ * 
+ * @var ES_state::max_size
+ *  Integer indicating the maximum number of variables in a component (0 if there is no maximum).
+ * 
+ * @var ES_state::shard
+ *  Integer indicating the index of the shard that is searched.
+ * 
+ * @var ES_state::n_shards
+ *  Integer indicating the number of shards in which the search is divided.
+ * 
+ * @var ES_state::result_file
+ *  String containing the path to the file to which the result of the shard is written (not written if empty).
+ */
+struct ES_state {
+    std::vector<std::vector<int>> prefixes;
+    std::vector<char> done;
+    std::vector<double> best_log_ev;
+    std::vector<std::vector<__uint128_t>> best_partition;
+    std::vector<TrajectoryRecorder> trajectories;
+    int n_appended = 0;
+    TopKPartitions best_partitions;
+    bool store_trajectory;
+    std::vector<char> in_shard;
+    std::vector<TrajectorySummary> summaries;
+    int max_size = 0;
+    int shard = 0;
+    int n_shards = 1;
+    std::string result_file;
+};
+
+/**
+ * Struct containing the result of one shard of an exhaustive search that is divided over independent processes.
+ * 
+ * @struct ES_shard_result
+ * 
+ * @var ES_shard_result::n, q, N, N_unique, N_synthetic
+ *  Statistics of the dataset on which the shard was searched.
+ * 
+ * @var ES_shard_result::shard
+ *  Integer indicating the index of the shard.
+ * 
+ * @var ES_shard_result::n_shards
+ *  Integer indicating the number of shards in which the search is divided.
+ * 
+ * @var ES_shard_result::max_size
+ *  Integer indicating the maximum number of variables in a component (0 if there is no maximum).
+ * 
+ * @var ES_shard_result::best_task
+ *  Integer indicating the index of the task that contains the best partition (used to break ties in enumeration order).
+ * 
+ * @var ES_shard_result::best_log_ev
+ *  Double indicating the largest log-evidence in the shard.
+ * 
+ * @var ES_shard_result::best_partition
+ *  Vector containing the partition with the largest log-evidence in the shard.
+ * 
+ * @var ES_shard_result::summary
+ *  Summary statistics of the log-evidence of all partitions in the shard.
+ * 
+ * @var ES_shard_result::best_partitions
+ *  Collector of the k best partitions in the shard.
+ */
+struct ES_shard_result {
+    int n, q, N, N_unique, N_synthetic;
+    int shard;
+    int n_shards;
+    int max_size;
+    int best_task;
+    double best_log_ev;
+    std::vector<__uint128_t> best_partition;
+    TrajectorySummary summary;
+    TopKPartitions best_partitions;
+};
+
+/**
+ * Writes the result of a shard of the exhaustive search to a binary file.
+ * 
+ * @param file_name             Path to the result file.
+ * @param result                Result of the shard.
+ */
+void write_shard_result(const std::string& file_name, const ES_shard_result& result);
+
+/**
+ * Reads the result of a shard of the exhaustive search from a binary file.
+ * 
+ * @param file_name             Path to the result file.
+ * 
+ * @return Result of the shard.
+ */
+ES_shard_result read_shard_result(const std::string& file_name);
+
+/**
+ * Determines to which shard each task of a sharded exhaustive search belongs.
+ * The shards are assigned to short prefixes that only depend on the number of shards (and not on the number of threads of each process).
+ * 
+ * @param prefixes              Prefixes of the tasks of the search.
+ * @param n                     Number of variables.
+ * @param n_shards              Number of shards.
+ * 
+ * @return Vector containing the shard of each task.
+ */
+std::vector<int> assign_prefixes_to_shards(const std::vector<std::vector<int>>& prefixes, int n, int n_shards);
+
+// Checkpoint serialization of the state of an exhaustive search (only finished tasks are stored)
+void write_binary(std::ostream& stream, ES_state& state);
+void read_binary(std::istream& stream, ES_state& state);
+
 /**
  * Helper function for the exhaustive search that updates the partition.
  * 
  * @param a                     Array of size n that represents the partition as a restricted growth string.
  * @param b                     Array of size n that keeps track of how many partitions each variable can move to.
  * @param n                     Number of variables.
+ * @param prefix_length         Number of leading entries of the restricted growth string that are kept fixed (default is 1, i.e. all partitions).
  * 
  * @return 1 if next partition is generated, 0 if all partitions are generated.
  */
 
-int generate_next_partition(int* a, int* b, int n);
+int generate_next_partition(int* a, int* b, int n, int prefix_length = 1);
 /**
  * Helper function for generating partition that updates the partition.
  * 
  * @param a                     Array of size n.
  * @param b                     Array of size n.
  * @param n                     Size of the arrays.
+ * @param prefix_length         Number of leading entries that are kept fixed (default is 1).
+ * 
+ * @return Index of the first bit from right to left that is different between a and b (smaller than prefix_length if there is none).
+ */
+int find_j(int* a, int* b, int n, int prefix_length = 1);
+
+/**
+ * Generates all prefixes of restricted growth strings of the smallest length for which there are at least a given number of them.
+ * Each prefix defines an independent part of the space of partitions which is used to divide the exhaustive search over workers.
+ * 
+ * @param n                     Number of variables.
+ * @param min_prefixes          Minimum number of prefixes that should be generated (unless all n entries are already fixed).
+ * 
+ * @return Vector of prefixes in the order in which the exhaustive search enumerates them.
+ */
+std::vector<std::vector<int>> generate_partition_prefixes(int n, int min_prefixes);
+
+/**
+ * Initializes the arrays a and b to the first partition that starts with a given prefix.
+ * 
+ * @param prefix                Prefix of the restricted growth string.
+ * @param a                     Array of size n that will represent the partition as a restricted growth string.
+ * @param b                     Array of size n that keeps track of how many partitions each variable can move to.
+ * @param n                     Number of variables.
+ */
+void init_partition_with_prefix(const std::vector<int>& prefix, int* a, int* b, int n);
+
+/**
+ * Counts the number of partitions whose restricted growth string starts with a given prefix.
+ * 
+ * @param prefix                Prefix of the restricted growth string.
+ * @param n                     Number of variables.
+ * @param max_size              Maximum number of variables in a component (default is 0, i.e. no maximum).
+ * 
+ * @return Number of partitions of n variables that start with the prefix.
+ */
+unsigned long long count_partitions_with_prefix(const std::vector<int>& prefix, int n, int max_size = 0);
+
+/**
+ * Counts the number of partitions whose restricted growth string starts with a given prefix and whose components contain at most max_size variables.
  * 
- * @return Index of the first bit from right to left that is different between a and b.
+ * @param prefix                Prefix of the restricted growth string.
+ * @param n_comp                Number of components used by the prefix.
+ * @param n                     Number of variables.
+ * @param max_size              Maximum number of variables in a component.
+ * 
+ * @return Number of admissible partitions of n variables that start with the prefix.
+ */
+unsigned long long count_capped_partitions_with_prefix(const std::vector<int>& prefix, int n_comp, int n, int max_size);
+
+/**
+ * Initializes the arrays to the first partition that starts with a given prefix and whose components contain at most max_size variables.
+ * 
+ * @param prefix                Prefix of the restricted growth string.
+ * @param a                     Array of size n that will represent the partition as a restricted growth string.
+ * @param b                     Array of size n that keeps track of how many partitions each variable can move to.
+ * @param sizes                 Array of size n that will contain the number of variables in each component.
+ * @param n                     Number of variables.
+ * @param max_size              Maximum number of variables in a component.
+ * 
+ * @return False if the prefix itself contains a component with more than max_size variables, true otherwise.
+ */
+bool init_capped_partition_with_prefix(const std::vector<int>& prefix, int* a, int* b, int* sizes, int n, int max_size);
+
+/**
+ * Generates the next partition in which every component contains at most max_size variables.
+ * Partitions with larger components are never generated: the restricted growth strings are pruned as soon as a component is full.
+ * The admissible partitions are generated in the same order as by generate_next_partition.
+ * 
+ * @param a                     Array of size n that represents the partition as a restricted growth string.
+ * @param b                     Array of size n that keeps track of how many partitions each variable can move to.
+ * @param sizes                 Array of size n containing the number of variables in each component.
+ * @param n                     Number of variables.
+ * @param max_size              Maximum number of variables in a component.
+ * @param prefix_length         Number of leading entries of the restricted growth string that are kept fixed.
+ * 
+ * @return 1 if next partition is generated, 0 if all admissible partitions are generated.
+ */
+int generate_next_capped_partition(int* a, int* b, int* sizes, int n, int max_size, int prefix_length = 1);
+
+/**
+ * Helper function for the capped enumeration that places the variables from index start onwards in the first component that is not full.
+ * 
+ * @param a                     Array of size n that represents the partition as a restricted growth string.
+ * @param b                     Array of size n that keeps track of how many partitions each variable can move to.
+ * @param sizes                 Array of size n containing the number of variables in each component.
+ * @param n                     Number of variables.
+ * @param max_size              Maximum number of variables in a component.
+ * @param start                 Index of the first variable to place (at least 1).
  */
-int find_j(int* a, int* b, int n);
+void fill_capped_partition(int* a, int* b, int* sizes, int n, int max_size, int start);
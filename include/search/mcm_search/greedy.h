@@ -0,0 +1,73 @@
+#pragma once
+
+#include "mcm_search.h"
+
+#include <queue>
+
+/**
+ * Struct containing a candidate merge of two components in the hierarchical merging procedure.
+ * 
+ * @struct MergeCandidate
+ * 
+ * @var MergeCandidate::gain
+ *  Double indicating the increase in log-evidence when merging the two components.
+ * 
+ * @var MergeCandidate::log_ev
+ *  Double indicating the log-evidence of the merged component.
+ * 
+ * @var MergeCandidate::i
+ *  Integer indicating the index of the first component (i < j).
+ * 
+ * @var MergeCandidate::j
+ *  Integer indicating the index of the second component.
+ * 
+ * @var MergeCandidate::version_i
+ *  Integer indicating the version of component i when the gain was calculated.
+ * 
+ * @var MergeCandidate::version_j
+ *  Integer indicating the version of component j when the gain was calculated.
+ * 
+ * @var MergeCandidate::bound
+ *  Boolean indicating that the gain is only an upper bound, the merged component has not been evaluated yet.
+ */
+struct MergeCandidate {
+    double gain;
+    double log_ev;
+    int i;
+    int j;
+    int version_i;
+    int version_j;
+    bool bound;
+};
+
+/**
+ * Ordering of the merge candidates in the priority queue: true if candidate a is worse than candidate b.
+ * A larger gain is better, ties are broken on the smallest pair of indices (the order in which a full scan over the pairs encounters them).
+ */
+struct WorseMerge {
+    bool operator()(const MergeCandidate& a, const MergeCandidate& b) const {
+        if (a.gain != b.gain){
+            return a.gain < b.gain;
+        }
+        if (a.i != b.i){
+            return a.i > b.i;
+        }
+        return a.j > b.j;
+    }
+};
+
+/**
+ * Upper bound on the increase in log-evidence when merging two components, without a pass over the data.
+ * 
+ * @param data                  Dataset for which the evidence is calculated.
+ * @param component_i           Integer representation of the first component.
+ * @param component_j           Integer representation of the second component.
+ * @param log_ev_i              Log-evidence of the first component.
+ * @param log_ev_j              Log-evidence of the second component.
+ * 
+ * @return Upper bound on log_ev(i + j) - log_ev(i) - log_ev(j).
+ */
+double merge_gain_bound(Data& data, __uint128_t component_i, __uint128_t component_j, double log_ev_i, double log_ev_j);
+
+// Priority queue with the best merge candidate on top
+typedef std::priority_queue<MergeCandidate, std::vector<MergeCandidate>, WorseMerge> MergeQueue;
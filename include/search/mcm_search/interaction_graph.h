@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+#include "data/dataset.h"
+
+/**
+ * Calculate the mutual information between every pair of variables in the dataset.
+ * For binary data, the joint counts are obtained with popcounts on bit planes of the variables,
+ * otherwise a q x q table is filled for every pair.
+ * 
+ * @param data                  Dataset for which the mutual information is calculated.
+ * @param n_threads             Number of threads over which the pairs are distributed.
+ * 
+ * @return Vector of n * n values where entry i * n + j is the mutual information between variable i and j in q-its (0 on the diagonal).
+ */
+std::vector<double> calc_mutual_information(Data& data, int n_threads = 1);
+
+/**
+ * Build a k-nearest-neighbour graph of the variables based on their mutual information.
+ * Two variables are connected if one of them is among the k variables with the largest mutual information with the other one.
+ * Ties are broken on the smallest index.
+ * 
+ * @param mutual_information    Matrix of n * n values obtained from calc_mutual_information.
+ * @param n                     Number of variables.
+ * @param k                     Number of neighbours of every variable.
+ * 
+ * @return Vector of n integers where the ith integer contains the neighbours of variable i.
+ */
+std::vector<__uint128_t> build_interaction_graph(const std::vector<double>& mutual_information, int n, int k);
+
+/**
+ * Returns all variables that are connected to at least one variable of a component.
+ * 
+ * @param graph                 Neighbours of every variable (see build_interaction_graph).
+ * @param component             Integer representation of the component.
+ * 
+ * @return Integer representation of the neighbours of the component.
+ */
+__uint128_t neighbourhood(const std::vector<__uint128_t>& graph, __uint128_t component);
@@ -5,12 +5,50 @@
 #include "data/dataset.h"
 #include "model/mcm.h"
 #include "annealing.h"
+#include "top_k.h"
+#include "trajectory.h"
+#include "checkpoint.h"
+#include "evidence_cache.h"
+#include "dendrogram.h"
+#include "interaction_graph.h"
+#include "stop_condition.h"
 
 #include "utilities/miscellaneous.h"
 #include "utilities/partition.h"
+#include "utilities/parallel.h"
 
 #include <random>
 #include <memory>
+#include <chrono>
+#include <functional>
+#include <mutex>
+
+struct ES_state;
+struct PT_state;
+
+/**
+ * Struct containing the number of candidate merges that were evaluated or pruned in the last hierarchical merging.
+ * 
+ * @struct MergeStatistics
+ * 
+ * @var MergeStatistics::n_candidates
+ *  Number of candidate merges of two components.
+ * 
+ * @var MergeStatistics::n_evaluated
+ *  Number of candidates for which the evidence of the merged component was calculated.
+ * 
+ * @var MergeStatistics::n_pruned_bound
+ *  Number of candidates that were skipped because the upper bound on their gain is not positive.
+ * 
+ * @var MergeStatistics::n_pruned_best
+ *  Number of candidates that were skipped because their upper bound stayed below the best gain until one of the components was merged.
+ */
+struct MergeStatistics {
+    unsigned long long n_candidates = 0;
+    unsigned long long n_evaluated = 0;
+    unsigned long long n_pruned_bound = 0;
+    unsigned long long n_pruned_best = 0;
+};
 
 class MCMSearch {
 public:
@@ -30,22 +68,533 @@ public:
     MCM get_mcm_out();
 
     // Search methods
-    MCM exhaustive_search(Data& data);
+    MCM exhaustive_search(Data& data, int shard = 0, int n_shards = 1, std::string result_file = "");
     MCM greedy_search(Data& data, MCM* init_mcm = nullptr, std::string file_name = "");
     MCM divide_and_conquer(Data& data, MCM* init_mcm = nullptr, std::string file_name = "");
     MCM simulated_annealing(Data& data, MCM* init_mcm = nullptr, std::string file_name = "");
 
+    /**
+     * Parallel tempering (replica exchange) with the moves of the simulated annealing.
+     * Every replica is a Markov chain at a fixed temperature of a geometric ladder between the minimum and the maximum temperature.
+     * The replicas run in parallel for a number of iterations after which neighbouring replicas swap their partitions with the Metropolis criterion.
+     * All replicas use the same evidence cache. Every replica does get_SA_max_iter() iterations.
+     * The best partition over all replicas is followed by the hierarchical merging, like the simulated annealing.
+     * 
+     * @param data                  Dataset for which the best partition is searched.
+     * @param init_mcm              Starting partition of all replicas (default is the independent model).
+     * @param file_name             Path to the output file (optional).
+     * 
+     * @return The best MCM found by the search.
+     */
+    MCM parallel_tempering(Data& data, MCM* init_mcm = nullptr, std::string file_name = "");
+
+    /**
+     * Simulated annealing with settings that are chosen from short pilot runs.
+     * Random walks in which every move is accepted measure the decrease of the log-evidence of worsening merge, split and switch moves.
+     * The initial temperature accepts a worsening move of median size with probability 1/2, the final temperature accepts
+     * a move of the smallest tenth with probability 1/1000, and the temperature decreases geometrically every max(10, n) iterations.
+     * Four pilot chains (in parallel) then run with a budget that is doubled, starting from max(1000, 10n) iterations,
+     * until their mean result doesn't improve anymore or get_SA_max_iter() is reached.
+     * The full annealing runs with the smallest budget that reached the final result.
+     * The settings of the searcher are not changed, the chosen settings are returned by get_SA_tuning() together with the statistics of the pilot runs.
+     * 
+     * @param data                  Dataset for which the best partition is searched.
+     * @param init_mcm              Starting partition of the pilot runs and the annealing (default is the independent model).
+     * @param file_name             Path to the output file (optional), the tuning is written after the annealing.
+     * 
+     * @return The best MCM found by the annealing.
+     */
+    MCM auto_annealing(Data& data, MCM* init_mcm = nullptr, std::string file_name = "");
+
+    /**
+     * Improve a partition by moving single variables to another (or a new) component and by swapping two variables
+     * of different components, until no move or swap increases the log-evidence anymore.
+     * The gain of every move and swap is kept and only the gains that involve the changed components are recalculated.
+     * 
+     * @param data                  Dataset for which the partition is refined.
+     * @param init_mcm              MCM that is refined (default is the result of the previous search).
+     * 
+     * @return The refined MCM.
+     */
+    MCM refine(Data& data, MCM* init_mcm = nullptr);
+
+    /**
+     * Polish a partition by searching the best partition of small unions of adjacent components exactly.
+     * The components are grouped into disjoint unions of at most get_polish_size() variables, combining the components with the
+     * largest mutual information first. The best partition of every union is found by dynamic programming over its subsets (in parallel)
+     * and replaces the components of the union if it increases the log-evidence. This is repeated until no union improves anymore.
+     * 
+     * @param data                  Dataset for which the partition is polished.
+     * @param init_mcm              MCM that is polished (default is the result of the previous search).
+     * 
+     * @return The polished MCM.
+     */
+    MCM polish(Data& data, MCM* init_mcm = nullptr);
+
+    /**
+     * Multilevel search for systems with many variables.
+     * The variables are coarsened level by level into small groups of strongly dependent variables:
+     * pairs of groups with the largest mutual information are combined if this increases the log-evidence.
+     * The greedy merging (or simulated annealing) then starts from the partition in which every group of the coarsest level is a component.
+     * Finally, the partition is refined from the coarsest to the finest level by moving and swapping the groups of every level between the components.
+     * 
+     * @param data                  Dataset for which the best partition is searched.
+     * @param file_name             Path to the output file (optional).
+     * 
+     * @return The best MCM found by the search.
+     */
+    MCM multilevel_search(Data& data, std::string file_name = "");
+
+    /**
+     * Run a search method repeatedly from random starting partitions and keep the best result.
+     * The restarts run in parallel (one restart per thread) and share the evidence cache of this searcher.
+     * The results are counted in the order of the restarts, such that the result doesn't depend on the number of threads.
+     * 
+     * @param data                  Dataset for which the best partition is searched.
+     * @param method                Search method of every restart, valid options are 'greedy', 'divide_and_conquer' and 'annealing'.
+     * @param file_name             Path to the output file (optional).
+     * 
+     * @return The best MCM over all restarts.
+     */
+    MCM multistart_search(Data& data, const std::string& method, std::string file_name = "");
+
+    /**
+     * Run the greedy merging, the divisive search and the simulated annealing concurrently (one strategy per thread, with at most
+     * get_n_threads() threads) over the evidence cache of this searcher and keep the best partition of all strategies.
+     * The annealing starts from the best partition of the other strategies and starts again when another strategy finds a better one.
+     * The best partition finally goes through a merge and a refine pass. The search ends when all strategies have finished
+     * or at the time limit (see set_time_limit()), which is the budget of the portfolio.
+     * With several threads, the result depends on the order in which the strategies finish.
+     * 
+     * @param data                  Dataset for which the best partition is searched.
+     * @param file_name             Path to the output file (optional).
+     * 
+     * @return The best MCM over all strategies.
+     */
+    MCM portfolio_search(Data& data, std::string file_name = "");
+
+    /**
+     * Sample partitions from the posterior distribution (uniform prior over the partitions) with Markov chains that use the moves of the simulated annealing.
+     * The moves are accepted with the Metropolis-Hastings criterion at temperature 1, which includes the ratio of the proposal probabilities
+     * of the move and its reverse. Moves between all components are proposed (the interaction graph is not used).
+     * The chains run in parallel, every chain has its own stream of random numbers. After the burn-in, every iteration counts as a sample.
+     * The probability that two variables share a component and the distribution of the number of components are accumulated while sampling:
+     * they are only updated when a move is accepted, the samples are not stored.
+     * 
+     * @param data                  Dataset for which the partitions are sampled.
+     * @param init_mcm              Starting partition of every chain (default is the independent model).
+     * @param file_name             Path to the output file (optional).
+     * 
+     * @return The partition with the largest log-evidence that was visited by the chains.
+     */
+    MCM posterior_sampling(Data& data, MCM* init_mcm = nullptr, std::string file_name = "");
+
     // Setters and getters for the simulated annealing settings
     void set_SA_max_iter(int n_iter);
-    void set_SA_init_temp(int temp);
+    void set_SA_init_temp(double temp);
     void set_SA_update_schedule(int n_iter);
     int get_SA_max_iter() {return this->SA_max_iter;};
-    int get_SA_init_temp() {return this->SA_T0;};
+    double get_SA_init_temp() {return this->SA_T0;};
     int get_SA_update_schedule() {return this->SA_update_schedule;};
 
-    // Getter for all evidences in exhaustive search
+    /**
+     * Set the number of moves that the simulated annealing proposes at once.
+     * With a batch size B > 1, B moves are drawn from the current partition and the evidence of their new components
+     * is calculated in parallel (see set_n_threads). The moves are then accepted or rejected one by one with the metropolis criterion.
+     * After an accepted move, the remaining moves of the batch are discarded and a new batch is drawn from the new partition,
+     * such that every move is proposed from the current partition like in the sequential annealing.
+     * This is worthwhile when the evidence of the components is expensive (many datapoints) and the acceptance rate is low.
+     * 
+     * @param batch_size            Number of moves proposed at once (1 is the sequential annealing, default).
+     */
+    void set_SA_batch_size(int batch_size);
+    int get_SA_batch_size() {return this->SA_batch_size;};
+
+    /**
+     * Set the cooling schedule of the simulated annealing. The temperature is updated every get_SA_update_schedule() iterations.
+     * 
+     * @param schedule              Valid options are:
+     *                                  -"logarithmic": T = T0 / (1 + log(1 + i)) (default)
+     *                                  -"geometric": the temperature is multiplied by the cooling rate at every update
+     *                                  -"linear": the temperature decreases linearly to the minimum temperature at the last iteration
+     *                                  -"adaptive": the temperature is multiplied (divided) by the cooling rate when the acceptance rate since the last update
+     *                                   is above (below) a target rate, which decreases linearly from get_SA_target_acceptance() to zero
+     */
+    void set_SA_schedule(const std::string& schedule);
+    std::string get_SA_schedule();
+
+    /**
+     * Set the cooling rate of the geometric and adaptive schedules (default is 0.99).
+     * 
+     * @param rate                  Factor between 0 and 1.
+     */
+    void set_SA_cooling_rate(double rate);
+    double get_SA_cooling_rate() {return this->SA_cooling_rate;};
+
+    /**
+     * Set the minimum temperature of the simulated annealing, which is the final temperature of the linear schedule
+     * and the lower bound of the geometric and adaptive schedules (default is 0.01).
+     * 
+     * @param temp                  Positive temperature.
+     */
+    void set_SA_min_temp(double temp);
+    double get_SA_min_temp() {return this->SA_min_temp;};
+
+    /**
+     * Set the acceptance rate that the adaptive schedule targets at the start of the annealing (default is 0.1).
+     * 
+     * @param rate                  Acceptance rate between 0 and 1.
+     */
+    void set_SA_target_acceptance(double rate);
+    double get_SA_target_acceptance() {return this->SA_target_acceptance;};
+
+    /**
+     * Set the number of iterations without improvement of the best partition after which the simulated annealing has converged (default is 10000).
+     * 
+     * @param n_iter                Number of iterations.
+     */
+    void set_SA_max_no_improve(int n_iter);
+    int get_SA_max_no_improve() {return this->SA_max_no_improve;};
+
+    /**
+     * Set the number of times the simulated annealing is reheated when it has converged.
+     * A reheat restarts the cooling schedule from twice the temperature at which the best partition was last improved
+     * (at most the initial temperature). The annealing stops when it converges after the last reheat.
+     * 
+     * @param n_reheats             Number of reheats (0 stops at the first convergence, default).
+     */
+    void set_SA_reheats(int n_reheats);
+    int get_SA_reheats() {return this->SA_reheats;};
+
+    /**
+     * Returns the settings chosen by the last auto_annealing and the statistics of its pilot runs.
+     */
+    SA_tuning get_SA_tuning();
+
+    // Setters and getters for the parallel tempering settings
+    void set_PT_n_replicas(int n_replicas);
+    void set_PT_min_temp(double temp);
+    void set_PT_max_temp(double temp);
+    void set_PT_swap_interval(int n_iter);
+    int get_PT_n_replicas() {return this->PT_n_replicas;};
+    double get_PT_min_temp() {return this->PT_min_temp;};
+    double get_PT_max_temp() {return this->PT_max_temp;};
+    int get_PT_swap_interval() {return this->PT_swap_interval;};
+
+    /**
+     * Returns the temperature of every replica of the parallel tempering, from the lowest to the highest.
+     */
+    std::vector<double> get_PT_temperatures();
+
+    /**
+     * Returns the fraction of accepted swaps between replica r and r+1 in the last parallel tempering search.
+     * 
+     * @return Vector of n_replicas - 1 acceptance rates.
+     */
+    std::vector<double> get_PT_swap_acceptance();
+
+    // Getters for the recorded log-evidence trajectory
     std::vector<double> get_log_evidence_trajectory();
+    std::shared_ptr<std::vector<double>> get_log_evidence_trajectory_ptr();
+    std::vector<unsigned long long> get_log_evidence_trajectory_steps();
+    std::vector<std::pair<double, unsigned long long>> get_log_evidence_histogram();
+    TrajectorySummary get_log_evidence_summary();
+
+    /**
+     * Set the policy that determines which log-evidence values are recorded during a search.
+     * 
+     * @param policy                Valid options are:
+     *                                  -"all": every step is stored (default)
+     *                                  -"off": nothing is recorded
+     *                                  -"every_k": every k-th step is stored (see set_trajectory_interval)
+     *                                  -"improvements": only steps that improve the best value so far are stored
+     *                                  -"histogram": streaming histogram and summary statistics (see set_trajectory_bin_width)
+     *                                  -"file": every step is written to a binary file of doubles (see set_trajectory_file)
+     */
+    void set_trajectory_policy(const std::string& policy) {this->trajectory.set_policy(policy);};
+    void set_trajectory_interval(int k) {this->trajectory.set_interval(k);};
+    void set_trajectory_file(const std::string& file_name) {this->trajectory.set_file(file_name);};
+    void set_trajectory_bin_width(double width) {this->trajectory.set_bin_width(width);};
+    std::string get_trajectory_policy() {return this->trajectory.get_policy_name();};
+    int get_trajectory_interval() {return this->trajectory.get_interval();};
+    std::string get_trajectory_file() {return this->trajectory.get_file();};
+    double get_trajectory_bin_width() {return this->trajectory.get_bin_width();};
+
+    /**
+     * Set the number of threads used by the search methods (default is 1).
+     * 
+     * @param n_threads             Number of worker threads.
+     */
+    void set_n_threads(int n_threads);
+    int get_n_threads() {return this->n_threads;};
+
+    /**
+     * Set the seed of the random number generator of the searcher, such that the random searches can be reproduced.
+     * Every random search (and every replica or restart within it) takes a separate stream of this generator,
+     * so the result of a sequence of searches after setting the seed doesn't depend on the number of threads.
+     * 
+     * @param seed                  Seed of the generator (a random seed is drawn when the searcher is constructed).
+     */
+    void set_seed(uint64_t seed);
+    uint64_t get_seed() {return this->seed;};
+
+    /**
+     * Set the number of best partitions that the exhaustive search keeps track of.
+     * If k > 0, only the k best partitions are stored instead of the log-evidence of every partition.
+     * 
+     * @param k                     Number of best partitions to keep (0 stores the full log-evidence trajectory instead).
+     */
+    void set_top_k(int k);
+    int get_top_k() {return this->top_k;};
+
+    /**
+     * Set the beam width of the hierarchical greedy merging.
+     * With a width B > 1, the B best partitions are kept in every round and each of them is expanded with its B best merges.
+     * 
+     * @param width                 Number of partitions kept per round (1 is the plain greedy merging, default).
+     */
+    void set_beam_width(int width);
+    int get_beam_width() {return this->beam_width;};
+
+    /**
+     * Restrict the candidate moves of the heuristic searches to variables that interact according to a k-nearest-neighbour graph.
+     * The graph connects every variable to the k variables with which it has the largest mutual information.
+     * Only components that contain connected variables are merged (greedy merging and simulated annealing),
+     * a variable only moves to a component that contains one of its neighbours (simulated annealing and divisive search after the first move of a split).
+     * 
+     * @param k                     Number of neighbours of every variable (0 uses all pairs, default).
+     */
+    void set_interaction_neighbours(int k);
+    int get_interaction_neighbours() {return this->interaction_neighbours;};
+
+    /**
+     * Returns the interaction graph of the last search (empty if all pairs are used).
+     * 
+     * @return Vector of n integers where the ith integer contains the neighbours of variable i.
+     */
+    std::vector<__uint128_t> get_interaction_graph() {return this->interaction_graph;};
+
+    /**
+     * Returns the pairwise mutual information (in q-its) on which the interaction graph of the last search is based.
+     * 
+     * @return Vector of n * n values (empty if all pairs are used).
+     */
+    std::vector<double> get_mutual_information() {return this->mutual_information;};
+
+    /**
+     * Skip candidate merges in the hierarchical merging with an upper bound on their gain.
+     * The bound follows from the sizes and the log-evidences of the two components, so it costs no pass over the data.
+     * Candidates whose bound is not positive are never evaluated, the others are only evaluated once their bound is the largest gain in the queue.
+     * The result is the same as without pruning.
+     * 
+     * @param pruning               True to prune candidates (default).
+     */
+    void set_merge_pruning(bool pruning) {this->merge_pruning = pruning;};
+    bool get_merge_pruning() {return this->merge_pruning;};
 
+    /**
+     * Returns the number of candidate merges that were evaluated and pruned in the last hierarchical merging.
+     */
+    MergeStatistics get_merge_statistics() {return this->merge_statistics;};
+
+    /**
+     * Continue the hierarchical merging until all variables are in a single component and record the full merge tree.
+     * The result of the search is still the partition at which no merge increases the log-evidence anymore.
+     * 
+     * @param full                  True to record the full merge tree (default is false, the tree ends at the result).
+     */
+    void set_full_dendrogram(bool full) {this->full_dendrogram = full;};
+    bool get_full_dendrogram() {return this->full_dendrogram;};
+
+    /**
+     * Returns the merge tree of the last greedy merging (also the final merging of simulated annealing).
+     * The tree is empty after the other search methods and after a beam search.
+     * 
+     * @return Merge tree containing the starting partition and every merge in order.
+     */
+    const Dendrogram& get_dendrogram() {return this->dendrogram;};
+
+    /**
+     * Returns the partition at a level of the merge tree of the last greedy merging.
+     * 
+     * @param n_merges              Number of merges applied to the starting partition.
+     * 
+     * @return MCM at this level of the tree.
+     */
+    MCM get_dendrogram_cut(int n_merges);
+
+    /**
+     * Set the maximum number of variables in a union of components that is searched exactly when polishing a partition.
+     * A union of k variables costs 2^k evaluations and 3^k steps of the dynamic programming.
+     * 
+     * @param max_size              Maximum number of variables in a union, between 1 and 20 (default is 12).
+     */
+    void set_polish_size(int max_size);
+    int get_polish_size() {return this->polish_size;};
+
+    /**
+     * Set the maximum number of variables in a group of the coarsening of the multilevel search.
+     * 
+     * @param max_size              Maximum number of variables in a group (default is 4, 1 disables the coarsening).
+     */
+    void set_multilevel_group_size(int max_size);
+    int get_multilevel_group_size() {return this->multilevel_group_size;};
+
+    /**
+     * Set the search method that is used on the coarsest level of the multilevel search.
+     * 
+     * @param method                Valid options are 'greedy' (default) and 'annealing' (simulated annealing that moves whole groups, followed by the greedy merging).
+     */
+    void set_multilevel_coarse_search(const std::string& method);
+    std::string get_multilevel_coarse_search() {return this->multilevel_coarse_search;};
+
+    /**
+     * Returns the groups of variables on every level of the coarsening of the last multilevel search.
+     * 
+     * @return Vector of levels, level 0 contains every variable on its own and the last level is the coarsest one.
+     */
+    std::vector<std::vector<__uint128_t>> get_coarsening_levels() {return this->coarsening_levels;};
+
+    /**
+     * Set the number of restarts of the multi-start search.
+     * 
+     * @param n_restarts            Number of random starting partitions (default is 16).
+     */
+    void set_multistart_restarts(int n_restarts);
+    int get_multistart_restarts() {return this->multistart_restarts;};
+
+    /**
+     * Stop the multi-start search once the best log-evidence has been found by a number of restarts.
+     * 
+     * @param n_repeats             Number of restarts that reach the best value (0 runs all restarts, default).
+     */
+    void set_multistart_patience(int n_repeats);
+    int get_multistart_patience() {return this->multistart_patience;};
+
+    /**
+     * Returns the final log-evidence of every restart of the last multi-start search, in the order of the restarts.
+     * The restarts that were skipped by the early stopping are not included.
+     */
+    std::vector<double> get_multistart_log_evidences();
+
+    /**
+     * Returns the strategy of the last portfolio search that found the best partition ('greedy', 'divide_and_conquer' or 'annealing'),
+     * before the final merge and refine pass.
+     */
+    std::string get_portfolio_winner();
+
+    /**
+     * Returns the best log-evidence of every strategy of the last portfolio search (greedy, divide_and_conquer and annealing, in that order).
+     */
+    std::vector<double> get_portfolio_log_evidences();
+
+    // Setters and getters for the posterior sampling settings (default are 4 chains of 100 000 iterations after a burn-in of 10 000 iterations)
+    void set_sampling_chains(int n_chains);
+    void set_sampling_iter(int n_iter);
+    void set_sampling_burn_in(int n_iter);
+    int get_sampling_chains() {return this->sampling_chains;};
+    int get_sampling_iter() {return this->sampling_iter;};
+    int get_sampling_burn_in() {return this->sampling_burn_in;};
+
+    /**
+     * Returns the posterior probability that two variables are in the same component, estimated by the last posterior sampling.
+     * 
+     * @return Matrix of n x n probabilities (the diagonal is 1).
+     */
+    std::vector<std::vector<double>> get_sampling_comembership();
+
+    /**
+     * Returns the posterior distribution of the number of components, estimated by the last posterior sampling.
+     * 
+     * @return Vector of n + 1 probabilities, where the kth entry is the probability of k components.
+     */
+    std::vector<double> get_sampling_n_comp();
+
+    /**
+     * Returns the fraction of accepted moves of every chain of the last posterior sampling (after the burn-in).
+     */
+    std::vector<double> get_sampling_acceptance();
+
+    /**
+     * Set the maximum number of variables in a component for the exhaustive search.
+     * Only partitions whose components are all at most this large are enumerated and evaluated.
+     * 
+     * @param max_size              Maximum number of variables in a component (0 means no maximum, default).
+     */
+    void set_max_component_size(int max_size);
+    int get_max_component_size() {return this->max_component_size;};
+
+    /**
+     * Returns the k best MCMs found in the last exhaustive search, sorted from the largest to the smallest log-evidence.
+     * 
+     * @return Vector containing the k best MCMs.
+     */
+    std::vector<MCM> get_top_mcms();
+
+    /**
+     * Combine the result files of all shards of an exhaustive search into the final result.
+     * Each shard is searched with exhaustive_search(data, shard, n_shards, result_file), possibly by a different process.
+     * The result is the same as that of an exhaustive search that is not sharded.
+     * 
+     * @param data                  Dataset on which the shards were searched.
+     * @param result_files          Paths to the result files of all shards (in any order).
+     * 
+     * @return The MCM with the largest log-evidence.
+     */
+    MCM merge_shards(Data& data, const std::vector<std::string>& result_files);
+
+    /**
+     * Periodically write the state of the search to a checkpoint file such that an interrupted search can be resumed with resume_search.
+     * The checkpoint is written in the background and replaces the previous one.
+     * The evidence cache and the stored log-evidence trajectory are extended at every checkpoint in logs next to it (file_name + '.cache' and file_name + '.trajectory').
+     * 
+     * @param file_name             Path to the checkpoint file (an empty string disables checkpoints).
+     * @param interval              Minimum number of seconds between two checkpoints (default is 600).
+     */
+    void set_checkpoint(const std::string& file_name, double interval = 600);
+    std::string get_checkpoint_file() {return this->checkpoint_file;};
+    double get_checkpoint_interval() {return this->checkpoint_interval;};
+
+    /**
+     * Resume the search that wrote a checkpoint file. The search method and its settings are read from the checkpoint.
+     * 
+     * @param data                  Dataset on which the interrupted search was ran.
+     * @param checkpoint_file       Path to the checkpoint file.
+     * @param file_name             Path to the output file of the interrupted search, the remaining output is appended (optional).
+     * 
+     * @return The best MCM found by the search.
+     */
+    MCM resume_search(Data& data, const std::string& checkpoint_file, std::string file_name = "");
+
+    /**
+     * Set the maximum duration of every search. A search that reaches its time limit returns the best partition found so far,
+     * which is marked as truncated (MCM::truncated). Searches that run within a search (and the workers of a parallel search)
+     * share the time limit of the outermost search.
+     * 
+     * @param seconds               Maximum number of seconds (0 means no limit, default).
+     */
+    void set_time_limit(double seconds) {this->stop_condition.set_time_limit(seconds);};
+    double get_time_limit() {return this->stop_condition.get_time_limit();};
+
+    /**
+     * Set the token through which a running search is stopped from another thread.
+     * The search returns the best partition found so far, which is marked as truncated.
+     * The token is not reset by the search, call token.reset() before using it for the next search.
+     * 
+     * @param token                 Cancellation token (a copy shares the state of the given token).
+     */
+    void set_cancellation_token(const CancellationToken& token) {this->stop_condition.set_cancellation_token(token);};
+    CancellationToken get_cancellation_token() {return this->stop_condition.get_cancellation_token();};
+
+    /**
+     * Set a function that is called regularly during every search with the elapsed time and the best log-evidence so far.
+     * It is called by the thread that started the search, the search stops (as if it was cancelled) if it returns false.
+     * 
+     * @param callback              Progress callback (an empty function disables it).
+     * @param interval              Minimum number of seconds between two calls (default is 1).
+     */
+    void set_progress_callback(const ProgressCallback& callback, double interval = 1) {this->stop_condition.set_progress_callback(callback, interval);};
+    double get_progress_interval() {return this->stop_condition.get_progress_interval();};
 
 private:
     MCM mcm_in;
@@ -55,28 +604,130 @@ private:
     std::unique_ptr<std::ofstream> output_file;
 
     int SA_max_iter;
-    int SA_T0;
+    double SA_T0;
     int SA_update_schedule;
+    int SA_batch_size;
+    CoolingSchedule SA_schedule;
+    double SA_cooling_rate;
+    double SA_min_temp;
+    double SA_target_acceptance;
+    int SA_max_no_improve;
+    int SA_reheats;
+    SA_tuning SA_tuning_result;
+
+    int PT_n_replicas;
+    double PT_min_temp;
+    double PT_max_temp;
+    int PT_swap_interval;
+    std::vector<double> PT_swap_acceptance;
+
+    int n_threads;
+    int top_k;
+    int max_component_size;
+    int beam_width;
+    bool full_dendrogram;
+    bool merge_pruning;
+    int interaction_neighbours;
+    int polish_size;
+    int multilevel_group_size;
+    std::string multilevel_coarse_search;
+    std::vector<std::vector<__uint128_t>> coarsening_levels;
+    int multistart_restarts;
+    int multistart_patience;
+    std::vector<double> multistart_log_evidences;
+    std::string portfolio_winner;
+    std::vector<double> portfolio_log_evidences;
+    int sampling_chains;
+    int sampling_iter;
+    int sampling_burn_in;
+    std::vector<double> sampling_comembership;
+    std::vector<double> sampling_n_comp;
+    std::vector<double> sampling_acceptance;
+    std::vector<__uint128_t> interaction_graph;
+    std::vector<double> mutual_information;
+    // Set for the workers of a search, they use the interaction graph of the searcher that created them instead of building it again
+    bool interaction_graph_given = false;
+    MergeStatistics merge_statistics;
+    Dendrogram dendrogram;
+    std::vector<MCM> top_mcms;
 
-    std::map<__uint128_t, double> evidence_storage;
+    // Thread-safe storage of the evidence of the components encountered by the heuristic searches
+    EvidenceCache evidence_storage;
     std::vector<double> evidence_storage_es;
+    // Cache of the searcher that runs a multi-start search, used instead of evidence_storage by its workers
+    EvidenceCache* shared_evidence_storage = nullptr;
 
     std::vector<double> all_evidences;
-    std::vector<double> log_evidence_trajectory;
+    TrajectoryRecorder trajectory;
 
     bool exhaustive;
 
+    uint64_t seed;
+    RandomGenerator generator;
+
+    std::string checkpoint_file;
+    double checkpoint_interval;
+    std::chrono::steady_clock::time_point last_checkpoint;
+    std::unique_ptr<CheckpointWriter> checkpoint_writer;
+    // Log of the evidence cache that is extended at every checkpoint, and the number of entries in it
+    std::string cache_log_name;
+    unsigned long long n_cache_logged = 0;
+
+    // Time limit, cancellation and progress of the running search (shared with the workers)
+    StopCondition stop_condition;
+
+    // Returns a copy of the generator and jumps the generator to the next stream
+    RandomGenerator next_stream();
+
+    // Checkpoint functions
+    bool checkpoint_due();
+
+    void build_interaction_graph();
+    __uint128_t neighbourhood(__uint128_t component);
+    // The trajectory and the state are serialized while holding the state mutex (if given) such that workers can continue during the checkpoint
+    void write_checkpoint(CheckpointMethod method, const std::function<void(std::ostream&)>& write_state, std::mutex* state_mutex = nullptr);
+
+    // Main loop of each search method (shared by the search and resume_search)
+    MCM run_exhaustive(ES_state& state);
+    MCM run_greedy(std::string file_name, std::vector<MCM>& beam);
+    MCM run_division(std::vector<int>& to_split, int first_empty, std::string file_name);
+    MCM run_annealing(MCM& mcm_tmp, SA_settings& settings, std::string file_name);
+    MCM run_tempering(PT_state& state, std::string file_name);
+
     // Divide and conquer function
-    int division(int move_from, int move_to);
+    std::pair<__uint128_t, __uint128_t> best_split(__uint128_t component, __uint128_t other, int n_threads);
+    bool division(int move_from, int move_to, const std::pair<__uint128_t, __uint128_t>& split);
 
     // Simulated annealing functions
-    int merge_partition(MCM& mcm, SA_settings& settings);
-    int split_partition(MCM& mcm, SA_settings& settings);
-    int switch_partition(MCM& mcm, SA_settings& settings);
+    void annealing(MCM& mcm_tmp, SA_settings& settings, bool checkpoints = false);
+    // Temperature of the cooling schedule at iteration i
+    double schedule_temperature(const SA_settings& settings, int i);
+    // Proposes a move from the current partition and accepts it with the metropolis criterion (returns 1 if accepted)
+    int annealing_step(MCM& mcm, SA_settings& settings);
+    bool propose_move(MCM& mcm, SA_settings& settings, SA_move& move);
+    bool propose_merge(MCM& mcm, SA_settings& settings, SA_move& move);
+    bool propose_split(MCM& mcm, SA_settings& settings, SA_move& move);
+    bool propose_switch(MCM& mcm, SA_settings& settings, SA_move& move);
+    int apply_move(MCM& mcm, SA_settings& settings, const SA_move& move, double log_proposal_ratio = 0);
+    // Logarithm of the ratio of the probability to propose the reverse move and the probability to propose the move
+    double proposal_log_ratio(const ComponentIndex& index, const SA_move& move);
+    // Draws get_SA_batch_size() proposals from the current partition and evaluates their new components in parallel on the pool (serially without a pool)
+    void propose_batch(MCM& mcm, SA_settings& settings, std::vector<SA_move>& batch, ThreadPool* pool);
 
     // Greedy merging function
-    void hierarchical_merging();
+    void hierarchical_merging(bool checkpoints = false);
+    void beam_merging(std::vector<MCM>& beam, bool checkpoints = false);
+
+    // Local refinement by moving and swapping units (disjoint sets of variables that each lie within a component)
+    void refine_partition(const std::vector<__uint128_t>& units, bool swaps = true);
+
+    // Searcher with the same settings, evidence cache and interaction graph for a restart of the multi-start search (or a strategy of the portfolio)
+    MCMSearch create_worker();
+
+    // Multilevel function: groups of the next level (empty if no groups can be combined)
+    std::vector<__uint128_t> coarsen(const std::vector<__uint128_t>& groups, const std::vector<double>& mutual_information);
 
     double get_log_ev(std::vector<__uint128_t> partition);
+    // Thread-safe for the heuristic searches (not during the exhaustive search)
     double get_log_ev_icc(__uint128_t component);
 };
\ No newline at end of file
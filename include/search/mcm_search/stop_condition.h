@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+/**
+ * Token through which a running search is asked to stop. Copies of a token share the same state,
+ * such that the caller keeps a copy to cancel the search from another thread.
+ */
+class CancellationToken {
+public:
+    CancellationToken() : cancelled(std::make_shared<std::atomic<bool>>(false)) {};
+
+    /**
+     * Asks the searches that use this token to stop, they return the best partition found so far.
+     */
+    void cancel() {this->cancelled->store(true);};
+
+    /**
+     * Withdraws the request, such that the token can be used for the next search.
+     */
+    void reset() {this->cancelled->store(false);};
+
+    bool is_cancelled() const {return this->cancelled->load(std::memory_order_relaxed);};
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+/**
+ * Struct containing the progress of a running search that is passed to the progress callback.
+ *
+ * @struct SearchProgress
+ *
+ * @var SearchProgress::elapsed
+ *  Number of seconds since the start of the search.
+ *
+ * @var SearchProgress::log_ev
+ *  Log-evidence of the best partition of the running search (method dependent, -DBL_MAX if it is not known yet).
+ */
+struct SearchProgress {
+    double elapsed;
+    double log_ev;
+};
+
+/**
+ * Progress callback of a search, the search stops if it returns false.
+ */
+typedef std::function<bool(const SearchProgress&)> ProgressCallback;
+
+/**
+ * Decides when a search stops before it has finished: when its time limit has passed, when its cancellation token is cancelled
+ * or when the progress callback returns false. Once a search is stopped, every later check returns true such that all loops
+ * of the search end and the best partition so far is returned.
+ *
+ * The outermost search starts a new condition, the searches that run within a search and the workers of a parallel search
+ * share the condition of the outermost search (and its deadline). The condition is checked from several threads,
+ * the progress callback is only called by the thread that started the outermost search.
+ */
+class StopCondition {
+public:
+    /**
+     * Sets the maximum duration of a search.
+     *
+     * @param seconds               Number of seconds (0 means no limit).
+     */
+    void set_time_limit(double seconds);
+    double get_time_limit() {return this->time_limit;};
+
+    void set_cancellation_token(const CancellationToken& token) {this->token = token;};
+    CancellationToken get_cancellation_token() {return this->token;};
+
+    /**
+     * Sets the function that is called regularly during a search.
+     *
+     * @param callback              Progress callback (none if empty).
+     * @param interval              Minimum number of seconds between two calls.
+     */
+    void set_progress_callback(const ProgressCallback& callback, double interval);
+    double get_progress_interval() {return this->progress_interval;};
+
+    /**
+     * Marks the start and the end of a search.
+     */
+    void enter();
+    void leave();
+
+    /**
+     * Returns true if the running search should stop, calls the progress callback when it is due.
+     * The clock is read in every call, loops with cheap iterations only check every few iterations.
+     *
+     * @param log_ev                Best log-evidence of the search, reported to the progress callback.
+     */
+    bool requested(double log_ev);
+
+    /**
+     * Returns true if the running (or last) search was stopped before it finished.
+     */
+    bool triggered() const {return this->state && this->state->stopped.load();};
+
+private:
+    // State of a running search that is shared with the searches and workers within it
+    struct State {
+        std::atomic<int> depth;
+        std::atomic<bool> stopped;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point deadline;
+        bool has_deadline;
+        CancellationToken token;
+        ProgressCallback callback;
+        std::chrono::duration<double> interval;
+        std::thread::id owner;
+        // Only used by the owner
+        std::chrono::steady_clock::time_point next_report;
+    };
+
+    double time_limit = 0;
+    CancellationToken token;
+    ProgressCallback progress_callback;
+    double progress_interval = 1;
+    std::shared_ptr<State> state;
+};
+
+/**
+ * Enters a stop condition for the lifetime of the object, such that the search leaves the condition also when it throws an exception.
+ */
+class StopScope {
+public:
+    StopScope(StopCondition& condition) : condition(condition) {condition.enter();};
+    ~StopScope() {this->condition.leave();};
+
+    StopScope(const StopScope&) = delete;
+    StopScope& operator=(const StopScope&) = delete;
+
+private:
+    StopCondition& condition;
+};
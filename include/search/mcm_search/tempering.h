@@ -0,0 +1,45 @@
+#pragma once
+
+#include "mcm_search.h"
+#include "annealing.h"
+
+#include <iostream>
+
+/**
+ * Struct containing the state of a parallel tempering search (replica exchange).
+ *
+ * @struct PT_state
+ *
+ * @var PT_state::replicas
+ *  Vector containing the current partition of every replica, ordered from the lowest to the highest temperature.
+ *
+ * @var PT_state::settings
+ *  Vector containing the annealing settings of every replica (its fixed temperature and the index of the components of its partition).
+ *
+ * @var PT_state::swap_attempts
+ *  Vector containing the number of attempted swaps between replica r and r+1.
+ *
+ * @var PT_state::swap_accepted
+ *  Vector containing the number of accepted swaps between replica r and r+1.
+ *
+ * @var PT_state::iteration
+ *  Integer indicating the number of iterations that every replica has done.
+ *
+ * @var PT_state::round
+ *  Integer indicating the number of rounds of iterations followed by swaps that have been done.
+ *
+ * @var PT_state::generator
+ *  Random number generator of the swaps (every replica has its own generator in its settings).
+ */
+struct PT_state {
+    std::vector<MCM> replicas;
+    std::vector<SA_settings> settings;
+    std::vector<unsigned long long> swap_attempts;
+    std::vector<unsigned long long> swap_accepted;
+    int iteration = 0;
+    int round = 0;
+    RandomGenerator generator;
+};
+
+void write_binary(std::ostream& stream, const PT_state& state);
+void read_binary(std::istream& stream, PT_state& state);
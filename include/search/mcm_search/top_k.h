@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+/**
+ * Bounded collection of the k partitions with the largest log-evidence.
+ *
+ * The partitions are kept in a min-heap of size k such that adding a partition costs O(log k) and memory stays bounded by k partitions.
+ * A collector is not locked: every worker thread fills its own collector and the collectors are combined afterwards with merge().
+ * Ties in log-evidence are broken on the partition itself such that the result does not depend on the order in which partitions are added.
+ */
+class TopKPartitions {
+public:
+    /**
+     * Constructs an empty collector.
+     *
+     * @param k                     Maximum number of partitions that are kept.
+     */
+    TopKPartitions(int k = 0);
+
+    /**
+     * Cheap check whether a partition with the given log-evidence could enter the collection.
+     * Avoids copying partitions that would be rejected anyway.
+     *
+     * @param log_ev                Log-evidence of a candidate partition.
+     *
+     * @return True if the partition could be one of the k best so far.
+     */
+    bool accepts(double log_ev) const {return (this->k > 0) && ((int) this->heap.size() < this->k || log_ev >= this->heap.front().first);};
+
+    /**
+     * Offers a partition to the collection. It is kept only if it is among the k best so far.
+     *
+     * @param log_ev                Log-evidence of the partition.
+     * @param partition             Partition as a vector of n integers representing the components.
+     */
+    void push(double log_ev, const std::vector<__uint128_t>& partition);
+
+    /**
+     * Adds all partitions of another collector to this one.
+     *
+     * @param other                 Collector filled by another worker.
+     */
+    void merge(const TopKPartitions& other);
+
+    /**
+     * Returns the collected partitions sorted from the largest to the smallest log-evidence.
+     *
+     * @return Vector of pairs containing the log-evidence and the partition.
+     */
+    std::vector<std::pair<double, std::vector<__uint128_t>>> sorted() const;
+
+    int get_k() const {return this->k;};
+    int size() const {return this->heap.size();};
+
+private:
+    int k;
+    // Min-heap: the front is the worst partition that is currently kept
+    std::vector<std::pair<double, std::vector<__uint128_t>>> heap;
+};
+
+/**
+ * Ordering used by the top-k collector: true if partition a is better than partition b.
+ * A larger log-evidence is better, ties are broken by the lexicographic order of the partitions.
+ */
+bool better_partition(const std::pair<double, std::vector<__uint128_t>>& a, const std::pair<double, std::vector<__uint128_t>>& b);
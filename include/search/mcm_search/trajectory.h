@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <fstream>
+#include <utility>
+
+struct CheckpointLog;
+
+/**
+ * Policies that determine which log-evidence values of a search are recorded.
+ */
+enum class TrajectoryPolicy {
+    all,            // Every step is stored in memory
+    off,            // Nothing is recorded
+    every_k,        // Every k-th step is stored in memory
+    improvements,   // Only steps that improve the best value so far are stored in memory
+    histogram,      // Streaming histogram and summary statistics of all values
+    file            // Every step is written to a binary file (native doubles)
+};
+
+/**
+ * Struct containing the summary statistics of all recorded log-evidence values.
+ *
+ * @struct TrajectorySummary
+ */
+struct TrajectorySummary {
+    unsigned long long count = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double m2 = 0; // Sum of squared differences from the mean
+
+    double variance() const {return (count > 1) ? m2 / (count - 1) : 0;};
+
+    /**
+     * Streaming update with a new value (Welford's algorithm).
+     */
+    void add(double value);
+
+    /**
+     * Combines the statistics of another set of values with these ones.
+     */
+    void merge(const TrajectorySummary& other);
+};
+
+/**
+ * Records the log-evidence trajectory of a search according to a recording policy.
+ *
+ * The memory used by the policies 'off', 'histogram' and 'file' does not grow with the number of steps.
+ * Workers that enumerate independent parts of a search fill their own part (see create_part) which are appended in order afterwards.
+ */
+class TrajectoryRecorder {
+public:
+    /**
+     * Constructs a recorder that stores every step in memory.
+     */
+    TrajectoryRecorder();
+
+    /**
+     * Set the recording policy.
+     *
+     * @param policy                Name of the policy. Valid options are 'all', 'off', 'every_k', 'improvements', 'histogram' and 'file'.
+     */
+    void set_policy(const std::string& policy);
+    std::string get_policy_name() const;
+    TrajectoryPolicy get_policy() const {return this->policy;};
+
+    void set_interval(int k);
+    int get_interval() const {return this->interval;};
+    void set_file(const std::string& file_name);
+    std::string get_file() const {return this->file_name;};
+    void set_bin_width(double width);
+    double get_bin_width() const {return this->bin_width;};
+
+    /**
+     * Start recording a new trajectory. Previously recorded values are released.
+     */
+    void start();
+
+    /**
+     * Create a recorder with the same settings for an independent part of the search.
+     *
+     * @param index                 Index of the part (determines the name of the temporary file of the 'file' policy).
+     * @param first_step            Index of the first step of this part in the full trajectory.
+     *
+     * @return Recorder for this part.
+     */
+    TrajectoryRecorder create_part(int index, unsigned long long first_step) const;
+
+    /**
+     * Append a part that was filled by a worker. Parts should be appended in the order of their steps.
+     *
+     * @param part                  Recorder that was created by create_part.
+     */
+    void append(TrajectoryRecorder& part);
+
+    /**
+     * Add summary statistics of values that were evaluated elsewhere (e.g. by another process) to the summary of this trajectory.
+     *
+     * @param summary               Summary statistics of the other values.
+     */
+    void add_summary(const TrajectorySummary& summary) {this->summary.merge(summary);};
+
+    /**
+     * Stop recording and flush the output file.
+     */
+    void finish();
+
+    /**
+     * Stop recording and remove the temporary file of a part (used when the search fails before the part is appended).
+     */
+    void discard();
+
+    /**
+     * Write the state of the recorder to a checkpoint.
+     * The output file is flushed such that a resumed search can continue writing from the current position.
+     * If a log is given, the values stored in memory are added to its records instead (only the values since the previous checkpoint)
+     * and the checkpoint contains the number of logged values.
+     *
+     * @param stream                Binary stream containing the checkpoint.
+     * @param log                   Log of the stored values, with the path to the log set (the values are written to the checkpoint if null).
+     */
+    void save(std::ostream& stream, CheckpointLog* log = nullptr);
+
+    /**
+     * Restore the state of the recorder from a checkpoint.
+     *
+     * @param stream                Binary stream containing the checkpoint.
+     */
+    void load(std::istream& stream);
+
+    /**
+     * Record the log-evidence of the next step.
+     *
+     * @param log_ev                Log-evidence of the step.
+     */
+    void record(double log_ev){
+        switch (this->policy){
+            case TrajectoryPolicy::all:
+                this->values->push_back(log_ev);
+                break;
+            case TrajectoryPolicy::off:
+                break;
+            case TrajectoryPolicy::every_k:
+                if (this->step % this->interval == 0){
+                    this->values->push_back(log_ev);
+                    this->steps.push_back(this->step);
+                }
+                break;
+            case TrajectoryPolicy::improvements:
+                if (this->values->empty() || log_ev > this->values->back()){
+                    this->values->push_back(log_ev);
+                    this->steps.push_back(this->step);
+                }
+                break;
+            case TrajectoryPolicy::histogram:
+                this->add_to_histogram(log_ev);
+                break;
+            case TrajectoryPolicy::file:
+                this->output->write(reinterpret_cast<const char*>(&log_ev), sizeof(double));
+                break;
+        }
+        this->step++;
+    };
+
+    // Recorded values
+    std::shared_ptr<std::vector<double>> get_values() const {return this->values;};
+    const std::vector<unsigned long long>& get_steps() const {return this->steps;};
+    std::vector<std::pair<double, unsigned long long>> get_histogram() const;
+    const TrajectorySummary& get_summary() const {return this->summary;};
+    unsigned long long get_n_steps() const {return this->step - this->first_step;};
+
+private:
+    TrajectoryPolicy policy;
+    int interval;
+    std::string file_name;
+    double bin_width;
+
+    unsigned long long first_step;
+    unsigned long long step;
+
+    // A new vector is allocated for every trajectory such that views on a previous trajectory remain valid
+    std::shared_ptr<std::vector<double>> values;
+    std::vector<unsigned long long> steps;
+
+    std::map<long long, unsigned long long> bins;
+    TrajectorySummary summary;
+
+    std::string output_name;
+    std::unique_ptr<std::ofstream> output;
+
+    // Log of the stored values that is extended at every checkpoint, and the number of values in it
+    std::string log_name;
+    unsigned long long n_logged;
+
+    void add_to_histogram(double log_ev);
+    void open_output(const std::string& name);
+};
@@ -5,6 +5,8 @@
 #include <stdexcept>
 #include <cstdint>
 
+#include "utilities/random.h"
+
 /**
  * Hash function for a vector containing 128bit integers
  * 
@@ -21,6 +23,21 @@ struct HashVector128 {
     }
 };
 
+/**
+ * Hash function for a 128bit integer
+ *
+ * @struct Hash128
+ */
+struct Hash128 {
+    std::size_t operator()(const __uint128_t& val) const {
+        // Combine both halves and mix the bits (finalizer of splitmix64)
+        uint64_t hash = (uint64_t) val ^ ((uint64_t) (val >> 64) * 0x9e3779b97f4a7c15ULL);
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        return hash ^ (hash >> 31);
+    }
+};
+
 /**
  * Calculates the bit count of an integer
  * 
@@ -30,9 +47,23 @@ struct HashVector128 {
  */
 int bit_count(__uint128_t integer);
 
-int randomBitIndex(__uint128_t integer);
+/**
+ * Returns the index of a random bit that is set to one.
+ * 
+ * @param integer               A non-zero 128bit integer.
+ * @param generator             Random number generator (default is the generator of the calling thread).
+ * 
+ * @return Index of the chosen bit.
+ */
+int randomBitIndex(__uint128_t integer, RandomGenerator& generator = thread_generator());
 
-__uint128_t random_128_int(int n);
+/**
+ * Returns a random integer of n bits.
+ * 
+ * @param n                     Number of random bits.
+ * @param generator             Random number generator (default is the generator of the calling thread).
+ */
+__uint128_t random_128_int(int n, RandomGenerator& generator = thread_generator());
 
 /**
  * Converts an integer to the corresponding binary string representation.
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+
+/**
+ * Distributes a number of independent tasks over a pool of worker threads.
+ * Tasks are handed out dynamically, such that long and short tasks are balanced over the threads.
+ * If one of the tasks throws an exception, the remaining tasks are skipped and the exception is rethrown after all threads have finished.
+ *
+ * @param n_tasks               Number of tasks to execute.
+ * @param n_threads             Number of worker threads (the calling thread does the work if this is 1).
+ * @param task                  Function called as task(task_index, thread_index) for every task.
+ */
+void parallel_for(int n_tasks, int n_threads, const std::function<void(int, int)>& task);
+
+/**
+ * Pool of worker threads that are started once and execute a number of tasks on every call to run.
+ * Used instead of parallel_for by loops that distribute many small sets of tasks, such that the threads are not created again every time.
+ * The tasks are handed out and the exceptions are handled as in parallel_for. Only one thread at a time should call run.
+ */
+class ThreadPool {
+public:
+    /**
+     * Starts the worker threads.
+     *
+     * @param n_threads             Number of threads that execute the tasks, including the thread that calls run.
+     */
+    ThreadPool(int n_threads);
+
+    /**
+     * Stops and joins the worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Executes a number of independent tasks on the threads of the pool and returns once all of them are finished.
+     *
+     * @param n_tasks               Number of tasks to execute.
+     * @param task                  Function called as task(task_index, thread_index) for every task.
+     */
+    void run(int n_tasks, const std::function<void(int, int)>& task);
+
+    int size() const {return this->threads.size() + 1;};
+
+private:
+    void work(int thread_index);
+    void execute(int thread_index);
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable finished;
+    // Tasks of the current call to run, the generation counts the calls such that every worker takes part once
+    const std::function<void(int, int)>* task = nullptr;
+    int n_tasks = 0;
+    unsigned long long generation = 0;
+    int n_busy = 0;
+    bool stopping = false;
+    std::atomic<int> next_task;
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+};
+
+/**
+ * Returns the number of threads that are available on this machine (at least 1).
+ *
+ * @return Number of concurrent threads supported by the hardware.
+ */
+int available_threads();
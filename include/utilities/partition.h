@@ -7,6 +7,7 @@
 #include <cmath>
 
 #include "model/mcm.h"
+#include "utilities/random.h"
 
 // Forward declaration
 class MCM;
@@ -24,10 +25,11 @@ class MCM;
  * Generate a random partition of n variables.
  * 
  * @param n                     Number of variables.
+ * @param generator             Random number generator (default is the generator of the calling thread).
  * 
  * @return partition            Random partition of the variables as a vector of n 128 bit integers.
  */
-std::vector<__uint128_t> generate_random_partition(int n);
+std::vector<__uint128_t> generate_random_partition(int n, RandomGenerator& generator = thread_generator());
 
 /**
  * Generate the independent partition of n variables.
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Pseudo-random number generator (xoshiro256**) with a 256bit state.
+ * The generator is small and fast, and it can be copied and written to a file to continue the same sequence later.
+ * Independent streams are obtained with jump(), which advances the generator by 2^128 steps.
+ * It satisfies the requirements of a uniform random bit generator, such that it can be used with the distributions of <random>.
+ */
+class RandomGenerator {
+public:
+    typedef uint64_t result_type;
+
+    /**
+     * Constructs a generator whose state is derived from a seed.
+     *
+     * @param seed                  Seed of the generator.
+     */
+    RandomGenerator(uint64_t seed = 0) {this->seed(seed);};
+
+    /**
+     * Resets the state of the generator, the same seed always gives the same sequence.
+     *
+     * @param seed                  Seed of the generator.
+     */
+    void seed(uint64_t seed);
+
+    /**
+     * Returns the next 64 random bits.
+     */
+    uint64_t operator()();
+
+    static constexpr uint64_t min() {return 0;};
+    static constexpr uint64_t max() {return UINT64_MAX;};
+
+    /**
+     * Advances the generator by 2^128 steps. Copies of a generator that are jumped a different number of times
+     * produce non-overlapping sequences that can be used by different threads.
+     */
+    void jump();
+
+    /**
+     * Returns a random integer between 0 and n-1.
+     *
+     * @param n                     Number of possible values (positive).
+     */
+    int uniform_int(int n) {return (int) (((__uint128_t) (*this)() * (uint64_t) n) >> 64);};
+
+    /**
+     * Returns a random number in the interval [0, 1).
+     */
+    double uniform_real() {return ((*this)() >> 11) * (1.0 / 9007199254740992.0);};
+
+private:
+    uint64_t state[4];
+};
+
+/**
+ * Returns a random seed obtained from the random device of the system.
+ */
+uint64_t random_seed();
+
+/**
+ * Returns the generator of the calling thread, which is seeded with a random seed when it is first used.
+ * It is used by the functions that are not given a generator.
+ */
+RandomGenerator& thread_generator();
+
+/**
+ * Returns a generator for a seed given by a user.
+ *
+ * @param seed                  Seed of the generator (a negative seed gives the generator of the calling thread).
+ *
+ * @return A generator seeded with the given seed, or a copy of the generator of the calling thread, which is advanced by a jump.
+ */
+RandomGenerator seeded_generator(long long seed);
@@ -22,7 +22,7 @@ public:
     void set_basis(py::array_t<uint8_t>& spin_ops) {this->basis.set_basis(convert_basis_from_py(spin_ops));};
     void set_basis_from_file(std::string& filename) {this->basis.set_basis_from_file(filename);};
     void set_basis_default() {this->basis.set_basis_default();};
-    int set_basis_random() {return this->basis.set_basis_random();};
+    int set_basis_random(long long seed = -1) {return this->basis.set_basis_random(seed);};
 
     void gt_data_in_place(PyData& dataset) {this->basis.gt_data_in_place(dataset.data);};
     PyData gt_data(PyData& dataset);
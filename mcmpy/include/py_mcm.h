@@ -16,7 +16,7 @@ class PyMCM {
 public:
     PyMCM(int n) : mcm(n) {};
     PyMCM(int n, py::array_t<int8_t> partition);
-    PyMCM(int n, std::string partition) : mcm(n, partition) {};
+    PyMCM(int n, std::string partition, long long seed = -1) : mcm(n, partition, seed) {};
 
     py::array_t<int8_t> get_partition_array();
     void set_partition_array(py::array_t<int8_t> partition);
@@ -32,13 +32,14 @@ public:
     py::array get_best_log_ev_per_icc();
     void print_info() {return this->mcm.print_info();};
 
-    void generate_data_file(int N, PyData& pydata, std::string file_name);
-    PyData generate_data_object(int N, PyData& pydata);
+    void generate_data_file(int N, PyData& pydata, std::string file_name, long long seed = -1);
+    PyData generate_data_object(int N, PyData& pydata, long long seed = -1);
 
     int get_n() {return this->mcm.n;};
     int get_n_comp() {return this->mcm.n_comp;};
     int get_rank() {return this->mcm.rank;};
     bool is_optimized() {return this->mcm.optimized;};
+    bool is_truncated() {return this->mcm.truncated;};
     
     MCM mcm;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
@@ -13,29 +15,172 @@ namespace py = pybind11;
 
 class PyMCMSearch {
 public:
-    PyMCMSearch() : searcher() {};
+    PyMCMSearch() : searcher() {this->searcher.set_cancellation_token(this->token);};
 
     PyMCM get_mcm_in();
     PyMCM get_mcm_out();
 
     // Search methods
-    PyMCM exhaustive_search(PyData& pydata);
+    PyMCM exhaustive_search(PyData& pydata, int shard = 0, int n_shards = 1, std::string result_file = "");
+    PyMCM merge_shards(PyData& pydata, std::vector<std::string> result_files);
     PyMCM greedy_search(PyData& pydata, PyMCM* pymcm = nullptr, std::string file_name = "");
     PyMCM divide_and_conquer(PyData& pydata, PyMCM* pymcm = nullptr, std::string file_name = "");
     PyMCM simulated_annealing(PyData& pydata, PyMCM* pymcm = nullptr, std::string file_name = "");
+    PyMCM parallel_tempering(PyData& pydata, PyMCM* pymcm = nullptr, std::string file_name = "");
+    PyMCM auto_annealing(PyData& pydata, PyMCM* pymcm = nullptr, std::string file_name = "");
+    PyMCM posterior_sampling(PyData& pydata, PyMCM* pymcm = nullptr, std::string file_name = "");
+    PyMCM refine(PyData& pydata, PyMCM* pymcm = nullptr);
+    PyMCM polish(PyData& pydata, PyMCM* pymcm = nullptr);
+    PyMCM multilevel_search(PyData& pydata, std::string file_name = "");
+    PyMCM multistart_search(PyData& pydata, std::string method, std::string file_name = "");
+    PyMCM portfolio_search(PyData& pydata, std::string file_name = "");
+    PyMCM resume_search(PyData& pydata, std::string checkpoint_file, std::string file_name = "");
 
     // Setters and getters for the simulated annealing settings
     void set_SA_max_iter(int n_iter) {this->searcher.set_SA_max_iter(n_iter);};
-    void set_SA_init_temp(int temp) {this->searcher.set_SA_init_temp(temp);};
+    void set_SA_init_temp(double temp) {this->searcher.set_SA_init_temp(temp);};
     void set_SA_update_schedule(int n_iter) {this->searcher.set_SA_update_schedule(n_iter);};
     int get_SA_max_iter() {return this->searcher.get_SA_max_iter();};
-    int get_SA_init_temp() {return this->searcher.get_SA_init_temp();};
+    double get_SA_init_temp() {return this->searcher.get_SA_init_temp();};
     int get_SA_update_schedule() {return this->searcher.get_SA_update_schedule();};
+    void set_SA_batch_size(int batch_size) {this->searcher.set_SA_batch_size(batch_size);};
+    int get_SA_batch_size() {return this->searcher.get_SA_batch_size();};
+    void set_SA_schedule(std::string schedule) {this->searcher.set_SA_schedule(schedule);};
+    std::string get_SA_schedule() {return this->searcher.get_SA_schedule();};
+    void set_SA_cooling_rate(double rate) {this->searcher.set_SA_cooling_rate(rate);};
+    double get_SA_cooling_rate() {return this->searcher.get_SA_cooling_rate();};
+    void set_SA_min_temp(double temp) {this->searcher.set_SA_min_temp(temp);};
+    double get_SA_min_temp() {return this->searcher.get_SA_min_temp();};
+    void set_SA_target_acceptance(double rate) {this->searcher.set_SA_target_acceptance(rate);};
+    double get_SA_target_acceptance() {return this->searcher.get_SA_target_acceptance();};
+    void set_SA_max_no_improve(int n_iter) {this->searcher.set_SA_max_no_improve(n_iter);};
+    int get_SA_max_no_improve() {return this->searcher.get_SA_max_no_improve();};
+    void set_SA_reheats(int n_reheats) {this->searcher.set_SA_reheats(n_reheats);};
+    int get_SA_reheats() {return this->searcher.get_SA_reheats();};
+
+    // Setters and getters for the parallel tempering settings
+    void set_PT_n_replicas(int n_replicas) {this->searcher.set_PT_n_replicas(n_replicas);};
+    void set_PT_min_temp(double temp) {this->searcher.set_PT_min_temp(temp);};
+    void set_PT_max_temp(double temp) {this->searcher.set_PT_max_temp(temp);};
+    void set_PT_swap_interval(int n_iter) {this->searcher.set_PT_swap_interval(n_iter);};
+    int get_PT_n_replicas() {return this->searcher.get_PT_n_replicas();};
+    double get_PT_min_temp() {return this->searcher.get_PT_min_temp();};
+    double get_PT_max_temp() {return this->searcher.get_PT_max_temp();};
+    int get_PT_swap_interval() {return this->searcher.get_PT_swap_interval();};
+    std::vector<double> get_PT_temperatures() {return this->searcher.get_PT_temperatures();};
+    std::vector<double> get_PT_swap_acceptance() {return this->searcher.get_PT_swap_acceptance();};
+
+    // Setters and getters for the posterior sampling settings
+    void set_sampling_chains(int n_chains) {this->searcher.set_sampling_chains(n_chains);};
+    int get_sampling_chains() {return this->searcher.get_sampling_chains();};
+    void set_sampling_iter(int n_iter) {this->searcher.set_sampling_iter(n_iter);};
+    int get_sampling_iter() {return this->searcher.get_sampling_iter();};
+    void set_sampling_burn_in(int n_iter) {this->searcher.set_sampling_burn_in(n_iter);};
+    int get_sampling_burn_in() {return this->searcher.get_sampling_burn_in();};
+    std::vector<double> get_sampling_acceptance() {return this->searcher.get_sampling_acceptance();};
+
+    // Settings shared by the search methods
+    void set_n_threads(int n_threads) {this->searcher.set_n_threads(n_threads);};
+    int get_n_threads() {return this->searcher.get_n_threads();};
+    void set_seed(uint64_t seed) {this->searcher.set_seed(seed);};
+    uint64_t get_seed() {return this->searcher.get_seed();};
+    void set_top_k(int k) {this->searcher.set_top_k(k);};
+    int get_top_k() {return this->searcher.get_top_k();};
+    void set_max_component_size(int max_size) {this->searcher.set_max_component_size(max_size);};
+    int get_max_component_size() {return this->searcher.get_max_component_size();};
+    void set_beam_width(int width) {this->searcher.set_beam_width(width);};
+    int get_beam_width() {return this->searcher.get_beam_width();};
+    void set_interaction_neighbours(int k) {this->searcher.set_interaction_neighbours(k);};
+    int get_interaction_neighbours() {return this->searcher.get_interaction_neighbours();};
+    void set_merge_pruning(bool pruning) {this->searcher.set_merge_pruning(pruning);};
+    bool get_merge_pruning() {return this->searcher.get_merge_pruning();};
+    void set_polish_size(int max_size) {this->searcher.set_polish_size(max_size);};
+    int get_polish_size() {return this->searcher.get_polish_size();};
+    void set_multilevel_group_size(int max_size) {this->searcher.set_multilevel_group_size(max_size);};
+    int get_multilevel_group_size() {return this->searcher.get_multilevel_group_size();};
+    void set_multilevel_coarse_search(std::string method) {this->searcher.set_multilevel_coarse_search(method);};
+    std::string get_multilevel_coarse_search() {return this->searcher.get_multilevel_coarse_search();};
+    void set_multistart_restarts(int n_restarts) {this->searcher.set_multistart_restarts(n_restarts);};
+    int get_multistart_restarts() {return this->searcher.get_multistart_restarts();};
+    void set_multistart_patience(int n_repeats) {this->searcher.set_multistart_patience(n_repeats);};
+    int get_multistart_patience() {return this->searcher.get_multistart_patience();};
+    std::vector<double> get_multistart_log_evidences() {return this->searcher.get_multistart_log_evidences();};
+    std::string get_portfolio_winner() {return this->searcher.get_portfolio_winner();};
+    std::vector<double> get_portfolio_log_evidences() {return this->searcher.get_portfolio_log_evidences();};
+    void set_full_dendrogram(bool full) {this->searcher.set_full_dendrogram(full);};
+    bool get_full_dendrogram() {return this->searcher.get_full_dendrogram();};
+
+    // Best partitions of the exhaustive search
+    std::vector<PyMCM> get_top_mcms();
+
+    // Groups of variables on every level of the multilevel search
+    std::vector<py::array_t<int8_t>> return_coarsening_levels();
+
+    // Merge tree of the greedy merging
+    py::array_t<double> return_dendrogram();
+    int get_dendrogram_best_n_merges() {return this->searcher.get_dendrogram().get_best_n_merges();};
+    PyMCM get_dendrogram_cut(int n_merges);
+
+    // Interaction graph of the variables
+    py::array_t<int8_t> return_interaction_graph();
+    py::array_t<double> return_mutual_information();
+
+    // Statistics of the candidate merges of the greedy merging
+    py::dict return_merge_statistics();
 
     // Log-evidence trajectory
-    py::array return_log_ev_trajectory() {return py::array(this->searcher.get_log_evidence_trajectory().size(), this->searcher.get_log_evidence_trajectory().data());};
+    py::array_t<double> return_log_ev_trajectory();
+    py::array_t<unsigned long long> return_log_ev_trajectory_steps();
+    py::tuple return_log_ev_histogram();
+    py::dict return_log_ev_summary();
+    py::dict return_SA_tuning();
+
+    // Posterior estimates of the posterior sampling
+    py::array_t<double> return_sampling_comembership();
+    py::array_t<double> return_sampling_n_comp();
+
+    // Settings for recording the trajectory
+    void set_trajectory_policy(std::string policy) {this->searcher.set_trajectory_policy(policy);};
+    void set_trajectory_interval(int k) {this->searcher.set_trajectory_interval(k);};
+    void set_trajectory_file(std::string file_name) {this->searcher.set_trajectory_file(file_name);};
+    void set_trajectory_bin_width(double width) {this->searcher.set_trajectory_bin_width(width);};
+    std::string get_trajectory_policy() {return this->searcher.get_trajectory_policy();};
+    int get_trajectory_interval() {return this->searcher.get_trajectory_interval();};
+    std::string get_trajectory_file() {return this->searcher.get_trajectory_file();};
+    double get_trajectory_bin_width() {return this->searcher.get_trajectory_bin_width();};
+
+    // Checkpoint settings
+    void set_checkpoint(std::string file_name, double interval) {this->searcher.set_checkpoint(file_name, interval);};
+    void set_checkpoint_file(std::string file_name) {this->searcher.set_checkpoint(file_name, this->searcher.get_checkpoint_interval());};
+    void set_checkpoint_interval(double interval) {this->searcher.set_checkpoint(this->searcher.get_checkpoint_file(), interval);};
+    std::string get_checkpoint_file() {return this->searcher.get_checkpoint_file();};
+    double get_checkpoint_interval() {return this->searcher.get_checkpoint_interval();};
+
+    // Stopping a running search
+    void set_time_limit(double seconds) {this->searcher.set_time_limit(seconds);};
+    double get_time_limit() {return this->searcher.get_time_limit();};
+    void cancel() {this->token.cancel();};
+    void set_progress_callback(py::object callback) {this->progress_callback = callback;};
+    py::object get_progress_callback() {return this->progress_callback;};
+    void set_progress_interval(double interval);
+    double get_progress_interval() {return this->progress_interval;};
 
     MCMSearch searcher;
+
+private:
+    /**
+     * Runs a search without the GIL, such that the search can be cancelled from another Python thread.
+     * The search stops on Ctrl-C (the KeyboardInterrupt is raised afterwards) and reports to the progress callback.
+     *
+     * @param search                Call of the search method.
+     *
+     * @return The result of the search.
+     */
+    MCM run_search(const std::function<MCM()>& search);
+
+    CancellationToken token;
+    py::object progress_callback = py::none();
+    double progress_interval = 1;
 };
 
 void bind_search_mcm_class(py::module &);
\ No newline at end of file
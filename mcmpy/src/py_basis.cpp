@@ -60,7 +60,7 @@ void bind_basis_class(py::module &m) {
         .def(py::init<int, int, std::string&>())
         .def("set_from_file", &PyBasis::set_basis_from_file, py::arg("filename"))
         .def("set_default", &PyBasis::set_basis_default)
-        .def("set_random", &PyBasis::set_basis_random)
+        .def("set_random", &PyBasis::set_basis_random, py::arg("seed") = -1)
         .def("gauge_transform_data", &PyBasis::gt_data, py::arg("data"))
         .def("gauge_transform_data_in_place", &PyBasis::gt_data_in_place, py::arg("data"))
         .def("print_details", &PyBasis::print_details)
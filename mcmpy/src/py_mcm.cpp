@@ -70,6 +70,7 @@ void PyMCM::move_var_in(int var_index, int comp_index){
     // Reset if a search has been ran before
     if (this->mcm.optimized){
         this->mcm.optimized = false;
+        this->mcm.truncated = false;
         this->mcm.log_ev_per_icc.clear();
     } 
 }
@@ -101,6 +102,7 @@ void PyMCM::move_var_out(int var_index){
     // Reset if a search has been ran before
     if (this->mcm.optimized){
         this->mcm.optimized = false;
+        this->mcm.truncated = false;
         this->mcm.log_ev_per_icc.clear();
     } 
 }
@@ -112,6 +114,7 @@ void PyMCM::move_var(int var_index, int comp_index){
     // Reset if a search has been ran before
     if (this->mcm.optimized){
         this->mcm.optimized = false;
+        this->mcm.truncated = false;
         this->mcm.log_ev_per_icc.clear();
     }
 }
@@ -125,10 +128,10 @@ py::array PyMCM::get_best_log_ev_per_icc() {
     return py::array(this->mcm.n_comp, ev_per_icc.data());
 }
 
-void PyMCM::generate_data_file(int N, PyData& pydata, std::string filename) {this->mcm.generate_data_file(N, pydata.data, filename);}
+void PyMCM::generate_data_file(int N, PyData& pydata, std::string filename, long long seed) {this->mcm.generate_data_file(N, pydata.data, filename, seed);}
 
-PyData PyMCM::generate_data_object(int N, PyData& pydata){
-    Data samples = this->mcm.generate_data_object(N, pydata.data);
+PyData PyMCM::generate_data_object(int N, PyData& pydata, long long seed){
+    Data samples = this->mcm.generate_data_object(N, pydata.data, seed);
     PyData pysamples = PyData(samples);
 
     return pysamples;
@@ -138,19 +141,20 @@ void bind_mcm_class(py::module &m) {
     py::class_<PyMCM>(m, "MCM")
         .def(py::init<int>(), py::arg("n"))
         .def(py::init<int, py::array_t<int8_t>>(), py::arg("n"), py::arg("partition"))
-        .def(py::init<int, const std::string&>(), py::arg("n"), py::arg("partition"))
+        .def(py::init<int, const std::string&, long long>(), py::arg("n"), py::arg("partition"), py::arg("seed") = -1)
         .def("move_variable_in", &PyMCM::move_var_in, py::arg("var_index"), py::arg("comp_index"))
         .def("move_variable_out", &PyMCM::move_var_out, py::arg("var_index"))
         .def("move_variable", &PyMCM::move_var, py::arg("var_index"), py::arg("comp_index"))
         .def("get_best_log_evidence", &PyMCM::get_best_log_ev)
         .def("get_best_log_evidence_icc", &PyMCM::get_best_log_ev_per_icc)
         .def("print_details", &PyMCM::print_info)
-        .def("generate_data_file", &PyMCM::generate_data_file, py::arg("N_samples"), py::arg("data"), py::arg("filename"))
-        .def("generate_data_object", &PyMCM::generate_data_object, py::arg("N_samples"), py::arg("data"))
+        .def("generate_data_file", &PyMCM::generate_data_file, py::arg("N_samples"), py::arg("data"), py::arg("filename"), py::arg("seed") = -1)
+        .def("generate_data_object", &PyMCM::generate_data_object, py::arg("N_samples"), py::arg("data"), py::arg("seed") = -1)
         .def_property("array", &PyMCM::get_partition_array, &PyMCM::set_partition_array)
         .def_property("array_gray_code", &PyMCM::get_partition_as_gray_code, &PyMCM::set_partition_gray_code)
         .def_property_readonly("n", &PyMCM::get_n)
         .def_property_readonly("n_icc", &PyMCM::get_n_comp)
         .def_property_readonly("rank", &PyMCM::get_rank)
-        .def_property_readonly("is_optimized", &PyMCM::is_optimized);
+        .def_property_readonly("is_optimized", &PyMCM::is_optimized)
+        .def_property_readonly("is_truncated", &PyMCM::is_truncated);
 }
\ No newline at end of file
@@ -14,19 +14,219 @@ PyMCM PyMCMSearch::get_mcm_out(){
     return mcm;
 }
 
-PyMCM PyMCMSearch::exhaustive_search(PyData& pydata) {
+std::vector<PyMCM> PyMCMSearch::get_top_mcms(){
+    std::vector<PyMCM> top_mcms;
+    for (MCM& mcm : this->searcher.get_top_mcms()){
+        PyMCM pymcm(mcm.n);
+        pymcm.mcm = mcm;
+        top_mcms.push_back(pymcm);
+    }
+    return top_mcms;
+}
+
+py::array_t<double> PyMCMSearch::return_dendrogram(){
+    // One row per merge: indices of the merged components, log-evidence of the merged component and of the partition
+    const std::vector<DendrogramStep>& steps = this->searcher.get_dendrogram().get_steps();
+    py::array_t<double> array({(py::ssize_t) steps.size(), (py::ssize_t) 4});
+    auto array_ptr = array.mutable_unchecked<2>();
+    for (size_t k = 0; k < steps.size(); k++){
+        array_ptr(k, 0) = steps[k].i;
+        array_ptr(k, 1) = steps[k].j;
+        array_ptr(k, 2) = steps[k].log_ev_merged;
+        array_ptr(k, 3) = steps[k].log_ev;
+    }
+    return array;
+}
+
+py::array_t<int8_t> PyMCMSearch::return_interaction_graph(){
+    // Adjacency matrix of the graph (empty if all pairs are used)
+    std::vector<__uint128_t> graph = this->searcher.get_interaction_graph();
+    int n = graph.size();
+    py::array_t<int8_t> array({(py::ssize_t) n, (py::ssize_t) n});
+    auto array_ptr = array.mutable_unchecked<2>();
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            array_ptr(i, j) = (graph[i] >> j) & 1;
+        }
+    }
+    return array;
+}
+
+py::array_t<double> PyMCMSearch::return_mutual_information(){
+    std::vector<double> mutual_information = this->searcher.get_mutual_information();
+    int n = this->searcher.get_interaction_graph().size();
+    py::array_t<double> array({(py::ssize_t) n, (py::ssize_t) n});
+    std::copy(mutual_information.begin(), mutual_information.end(), array.mutable_data());
+    return array;
+}
+
+py::array_t<double> PyMCMSearch::return_sampling_comembership(){
+    std::vector<std::vector<double>> comembership = this->searcher.get_sampling_comembership();
+    int n = comembership.size();
+    py::array_t<double> array({(py::ssize_t) n, (py::ssize_t) n});
+    auto array_ptr = array.mutable_unchecked<2>();
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < n; j++){
+            array_ptr(i, j) = comembership[i][j];
+        }
+    }
+    return array;
+}
+
+py::array_t<double> PyMCMSearch::return_sampling_n_comp(){
+    std::vector<double> n_comp = this->searcher.get_sampling_n_comp();
+    return py::array_t<double>(n_comp.size(), n_comp.data());
+}
+
+py::dict PyMCMSearch::return_merge_statistics(){
+    MergeStatistics statistics = this->searcher.get_merge_statistics();
+    py::dict result;
+    result["candidates"] = statistics.n_candidates;
+    result["evaluated"] = statistics.n_evaluated;
+    result["pruned_bound"] = statistics.n_pruned_bound;
+    result["pruned_best"] = statistics.n_pruned_best;
+    return result;
+}
+
+PyMCM PyMCMSearch::get_dendrogram_cut(int n_merges){
+    PyMCM mcm(this->searcher.get_mcm_out().n);
+    mcm.mcm = this->searcher.get_dendrogram_cut(n_merges);
+    return mcm;
+}
+
+py::array_t<double> PyMCMSearch::return_log_ev_trajectory(){
+    // The array is a view on the recorded trajectory, the capsule keeps the trajectory alive as long as the array exists
+    std::shared_ptr<std::vector<double>>* trajectory = new std::shared_ptr<std::vector<double>>(this->searcher.get_log_evidence_trajectory_ptr());
+    py::capsule owner(trajectory, [](void* ptr){delete reinterpret_cast<std::shared_ptr<std::vector<double>>*>(ptr);});
+
+    py::array_t<double> array((*trajectory)->size(), (*trajectory)->data(), owner);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+py::array_t<unsigned long long> PyMCMSearch::return_log_ev_trajectory_steps(){
+    std::vector<unsigned long long> steps = this->searcher.get_log_evidence_trajectory_steps();
+    return py::array_t<unsigned long long>(steps.size(), steps.data());
+}
+
+py::tuple PyMCMSearch::return_log_ev_histogram(){
+    std::vector<std::pair<double, unsigned long long>> histogram = this->searcher.get_log_evidence_histogram();
+    py::array_t<double> edges(histogram.size());
+    py::array_t<unsigned long long> counts(histogram.size());
+    auto edges_ptr = edges.mutable_unchecked<1>();
+    auto counts_ptr = counts.mutable_unchecked<1>();
+    for (size_t i = 0; i < histogram.size(); i++){
+        edges_ptr(i) = histogram[i].first;
+        counts_ptr(i) = histogram[i].second;
+    }
+    return py::make_tuple(edges, counts);
+}
+
+py::dict PyMCMSearch::return_log_ev_summary(){
+    TrajectorySummary summary = this->searcher.get_log_evidence_summary();
+    py::dict result;
+    result["count"] = summary.count;
+    result["min"] = summary.min;
+    result["max"] = summary.max;
+    result["mean"] = summary.mean;
+    result["std"] = sqrt(summary.variance());
+    return result;
+}
+
+py::dict PyMCMSearch::return_SA_tuning(){
+    SA_tuning tuning = this->searcher.get_SA_tuning();
+    py::dict result;
+    result["merge_delta"] = tuning.merge_delta;
+    result["split_delta"] = tuning.split_delta;
+    result["switch_delta"] = tuning.switch_delta;
+    result["temperature_initial"] = tuning.init_temp;
+    result["temperature_min"] = tuning.min_temp;
+    result["cooling_rate"] = tuning.cooling_rate;
+    result["temperature_iteration_update"] = tuning.update_schedule;
+    result["max_iteration"] = tuning.max_iter;
+    result["pilot_budgets"] = tuning.pilot_budgets;
+    result["pilot_log_evidences"] = tuning.pilot_log_evidences;
+    return result;
+}
+
+void PyMCMSearch::set_progress_interval(double interval){
+    if (interval <= 0){
+        throw std::invalid_argument("The interval between two progress reports should be positive.");
+    }
+    this->progress_interval = interval;
+}
+
+MCM PyMCMSearch::run_search(const std::function<MCM()>& search){
+    // A cancellation only stops the search that is running
+    this->token.reset();
+
+    // The callback of the searcher is called (with the GIL released) by the thread that started the search:
+    // it checks for Ctrl-C every 0.1 seconds and calls the Python callback at its own interval
+    std::unique_ptr<py::error_already_set> error;
+    double next_report = this->progress_interval;
+    this->searcher.set_progress_callback([&](const SearchProgress& progress){
+        py::gil_scoped_acquire acquire;
+        try {
+            if (PyErr_CheckSignals() != 0){
+                throw py::error_already_set();
+            }
+            if (! this->progress_callback.is_none() && progress.elapsed >= next_report){
+                next_report = progress.elapsed + this->progress_interval;
+                // The search stops if the callback returns False (None continues)
+                py::object result = this->progress_callback(progress.elapsed, progress.log_ev);
+                if (result.is_none()){return true;}
+                int proceed = PyObject_IsTrue(result.ptr());
+                if (proceed < 0){
+                    throw py::error_already_set();
+                }
+                return proceed != 0;
+            }
+        }
+        catch (py::error_already_set& err){
+            error.reset(new py::error_already_set(std::move(err)));
+            return false;
+        }
+        return true;
+    }, 0.1);
+
+    // The callback refers to this frame, it is removed when the search ends (also if it throws)
+    struct CallbackGuard {
+        MCMSearch& searcher;
+        ~CallbackGuard() {this->searcher.set_progress_callback(ProgressCallback(), 1);};
+    } guard{this->searcher};
+
+    MCM result = [&](){
+        py::gil_scoped_release release;
+        return search();
+    }();
+
+    // Raise the exception of the callback (or the KeyboardInterrupt), the result of the stopped search is kept by the searcher
+    if (error){
+        error->restore();
+        throw py::error_already_set();
+    }
+    return result;
+}
+
+PyMCM PyMCMSearch::exhaustive_search(PyData& pydata, int shard, int n_shards, std::string result_file) {
+    PyMCM mcm(pydata.get_n());
+    mcm.mcm = this->run_search([&](){return this->searcher.exhaustive_search(pydata.data, shard, n_shards, result_file);});
+    return mcm;
+}
+
+PyMCM PyMCMSearch::merge_shards(PyData& pydata, std::vector<std::string> result_files) {
     PyMCM mcm(pydata.get_n());
-    mcm.mcm = this->searcher.exhaustive_search(pydata.data);
+    mcm.mcm = this->run_search([&](){return this->searcher.merge_shards(pydata.data, result_files);});
     return mcm;
 }
 
 PyMCM PyMCMSearch::greedy_search(PyData& pydata, PyMCM* pymcm, std::string file_name) {
     PyMCM mcm(pydata.get_n());
     if (pymcm){
-        mcm.mcm = this->searcher.greedy_search(pydata.data, &pymcm->mcm, file_name);
+        mcm.mcm = this->run_search([&](){return this->searcher.greedy_search(pydata.data, &pymcm->mcm, file_name);});
     }
     else{
-        mcm.mcm = this->searcher.greedy_search(pydata.data, nullptr, file_name);
+        mcm.mcm = this->run_search([&](){return this->searcher.greedy_search(pydata.data, nullptr, file_name);});
     }
     return mcm;
 }
@@ -34,10 +234,10 @@ PyMCM PyMCMSearch::greedy_search(PyData& pydata, PyMCM* pymcm, std::string file_
 PyMCM PyMCMSearch::divide_and_conquer(PyData& pydata, PyMCM* pymcm, std::string file_name) {
     PyMCM mcm(pydata.get_n());
     if (pymcm){
-        mcm.mcm = this->searcher.divide_and_conquer(pydata.data, &pymcm->mcm, file_name);
+        mcm.mcm = this->run_search([&](){return this->searcher.divide_and_conquer(pydata.data, &pymcm->mcm, file_name);});
     }
     else{
-        mcm.mcm = this->searcher.divide_and_conquer(pydata.data, nullptr, file_name);
+        mcm.mcm = this->run_search([&](){return this->searcher.divide_and_conquer(pydata.data, nullptr, file_name);});
     }
     return mcm;
 }
@@ -45,11 +245,99 @@ PyMCM PyMCMSearch::divide_and_conquer(PyData& pydata, PyMCM* pymcm, std::string
 PyMCM PyMCMSearch::simulated_annealing(PyData& pydata, PyMCM* pymcm, std::string file_name) {
     PyMCM mcm(pydata.get_n());
     if (pymcm){
-        mcm.mcm = this->searcher.simulated_annealing(pydata.data, &pymcm->mcm);
+        mcm.mcm = this->run_search([&](){return this->searcher.simulated_annealing(pydata.data, &pymcm->mcm);});
     }
     else{
-        mcm.mcm = this->searcher.simulated_annealing(pydata.data, nullptr, file_name);
+        mcm.mcm = this->run_search([&](){return this->searcher.simulated_annealing(pydata.data, nullptr, file_name);});
+    }
+    return mcm;
+}
+
+PyMCM PyMCMSearch::parallel_tempering(PyData& pydata, PyMCM* pymcm, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    if (pymcm){
+        mcm.mcm = this->run_search([&](){return this->searcher.parallel_tempering(pydata.data, &pymcm->mcm, file_name);});
     }
+    else{
+        mcm.mcm = this->run_search([&](){return this->searcher.parallel_tempering(pydata.data, nullptr, file_name);});
+    }
+    return mcm;
+}
+
+PyMCM PyMCMSearch::auto_annealing(PyData& pydata, PyMCM* pymcm, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    if (pymcm){
+        mcm.mcm = this->run_search([&](){return this->searcher.auto_annealing(pydata.data, &pymcm->mcm, file_name);});
+    }
+    else{
+        mcm.mcm = this->run_search([&](){return this->searcher.auto_annealing(pydata.data, nullptr, file_name);});
+    }
+    return mcm;
+}
+
+PyMCM PyMCMSearch::posterior_sampling(PyData& pydata, PyMCM* pymcm, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    if (pymcm){
+        mcm.mcm = this->run_search([&](){return this->searcher.posterior_sampling(pydata.data, &pymcm->mcm, file_name);});
+    }
+    else{
+        mcm.mcm = this->run_search([&](){return this->searcher.posterior_sampling(pydata.data, nullptr, file_name);});
+    }
+    return mcm;
+}
+
+PyMCM PyMCMSearch::refine(PyData& pydata, PyMCM* pymcm) {
+    PyMCM mcm(pydata.get_n());
+    if (pymcm){
+        mcm.mcm = this->run_search([&](){return this->searcher.refine(pydata.data, &pymcm->mcm);});
+    }
+    else{
+        mcm.mcm = this->run_search([&](){return this->searcher.refine(pydata.data, nullptr);});
+    }
+    return mcm;
+}
+
+PyMCM PyMCMSearch::polish(PyData& pydata, PyMCM* pymcm) {
+    PyMCM mcm(pydata.get_n());
+    if (pymcm){
+        mcm.mcm = this->run_search([&](){return this->searcher.polish(pydata.data, &pymcm->mcm);});
+    }
+    else{
+        mcm.mcm = this->run_search([&](){return this->searcher.polish(pydata.data, nullptr);});
+    }
+    return mcm;
+}
+
+PyMCM PyMCMSearch::multilevel_search(PyData& pydata, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    mcm.mcm = this->run_search([&](){return this->searcher.multilevel_search(pydata.data, file_name);});
+    return mcm;
+}
+
+PyMCM PyMCMSearch::multistart_search(PyData& pydata, std::string method, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    mcm.mcm = this->run_search([&](){return this->searcher.multistart_search(pydata.data, method, file_name);});
+    return mcm;
+}
+
+PyMCM PyMCMSearch::portfolio_search(PyData& pydata, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    mcm.mcm = this->run_search([&](){return this->searcher.portfolio_search(pydata.data, file_name);});
+    return mcm;
+}
+
+std::vector<py::array_t<int8_t>> PyMCMSearch::return_coarsening_levels(){
+    std::vector<std::vector<__uint128_t>> levels = this->searcher.get_coarsening_levels();
+    std::vector<py::array_t<int8_t>> py_levels;
+    for (std::vector<__uint128_t>& groups : levels){
+        py_levels.push_back(convert_partition_to_py(groups, levels[0].size(), groups.size()));
+    }
+    return py_levels;
+}
+
+PyMCM PyMCMSearch::resume_search(PyData& pydata, std::string checkpoint_file, std::string file_name) {
+    PyMCM mcm(pydata.get_n());
+    mcm.mcm = this->run_search([&](){return this->searcher.resume_search(pydata.data, checkpoint_file, file_name);});
     return mcm;
 }
 
@@ -58,12 +346,80 @@ void bind_search_mcm_class(py::module &m) {
         .def(py::init<>())
         .def("get_mcm_in", &PyMCMSearch::get_mcm_in)
         .def("get_mcm_out", &PyMCMSearch::get_mcm_out)
-        .def("exhaustive", &PyMCMSearch::exhaustive_search, py::arg("data"))
+        .def("get_top_mcms", &PyMCMSearch::get_top_mcms)
+        .def("get_dendrogram_cut", &PyMCMSearch::get_dendrogram_cut, py::arg("n_merges"))
+        .def("exhaustive", &PyMCMSearch::exhaustive_search, py::arg("data"), py::arg("shard") = 0, py::arg("n_shards") = 1, py::arg("result_file") = "")
+        .def("merge_shards", &PyMCMSearch::merge_shards, py::arg("data"), py::arg("result_files"))
         .def("hierarchical_greedy_merging", &PyMCMSearch::greedy_search, py::arg("data"), py::arg("mcm_in") = nullptr, py::arg("filename") = "")
         .def("hierarchical_greedy_divisive", &PyMCMSearch::divide_and_conquer, py::arg("data"), py::arg("mcm_in") = nullptr, py::arg("filename") = "")
         .def("simulated_annealing", &PyMCMSearch::simulated_annealing, py::arg("data"), py::arg("mcm_in") = nullptr, py::arg("filename") = "")
+        .def("parallel_tempering", &PyMCMSearch::parallel_tempering, py::arg("data"), py::arg("mcm_in") = nullptr, py::arg("filename") = "")
+        .def("auto_annealing", &PyMCMSearch::auto_annealing, py::arg("data"), py::arg("mcm_in") = nullptr, py::arg("filename") = "")
+        .def("posterior_sampling", &PyMCMSearch::posterior_sampling, py::arg("data"), py::arg("mcm_in") = nullptr, py::arg("filename") = "")
+        .def("refine", &PyMCMSearch::refine, py::arg("data"), py::arg("mcm_in") = nullptr)
+        .def("polish", &PyMCMSearch::polish, py::arg("data"), py::arg("mcm_in") = nullptr)
+        .def("multilevel", &PyMCMSearch::multilevel_search, py::arg("data"), py::arg("filename") = "")
+        .def("multistart", &PyMCMSearch::multistart_search, py::arg("data"), py::arg("method") = "greedy", py::arg("filename") = "")
+        .def("portfolio", &PyMCMSearch::portfolio_search, py::arg("data"), py::arg("filename") = "")
+        .def("resume", &PyMCMSearch::resume_search, py::arg("data"), py::arg("checkpoint_file"), py::arg("filename") = "")
+        .def("set_checkpoint", &PyMCMSearch::set_checkpoint, py::arg("filename"), py::arg("interval") = 600)
+        .def("cancel", &PyMCMSearch::cancel)
+        .def_property("time_limit", &PyMCMSearch::get_time_limit, &PyMCMSearch::set_time_limit)
+        .def_property("progress_callback", &PyMCMSearch::get_progress_callback, &PyMCMSearch::set_progress_callback)
+        .def_property("progress_interval", &PyMCMSearch::get_progress_interval, &PyMCMSearch::set_progress_interval)
         .def_property("SA_max_iteration", &PyMCMSearch::get_SA_max_iter, &PyMCMSearch::set_SA_max_iter)
         .def_property("SA_temperature_initial", &PyMCMSearch::get_SA_init_temp, &PyMCMSearch::set_SA_init_temp)
         .def_property("SA_temperature_iteration_update", &PyMCMSearch::get_SA_update_schedule, &PyMCMSearch::set_SA_update_schedule)
-        .def_property_readonly("log_evidence_trajectory", &PyMCMSearch::return_log_ev_trajectory);
+        .def_property("SA_batch_size", &PyMCMSearch::get_SA_batch_size, &PyMCMSearch::set_SA_batch_size)
+        .def_property("SA_schedule", &PyMCMSearch::get_SA_schedule, &PyMCMSearch::set_SA_schedule)
+        .def_property("SA_cooling_rate", &PyMCMSearch::get_SA_cooling_rate, &PyMCMSearch::set_SA_cooling_rate)
+        .def_property("SA_temperature_min", &PyMCMSearch::get_SA_min_temp, &PyMCMSearch::set_SA_min_temp)
+        .def_property("SA_target_acceptance", &PyMCMSearch::get_SA_target_acceptance, &PyMCMSearch::set_SA_target_acceptance)
+        .def_property("SA_max_no_improve", &PyMCMSearch::get_SA_max_no_improve, &PyMCMSearch::set_SA_max_no_improve)
+        .def_property("SA_reheats", &PyMCMSearch::get_SA_reheats, &PyMCMSearch::set_SA_reheats)
+        .def_property_readonly("SA_tuning", &PyMCMSearch::return_SA_tuning)
+        .def_property("PT_n_replicas", &PyMCMSearch::get_PT_n_replicas, &PyMCMSearch::set_PT_n_replicas)
+        .def_property("PT_temperature_min", &PyMCMSearch::get_PT_min_temp, &PyMCMSearch::set_PT_min_temp)
+        .def_property("PT_temperature_max", &PyMCMSearch::get_PT_max_temp, &PyMCMSearch::set_PT_max_temp)
+        .def_property("PT_swap_interval", &PyMCMSearch::get_PT_swap_interval, &PyMCMSearch::set_PT_swap_interval)
+        .def_property_readonly("PT_temperatures", &PyMCMSearch::get_PT_temperatures)
+        .def_property_readonly("PT_swap_acceptance", &PyMCMSearch::get_PT_swap_acceptance)
+        .def_property("sampling_chains", &PyMCMSearch::get_sampling_chains, &PyMCMSearch::set_sampling_chains)
+        .def_property("sampling_iteration", &PyMCMSearch::get_sampling_iter, &PyMCMSearch::set_sampling_iter)
+        .def_property("sampling_burn_in", &PyMCMSearch::get_sampling_burn_in, &PyMCMSearch::set_sampling_burn_in)
+        .def_property_readonly("sampling_comembership", &PyMCMSearch::return_sampling_comembership)
+        .def_property_readonly("sampling_n_components", &PyMCMSearch::return_sampling_n_comp)
+        .def_property_readonly("sampling_acceptance", &PyMCMSearch::get_sampling_acceptance)
+        .def_property("n_threads", &PyMCMSearch::get_n_threads, &PyMCMSearch::set_n_threads)
+        .def_property("seed", &PyMCMSearch::get_seed, &PyMCMSearch::set_seed)
+        .def_property("top_k", &PyMCMSearch::get_top_k, &PyMCMSearch::set_top_k)
+        .def_property("max_component_size", &PyMCMSearch::get_max_component_size, &PyMCMSearch::set_max_component_size)
+        .def_property("beam_width", &PyMCMSearch::get_beam_width, &PyMCMSearch::set_beam_width)
+        .def_property("interaction_neighbours", &PyMCMSearch::get_interaction_neighbours, &PyMCMSearch::set_interaction_neighbours)
+        .def_property("merge_pruning", &PyMCMSearch::get_merge_pruning, &PyMCMSearch::set_merge_pruning)
+        .def_property("polish_size", &PyMCMSearch::get_polish_size, &PyMCMSearch::set_polish_size)
+        .def_property("multilevel_group_size", &PyMCMSearch::get_multilevel_group_size, &PyMCMSearch::set_multilevel_group_size)
+        .def_property("multilevel_coarse_search", &PyMCMSearch::get_multilevel_coarse_search, &PyMCMSearch::set_multilevel_coarse_search)
+        .def_property("multistart_restarts", &PyMCMSearch::get_multistart_restarts, &PyMCMSearch::set_multistart_restarts)
+        .def_property("multistart_patience", &PyMCMSearch::get_multistart_patience, &PyMCMSearch::set_multistart_patience)
+        .def_property_readonly("multistart_log_evidences", &PyMCMSearch::get_multistart_log_evidences)
+        .def_property_readonly("portfolio_winner", &PyMCMSearch::get_portfolio_winner)
+        .def_property_readonly("portfolio_log_evidences", &PyMCMSearch::get_portfolio_log_evidences)
+        .def_property("full_dendrogram", &PyMCMSearch::get_full_dendrogram, &PyMCMSearch::set_full_dendrogram)
+        .def_property("trajectory_policy", &PyMCMSearch::get_trajectory_policy, &PyMCMSearch::set_trajectory_policy)
+        .def_property("trajectory_interval", &PyMCMSearch::get_trajectory_interval, &PyMCMSearch::set_trajectory_interval)
+        .def_property("trajectory_file", &PyMCMSearch::get_trajectory_file, &PyMCMSearch::set_trajectory_file)
+        .def_property("trajectory_bin_width", &PyMCMSearch::get_trajectory_bin_width, &PyMCMSearch::set_trajectory_bin_width)
+        .def_property("checkpoint_file", &PyMCMSearch::get_checkpoint_file, &PyMCMSearch::set_checkpoint_file)
+        .def_property("checkpoint_interval", &PyMCMSearch::get_checkpoint_interval, &PyMCMSearch::set_checkpoint_interval)
+        .def_property_readonly("log_evidence_trajectory", &PyMCMSearch::return_log_ev_trajectory)
+        .def_property_readonly("log_evidence_trajectory_steps", &PyMCMSearch::return_log_ev_trajectory_steps)
+        .def_property_readonly("log_evidence_histogram", &PyMCMSearch::return_log_ev_histogram)
+        .def_property_readonly("log_evidence_summary", &PyMCMSearch::return_log_ev_summary)
+        .def_property_readonly("coarsening_levels", &PyMCMSearch::return_coarsening_levels)
+        .def_property_readonly("interaction_graph", &PyMCMSearch::return_interaction_graph)
+        .def_property_readonly("mutual_information", &PyMCMSearch::return_mutual_information)
+        .def_property_readonly("merge_statistics", &PyMCMSearch::return_merge_statistics)
+        .def_property_readonly("dendrogram", &PyMCMSearch::return_dendrogram)
+        .def_property_readonly("dendrogram_best_n_merges", &PyMCMSearch::get_dendrogram_best_n_merges);
 }
\ No newline at end of file
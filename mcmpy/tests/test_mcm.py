@@ -123,3 +123,11 @@ def test_data_file(scotus_data_q2, opt_mcm_scotus_q2, tmp_path):
     assert data.N_synthetic == 10_000
     assert data.q == scotus_data_q2.q
     assert data.n == scotus_data_q2.n
+
+def test_seed(scotus_data_q2, opt_mcm_scotus_q2, tmp_path):
+    assert np.array_equal(MCM(20, "random", seed=4).array, MCM(20, "random", seed=4).array)
+    file_1 = str(tmp_path / "samples_1.dat")
+    file_2 = str(tmp_path / "samples_2.dat")
+    opt_mcm_scotus_q2.generate_data_file(100, scotus_data_q2, file_1, seed=9)
+    opt_mcm_scotus_q2.generate_data_file(100, scotus_data_q2, file_2, seed=9)
+    assert open(file_1).read() == open(file_2).read()
@@ -1,3 +1,5 @@
+import time
+import threading
 import pytest
 import numpy as np
 from mcmpy import Data, MCM, MCMSearch
@@ -181,3 +183,369 @@ def test_scotus_q_5(mcm_searcher, scotus_data_q5):
 
     # MCM log-evidence
     assert np.allclose(log_ev, -4261.89)
+
+def test_exhaustive_top_k(mcm_searcher, scotus_data_q2):
+    mcm_searcher.top_k = 5
+    mcm_searcher.n_threads = 2
+    opt_mcm = mcm_searcher.exhaustive(scotus_data_q2)
+    top_mcms = mcm_searcher.get_top_mcms()
+
+    assert len(top_mcms) == 5
+    assert len(mcm_searcher.log_evidence_trajectory) == 0
+    assert np.all(top_mcms[0].array == opt_mcm.array)
+    log_evs = [mcm.get_best_log_evidence() for mcm in top_mcms]
+    assert np.all(np.diff(log_evs) <= 0)
+    assert np.isclose(log_evs[0], -3300.4)
+
+def test_trajectory_policy(mcm_searcher, scotus_data_q2):
+    mcm_searcher.exhaustive(scotus_data_q2)
+    all_evs = np.array(mcm_searcher.log_evidence_trajectory)
+
+    mcm_searcher.trajectory_policy = "every_k"
+    mcm_searcher.trajectory_interval = 1000
+    mcm_searcher.exhaustive(scotus_data_q2)
+    assert np.all(mcm_searcher.log_evidence_trajectory == all_evs[::1000])
+    assert np.all(mcm_searcher.log_evidence_trajectory_steps == np.arange(0, len(all_evs), 1000))
+
+    mcm_searcher.trajectory_policy = "histogram"
+    mcm_searcher.exhaustive(scotus_data_q2)
+    edges, counts = mcm_searcher.log_evidence_histogram
+    assert counts.sum() == len(all_evs)
+    assert np.isclose(mcm_searcher.log_evidence_summary["max"], all_evs.max())
+
+    with pytest.raises(ValueError):
+        mcm_searcher.trajectory_policy = "sometimes"
+
+def test_checkpoint(mcm_searcher, scotus_data_q2, tmp_path):
+    checkpoint = str(tmp_path / "checkpoint.bin")
+    mcm_searcher.set_checkpoint(checkpoint, 0)
+    assert mcm_searcher.checkpoint_file == checkpoint
+    assert mcm_searcher.checkpoint_interval == 0
+    opt_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+
+    resumed_searcher = MCMSearch()
+    resumed_mcm = resumed_searcher.resume(scotus_data_q2, checkpoint)
+    assert np.all(resumed_mcm.array == opt_mcm.array)
+    assert np.all(resumed_searcher.log_evidence_trajectory == mcm_searcher.log_evidence_trajectory)
+
+    with pytest.raises(ValueError):
+        mcm_searcher.checkpoint_interval = -1
+
+def test_exhaustive_shards(mcm_searcher, scotus_data_q2, tmp_path):
+    opt_mcm = mcm_searcher.exhaustive(scotus_data_q2)
+
+    result_files = [str(tmp_path / f"shard_{i}.bin") for i in range(2)]
+    for shard, result_file in enumerate(result_files):
+        MCMSearch().exhaustive(scotus_data_q2, shard, 2, result_file)
+
+    merged_mcm = mcm_searcher.merge_shards(scotus_data_q2, result_files)
+    assert np.all(merged_mcm.array == opt_mcm.array)
+    assert mcm_searcher.log_evidence_summary["count"] == 21147
+
+    with pytest.raises(ValueError):
+        mcm_searcher.merge_shards(scotus_data_q2, result_files[:1])
+
+def test_exhaustive_max_component_size(mcm_searcher, scotus_data_q2):
+    mcm_searcher.exhaustive(scotus_data_q2)
+    n_partitions = len(mcm_searcher.log_evidence_trajectory)
+
+    mcm_searcher.max_component_size = 2
+    opt_mcm = mcm_searcher.exhaustive(scotus_data_q2)
+    assert len(mcm_searcher.log_evidence_trajectory) < n_partitions
+    assert np.all(np.sum(opt_mcm.array, axis=1) <= 2)
+
+    with pytest.raises(ValueError):
+        mcm_searcher.max_component_size = -1
+
+def test_greedy_beam(mcm_searcher, scotus_data_q2):
+    greedy_log_ev = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2).get_best_log_evidence()
+
+    mcm_searcher.beam_width = 4
+    assert mcm_searcher.beam_width == 4
+    beam_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    assert beam_mcm.get_best_log_evidence() >= greedy_log_ev
+
+    with pytest.raises(ValueError):
+        mcm_searcher.beam_width = 0
+
+def test_greedy_dendrogram(mcm_searcher, scotus_data_q2):
+    greedy_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+
+    mcm_searcher.full_dendrogram = True
+    full_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    assert np.all(full_mcm.array == greedy_mcm.array)
+
+    dendrogram = mcm_searcher.dendrogram
+    assert dendrogram.shape == (8, 4)
+    assert np.all(dendrogram[:, 0] < dendrogram[:, 1])
+    best = mcm_searcher.dendrogram_best_n_merges
+    assert np.isclose(dendrogram[best - 1, 3], greedy_mcm.get_best_log_evidence())
+
+    cut_mcm = mcm_searcher.get_dendrogram_cut(best)
+    assert np.all(cut_mcm.array == greedy_mcm.array)
+    assert mcm_searcher.get_dendrogram_cut(8).n_icc == 1
+
+    with pytest.raises(ValueError):
+        mcm_searcher.get_dendrogram_cut(9)
+
+def test_refine(mcm_searcher, scotus_data_q2):
+    with pytest.raises(RuntimeError):
+        mcm_searcher.refine(scotus_data_q2)
+
+    greedy_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    refined_mcm = mcm_searcher.refine(scotus_data_q2)
+    assert refined_mcm.is_optimized
+    assert refined_mcm.get_best_log_evidence() >= greedy_mcm.get_best_log_evidence() - 1e-6
+
+    mcm_in = MCM(9, "complete")
+    refined_mcm = mcm_searcher.refine(scotus_data_q2, mcm_in)
+    assert refined_mcm.get_best_log_evidence() > scotus_data_q2.log_evidence(mcm_in)
+
+def test_greedy_pruning(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.merge_pruning
+    pruned_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    statistics = mcm_searcher.merge_statistics
+    assert statistics["candidates"] == statistics["evaluated"] + statistics["pruned_bound"] + statistics["pruned_best"]
+
+    mcm_searcher.merge_pruning = False
+    full_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    assert np.all(pruned_mcm.array == full_mcm.array)
+    assert mcm_searcher.merge_statistics["evaluated"] == mcm_searcher.merge_statistics["candidates"]
+
+def test_interaction_graph(mcm_searcher, scotus_data_q2):
+    mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    assert mcm_searcher.interaction_graph.size == 0
+    n_candidates = mcm_searcher.merge_statistics["candidates"]
+
+    mcm_searcher.interaction_neighbours = 2
+    sparse_mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    graph = mcm_searcher.interaction_graph
+    assert graph.shape == (9, 9)
+    assert np.all(graph == graph.T)
+    assert np.all(np.sum(graph, axis=1) >= 2)
+    assert np.allclose(mcm_searcher.mutual_information, mcm_searcher.mutual_information.T)
+    assert mcm_searcher.merge_statistics["candidates"] < n_candidates
+    assert np.isclose(sparse_mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(sparse_mcm))
+
+    with pytest.raises(ValueError):
+        mcm_searcher.interaction_neighbours = -1
+
+def test_multilevel(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.multilevel_group_size == 4
+    assert mcm_searcher.multilevel_coarse_search == "greedy"
+    mcm = mcm_searcher.multilevel(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+
+    levels = mcm_searcher.coarsening_levels
+    assert len(levels) > 1
+    assert np.array_equal(levels[0], np.eye(9))
+    for level in levels:
+        assert np.all(np.sum(level, axis=0) == 1)
+        assert np.all(np.sum(level, axis=1) <= 4)
+
+    mcm_searcher.multilevel_coarse_search = "annealing"
+    mcm_searcher.SA_max_iteration = 5000
+    mcm = mcm_searcher.multilevel(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+
+    with pytest.raises(ValueError):
+        mcm_searcher.multilevel_group_size = 0
+    with pytest.raises(ValueError):
+        mcm_searcher.multilevel_coarse_search = "exhaustive"
+
+def test_polish(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.polish_size == 12
+    mcm_greedy = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    mcm_polished = mcm_searcher.polish(scotus_data_q2)
+    assert mcm_polished.get_best_log_evidence() >= mcm_greedy.get_best_log_evidence() - 1e-6
+    assert np.isclose(mcm_polished.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm_polished))
+
+    # All variables fit in a single union
+    mcm_exhaustive = mcm_searcher.exhaustive(scotus_data_q2)
+    mcm_polished = mcm_searcher.polish(scotus_data_q2, mcm_greedy)
+    assert np.isclose(mcm_polished.get_best_log_evidence(), mcm_exhaustive.get_best_log_evidence())
+
+    with pytest.raises(ValueError):
+        mcm_searcher.polish_size = 21
+
+def test_parallel_tempering(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.PT_n_replicas == 8
+    mcm_searcher.PT_n_replicas = 3
+    mcm_searcher.PT_temperature_min = 2
+    mcm_searcher.PT_temperature_max = 50
+    assert np.allclose(mcm_searcher.PT_temperatures, [2, 10, 50])
+
+    mcm_searcher.SA_max_iteration = 2000
+    mcm_searcher.n_threads = 2
+    mcm = mcm_searcher.parallel_tempering(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+    acceptance = mcm_searcher.PT_swap_acceptance
+    assert len(acceptance) == 2
+    assert all(0 <= rate <= 1 for rate in acceptance)
+
+    with pytest.raises(ValueError):
+        mcm_searcher.PT_n_replicas = 1
+
+def test_multistart(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.multistart_restarts == 16
+    assert mcm_searcher.multistart_patience == 0
+    mcm_searcher.multistart_restarts = 8
+    mcm_searcher.n_threads = 2
+    mcm = mcm_searcher.multistart(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+    log_evidences = mcm_searcher.multistart_log_evidences
+    assert len(log_evidences) == 8
+    assert np.isclose(max(log_evidences), mcm.get_best_log_evidence())
+
+    with pytest.raises(ValueError):
+        mcm_searcher.multistart(scotus_data_q2, "exhaustive")
+    with pytest.raises(ValueError):
+        mcm_searcher.multistart_restarts = 0
+
+def test_seed(mcm_searcher, scotus_data_q2):
+    mcm_searcher.seed = 3
+    assert mcm_searcher.seed == 3
+    mcm_searcher.SA_max_iteration = 2000
+    mcm = mcm_searcher.simulated_annealing(scotus_data_q2)
+    trajectory = mcm_searcher.log_evidence_trajectory
+
+    mcm_searcher.seed = 3
+    assert np.array_equal(mcm_searcher.simulated_annealing(scotus_data_q2).array, mcm.array)
+    assert np.array_equal(mcm_searcher.log_evidence_trajectory, trajectory)
+
+def test_SA_batch(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.SA_batch_size == 1
+    with pytest.raises(ValueError):
+        mcm_searcher.SA_batch_size = 0
+
+    mcm_searcher.SA_batch_size = 8
+    mcm_searcher.SA_max_iteration = 2000
+    mcm_searcher.seed = 5
+    mcm = mcm_searcher.simulated_annealing(scotus_data_q2)
+
+    mcm_searcher.n_threads = 3
+    mcm_searcher.seed = 5
+    assert np.array_equal(mcm_searcher.simulated_annealing(scotus_data_q2).array, mcm.array)
+
+def test_SA_schedule(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.SA_schedule == "logarithmic"
+    with pytest.raises(ValueError):
+        mcm_searcher.SA_schedule = "exponential"
+    with pytest.raises(ValueError):
+        mcm_searcher.SA_cooling_rate = 1.5
+    with pytest.raises(ValueError):
+        mcm_searcher.SA_reheats = -1
+
+    mcm_searcher.SA_temperature_initial = 2.5
+    assert mcm_searcher.SA_temperature_initial == 2.5
+    mcm_searcher.SA_max_iteration = 2000
+    mcm_searcher.SA_max_no_improve = 500
+    mcm_searcher.SA_reheats = 1
+    for schedule in ["geometric", "linear", "adaptive"]:
+        mcm_searcher.SA_schedule = schedule
+        mcm = mcm_searcher.simulated_annealing(scotus_data_q2)
+        assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+
+def test_auto_annealing(mcm_searcher, scotus_data_q2):
+    with pytest.raises(RuntimeError):
+        mcm_searcher.SA_tuning
+
+    mcm_searcher.seed = 4
+    mcm = mcm_searcher.auto_annealing(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), -3300.4)
+
+    tuning = mcm_searcher.SA_tuning
+    assert mcm_searcher.SA_schedule == "logarithmic"
+    assert mcm_searcher.SA_max_iteration == 50000
+    assert tuning["max_iteration"] <= 50000
+    assert len(tuning["pilot_budgets"]) == len(tuning["pilot_log_evidences"])
+
+def test_posterior_sampling(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.sampling_chains == 4
+    with pytest.raises(RuntimeError):
+        mcm_searcher.sampling_comembership
+    with pytest.raises(ValueError):
+        mcm_searcher.sampling_iteration = 0
+
+    mcm_searcher.seed = 1
+    mcm_searcher.sampling_iteration = 20000
+    mcm_searcher.sampling_burn_in = 1000
+    mcm = mcm_searcher.posterior_sampling(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+
+    comembership = mcm_searcher.sampling_comembership
+    assert comembership.shape == (9, 9)
+    assert np.allclose(comembership, comembership.T)
+    assert np.allclose(np.diag(comembership), 1)
+    assert np.isclose(np.sum(mcm_searcher.sampling_n_components), 1)
+    assert len(mcm_searcher.sampling_acceptance) == 4
+
+def test_stop_condition(mcm_searcher, scotus_data_q2):
+    assert mcm_searcher.time_limit == 0
+    assert mcm_searcher.progress_callback is None
+    with pytest.raises(ValueError):
+        mcm_searcher.time_limit = -1
+    with pytest.raises(ValueError):
+        mcm_searcher.progress_interval = 0
+
+    mcm = mcm_searcher.hierarchical_greedy_merging(scotus_data_q2)
+    assert not mcm.is_truncated
+
+    # Annealing that doesn't converge
+    mcm_searcher.SA_max_iteration = 2000000000
+    mcm_searcher.SA_max_no_improve = 2000000000
+    mcm_searcher.time_limit = 0.2
+    start = time.time()
+    mcm = mcm_searcher.simulated_annealing(scotus_data_q2)
+    assert time.time() - start < 5
+    assert mcm.is_truncated
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
+
+    # Cancellation from another thread (the search releases the GIL)
+    mcm_searcher.time_limit = 0
+    timer = threading.Timer(0.2, mcm_searcher.cancel)
+    timer.start()
+    mcm = mcm_searcher.simulated_annealing(scotus_data_q2)
+    timer.join()
+    assert mcm.is_truncated
+
+    # The search stops when the callback returns False
+    calls = []
+    def callback(elapsed, log_evidence):
+        calls.append(elapsed)
+        return len(calls) < 3
+    mcm_searcher.progress_callback = callback
+    mcm_searcher.progress_interval = 0.05
+    mcm = mcm_searcher.simulated_annealing(scotus_data_q2)
+    assert mcm.is_truncated
+    assert len(calls) == 3
+
+    # An exception of the callback is raised after the search
+    def failing_callback(elapsed, log_evidence):
+        raise KeyError("stop")
+    mcm_searcher.progress_callback = failing_callback
+    with pytest.raises(KeyError):
+        mcm_searcher.simulated_annealing(scotus_data_q2)
+    assert mcm_searcher.get_mcm_out().is_truncated
+
+def test_portfolio(mcm_searcher, scotus_data_q2):
+    with pytest.raises(RuntimeError):
+        mcm_searcher.portfolio_winner
+
+    mcm_searcher.n_threads = 3
+    mcm_searcher.seed = 2
+    mcm = mcm_searcher.portfolio(scotus_data_q2)
+    assert np.isclose(mcm.get_best_log_evidence(), -3300.4)
+    assert not mcm.is_truncated
+    assert mcm_searcher.portfolio_winner in ["greedy", "divide_and_conquer", "annealing"]
+    log_evidences = mcm_searcher.portfolio_log_evidences
+    assert len(log_evidences) == 3
+    assert max(log_evidences) <= mcm.get_best_log_evidence() + 1e-6
+
+    # The time limit is the budget of the portfolio
+    mcm_searcher.SA_max_iteration = 2000000000
+    mcm_searcher.SA_max_no_improve = 2000000000
+    mcm_searcher.time_limit = 0.2
+    mcm = mcm_searcher.portfolio(scotus_data_q2)
+    assert mcm.is_truncated
+    assert np.isclose(mcm.get_best_log_evidence(), scotus_data_q2.log_evidence(mcm))
@@ -168,13 +168,14 @@ void Basis::set_basis_default() {
     }
 }
 
-int Basis::set_basis_random() {
+int Basis::set_basis_random(long long seed) {
+    RandomGenerator generator = seeded_generator(seed);
     int tries = 0;
     while (true) {
         // Generate random n by n matrix with entries between 0 and q-1
         for (int i = 0; i < this->n; ++i){
             for (int j = 0; j < this->n; ++j){
-                this->basis_ops_matrix[i][j] = rand()/(RAND_MAX/this->q);
+                this->basis_ops_matrix[i][j] = generator.uniform_int(this->q);
             }
         }
         ++tries;
@@ -16,15 +16,17 @@ double Data::calc_log_ev_icc(__uint128_t component){
     }
 
     // Calculate prefactor
+    log_evidence += this->calc_log_ev_prefactor(r);
+    
+    return log_evidence;
+}
+
+double Data::calc_log_ev_prefactor(int r){
     if (r > 25){
         // Approximate for large components because lgamma overflows
-        log_evidence -= (r * log(this->q) * this->N_synthetic);
+        return -(r * log(this->q) * this->N_synthetic);
     }
-    else{
-        log_evidence += lgamma(this->pow_q[r]/2.) - lgamma(this->N_synthetic + pow_q[r]/2.);
-    }
-    
-    return log_evidence;
+    return lgamma(this->pow_q[r]/2.) - lgamma(this->N_synthetic + pow_q[r]/2.);
 }
 
 double Data::calc_log_ev(std::vector<__uint128_t>& partition){
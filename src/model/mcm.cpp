@@ -16,6 +16,7 @@ MCM::MCM(int n) {
     this->rank = n;
     // Initially no search is run
     this->optimized = false;
+    this->truncated = false;
     this->log_ev = -DBL_MAX;
 }
 
@@ -58,10 +59,11 @@ MCM::MCM(int n, std::vector<__uint128_t> partition){
     }
     // Initially no search is run
     this->optimized = false;
+    this->truncated = false;
     this->log_ev = -DBL_MAX;
 }
 
-MCM::MCM(int n, std::string partition){
+MCM::MCM(int n, std::string partition, long long seed){
     // Check if the given number of variables is valid
     if (n < 1){
         throw std::invalid_argument("The number of variables should be a non-zero positive number.");
@@ -81,7 +83,8 @@ MCM::MCM(int n, std::string partition){
         this->n_comp = 1;
     }
     else if (partition == "random"){
-        this->partition = generate_random_partition(n);
+        RandomGenerator generator = seeded_generator(seed);
+        this->partition = generate_random_partition(n, generator);
         // Count the number of non-empty components
         this->n_comp = 0;
         for(int i = 0; i < n; i++){
@@ -94,6 +97,7 @@ MCM::MCM(int n, std::string partition){
     }
     // Initially no search is run
     this->optimized = false;
+    this->truncated = false;
     this->log_ev = -DBL_MAX;
 }
 
@@ -172,7 +176,7 @@ void MCM::print_info(){
     }
 }
 
-void MCM::generate_data_file(int N, const Data& data, const std::string& file_name){
+void MCM::generate_data_file(int N, const Data& data, const std::string& file_name, long long seed){
     // Check the number of variables
     if (this->n != data.n) {
         throw std::invalid_argument("Number of variables in the MCM doesn't match the number of variables in the given dataset.");
@@ -184,12 +188,8 @@ void MCM::generate_data_file(int N, const Data& data, const std::string& file_na
         std::cerr << "Error: Could not open the output file." << std::endl;
     }
 
-    // Create a random device and use it to generate a random seed
-    std::random_device myRandomDevice;
-    unsigned seed = myRandomDevice();
-
-    // Initialize a default_random_engine with the seed
-    std::default_random_engine generator(seed);
+    // Generator for the given seed
+    RandomGenerator generator = seeded_generator(seed);
 
     // Build a distribution of the states in the dataset
     std::vector<int> weights(data.N_unique);
@@ -223,18 +223,14 @@ void MCM::generate_data_file(int N, const Data& data, const std::string& file_na
     output_file.close();
 }
 
-Data MCM::generate_data_object(int N, const Data& data){
+Data MCM::generate_data_object(int N, const Data& data, long long seed){
     // Check the number of variables
     if (this->n != data.n) {
         throw std::invalid_argument("Number of variables in the MCM doesn't match the number of variables in the given dataset.");
     }
 
-    // Create a random device and use it to generate a random seed
-    std::random_device myRandomDevice;
-    unsigned seed = myRandomDevice();
-
-    // Initialize a default_random_engine with the seed
-    std::default_random_engine generator(seed);
+    // Generator for the given seed
+    RandomGenerator generator = seeded_generator(seed);
 
     // Build a distribution of the states in the dataset
     std::vector<int> weights(data.N_unique);
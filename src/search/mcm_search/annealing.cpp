@@ -2,6 +2,7 @@
 #include "search/mcm_search/annealing.h"
 
 MCM MCMSearch::simulated_annealing(Data& data, MCM* init_mcm, std::string file_name){
+    StopScope scope(this->stop_condition);
     int n = data.n;
     this->data = &data;
     // Initialize an mcm to store the result
@@ -19,8 +20,10 @@ MCM MCMSearch::simulated_annealing(Data& data, MCM* init_mcm, std::string file_n
         this->mcm_out = *init_mcm;
     }
     // Clear from previous search
-    this->log_evidence_trajectory.clear();
+    this->trajectory.start();
+    this->top_mcms.clear();
     this->exhaustive = false;
+    this->build_interaction_graph();
 
     // Create mcm object to store intermediate results
     MCM mcm_tmp = this->mcm_out;
@@ -33,7 +36,7 @@ MCM MCMSearch::simulated_annealing(Data& data, MCM* init_mcm, std::string file_n
     mcm_tmp.log_ev = this->get_log_ev(mcm_tmp.partition);
 
     // Store log_ev of starting point
-    this->log_evidence_trajectory.push_back(mcm_tmp.log_ev);
+    this->trajectory.record(mcm_tmp.log_ev);
 
     // Write the initial partition to the output file
     if (!file_name.empty()){
@@ -69,39 +72,109 @@ MCM MCMSearch::simulated_annealing(Data& data, MCM* init_mcm, std::string file_n
 
     // Initialize a struct containing the SA settings
     SA_settings settings(this->SA_T0, this->mcm_out.partition);
+    settings.max_no_improve = this->SA_max_no_improve;
+    settings.generator = this->next_stream();
 
-    int x;
-    int accepted;
-    double log_ev;
-    int steps_since_improve = 0;
+    this->last_checkpoint = std::chrono::steady_clock::now();
+    return this->run_annealing(mcm_tmp, settings, file_name);
+}
 
-    int counter = 0;
-    std::vector<double> acceptance_rate;
-    for (int i = 0; i < this->SA_max_iter; i++){
-        if (mcm_tmp.n_comp == data.n){
-            x = 0;
-        }
-        else if (mcm_tmp.n_comp == 1){
-            x = 1;
+MCM MCMSearch::run_annealing(MCM& mcm_tmp, SA_settings& settings, std::string file_name){
+    Data& data = *this->data;
+
+    this->annealing(mcm_tmp, settings, true);
+
+    // Hierarchical merging procedure
+    this->dendrogram.start(this->mcm_out);
+    this->hierarchical_merging();
+
+    place_empty_entries_last(this->mcm_out.partition);
+    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Write results to the output file
+    if (!file_name.empty()){
+        double max_log_likelihood = data.calc_log_likelihood(this->mcm_out.partition);
+
+        *this->output_file << "\nFinal partition \n";
+        *this->output_file << "----------------- \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n";
+        *this->output_file << "Max-Log-likelihood: " << max_log_likelihood << " = " << max_log_likelihood / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+        this->output_file.reset();
+    }
+    
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+    if (this->checkpoint_writer){
+        this->checkpoint_writer->wait();
+    }
+
+    return this->mcm_out;
+}
+
+void MCMSearch::annealing(MCM& mcm_tmp, SA_settings& settings, bool checkpoints){
+    int accepted;
+    // Proposals of the batch that have not been applied yet
+    std::vector<SA_move> batch;
+    size_t next = 0;
+    // The threads that evaluate the batches are started once for the whole annealing
+    std::unique_ptr<ThreadPool> pool;
+    if (this->SA_batch_size > 1 && this->n_threads > 1){
+        pool = std::unique_ptr<ThreadPool>(new ThreadPool(this->n_threads));
+    }
+    for (int& i = settings.iteration; i < this->SA_max_iter; i++){
+        // Store the state at the start of iteration i (between two batches)
+        if (checkpoints && next == batch.size() && this->checkpoint_due()){
+            this->write_checkpoint(CheckpointMethod::simulated_annealing, [&](std::ostream& stream){
+                write_binary(stream, mcm_tmp);
+                write_binary(stream, settings);
+            });
         }
-        else{
-            x = rand()/(RAND_MAX/3);
+        // The time limit and the cancellation are checked every 64 iterations
+        if ((i & 63) == 0 && this->stop_condition.requested(this->mcm_out.log_ev)){
+            // A search that stops before its first iteration returns the starting partition
+            if (mcm_tmp.log_ev > this->mcm_out.log_ev){
+                this->mcm_out.log_ev = mcm_tmp.log_ev;
+                this->mcm_out.log_ev_per_icc = mcm_tmp.log_ev_per_icc;
+                this->mcm_out.partition = mcm_tmp.partition;
+                this->mcm_out.n_comp = mcm_tmp.n_comp;
+            }
+            if (this->output_file){
+                *this->output_file << "\nSearch stopped at iteration " << i << " (time limit or cancellation) \n\n";
+            }
+            break;
         }
 
-        if (x == 0){
-            accepted = this->merge_partition(mcm_tmp, settings);
-        }
-        else if (x == 1){
-            accepted = this->split_partition(mcm_tmp, settings);
+        if (this->SA_batch_size == 1){
+            accepted = this->annealing_step(mcm_tmp, settings);
         }
-        else{
-            accepted = this->switch_partition(mcm_tmp, settings);
+        else {
+            if (next == batch.size()){
+                this->propose_batch(mcm_tmp, settings, batch, pool.get());
+                next = 0;
+            }
+            const SA_move& move = batch[next++];
+            accepted = (move.type < 0) ? 0 : this->apply_move(mcm_tmp, settings, move);
+            // The remaining proposals were drawn from the previous partition and are proposed again
+            if (accepted){
+                batch.clear();
+                next = 0;
+            }
         }
-        counter += accepted;
+        settings.n_accepted += accepted;
+        settings.window_accepted += accepted;
 
         // Update the temperature
-        if (i % this->SA_update_schedule == 0){
-            settings.temp = this->SA_T0 / (1 + log(1 + i));
+        if ((i - settings.start_iteration) % this->SA_update_schedule == 0){
+            settings.temp = this->schedule_temperature(settings, i);
+            settings.window_accepted = 0;
         }
 
         // Update solution if log evidence improved
@@ -111,28 +184,40 @@ MCM MCMSearch::simulated_annealing(Data& data, MCM* init_mcm, std::string file_n
             this->mcm_out.log_ev_per_icc = mcm_tmp.log_ev_per_icc;
             this->mcm_out.partition = mcm_tmp.partition;
             this->mcm_out.n_comp = mcm_tmp.n_comp;
-            steps_since_improve = 0;
+            settings.steps_since_improve = 0;
+            settings.best_temp = settings.temp;
 
             // Write to output file
             if (this->output_file){
                 *this->output_file << "Iteration " << i << " \t\t Temperature: " << settings.temp << " \t\t Log-evidence (q-its/datapoint): " << this->mcm_out.log_ev / (this->data->N_synthetic * log(this->data->q)) << "\n";
             }
         }
-        else{steps_since_improve++;}
-        this->log_evidence_trajectory.push_back(this->mcm_out.log_ev);
-
-        // Check stopping criteria
-        if (steps_since_improve > settings.max_no_improve){
-            if (this->output_file){
-                *this->output_file << "\nMaximum number of iterations without improvement reached \n\n";
+        else{settings.steps_since_improve++;}
+        this->trajectory.record(this->mcm_out.log_ev);
+
+        // Check stopping criteria, the schedule restarts from a higher temperature if reheats are left
+        if (settings.steps_since_improve > settings.max_no_improve){
+            if (settings.n_reheats < this->SA_reheats){
+                settings.n_reheats++;
+                settings.start_temp = std::min(2 * settings.best_temp, this->SA_T0);
+                settings.start_iteration = i + 1;
+                settings.steps_since_improve = 0;
+                if (this->output_file){
+                    *this->output_file << "Iteration " << i << " \t\t Reheat to temperature: " << settings.start_temp << "\n";
+                }
+            }
+            else {
+                if (this->output_file){
+                    *this->output_file << "\nMaximum number of iterations without improvement reached \n\n";
+                }
+                break;
             }
-            break;
         }
         
         // Keep track of how the acceptance rate decreases
         if (((i+1) % 1000) == 0){
-            acceptance_rate.push_back(counter / 1000.);
-            counter = 0;
+            settings.acceptance_rate.push_back(settings.n_accepted / 1000.);
+            settings.n_accepted = 0;
         }
     }
 
@@ -140,180 +225,370 @@ MCM MCMSearch::simulated_annealing(Data& data, MCM* init_mcm, std::string file_n
         *this->output_file << "Acceptance rate over the last 1000 iterations\n";
         *this->output_file << "---------------------------------------------\n\n";
 
-        for (int i = 0; i < acceptance_rate.size(); ++i){
-            *this->output_file << "iteration " << (i+1)*1000 << "\t" << acceptance_rate[i] << "\n";
+        for (int i = 0; i < settings.acceptance_rate.size(); ++i){
+            *this->output_file << "iteration " << (i+1)*1000 << "\t" << settings.acceptance_rate[i] << "\n";
         }
         *this->output_file << "\n";
-    }
 
+        *this->output_file << "Start merging \n";
+        *this->output_file << "------------- \n\n";
+    }
+}
 
-    // Hierarchical merging procedure
-    this->hierarchical_merging();
+double MCMSearch::schedule_temperature(const SA_settings& settings, int i){
+    int t = i - settings.start_iteration;
+    if (t == 0){
+        return settings.start_temp;
+    }
+    double rate = this->SA_cooling_rate;
+    double temp = settings.temp;
+    switch (this->SA_schedule){
+        case CoolingSchedule::logarithmic:
+            return settings.start_temp / (1 + log(1 + t));
+        case CoolingSchedule::geometric:
+            temp = settings.start_temp * pow(rate, t / this->SA_update_schedule);
+            break;
+        case CoolingSchedule::linear:
+            temp = settings.start_temp + (this->SA_min_temp - settings.start_temp) * t / std::max(1, this->SA_max_iter - 1 - settings.start_iteration);
+            break;
+        case CoolingSchedule::adaptive: {
+            // Acceptance rate since the last update compared to a target that decreases linearly to zero
+            double acceptance = (double) settings.window_accepted / this->SA_update_schedule;
+            double target = this->SA_target_acceptance * (1 - (double) t / std::max(1, this->SA_max_iter - settings.start_iteration));
+            temp = (acceptance > target) ? settings.temp * rate : settings.temp / rate;
+            temp = std::min(temp, settings.start_temp);
+            break;
+        }
+        default:
+            throw std::invalid_argument("Invalid cooling schedule.");
+    }
+    return std::max(temp, this->SA_min_temp);
+}
 
-    place_empty_entries_last(this->mcm_out.partition);
-    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
-    // Indicate that the search has been done
-    this->mcm_out.optimized = true;
+int MCMSearch::annealing_step(MCM& mcm, SA_settings& settings){
+    SA_move move;
+    if (! this->propose_move(mcm, settings, move)){return 0;}
+    return this->apply_move(mcm, settings, move);
+}
 
-    // Write results to the output file
-    if (!file_name.empty()){
-        double max_log_likelihood = data.calc_log_likelihood(this->mcm_out.partition);
+bool MCMSearch::propose_move(MCM& mcm, SA_settings& settings, SA_move& move){
+    int x;
+    if (mcm.n_comp == this->data->n){
+        x = 0;
+    }
+    else if (mcm.n_comp == 1){
+        x = 1;
+    }
+    else{
+        x = settings.generator.uniform_int(3);
+    }
 
-        *this->output_file << "\nFinal partition \n";
-        *this->output_file << "----------------- \n\n";
+    if (x == 0){
+        return this->propose_merge(mcm, settings, move);
+    }
+    else if (x == 1){
+        return this->propose_split(mcm, settings, move);
+    }
+    else{
+        return this->propose_switch(mcm, settings, move);
+    }
+}
 
-        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n";
-        *this->output_file << "Max-Log-likelihood: " << max_log_likelihood << " = " << max_log_likelihood / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+bool MCMSearch::propose_merge(MCM& mcm, SA_settings& settings, SA_move& move){
+    ComponentIndex& index = settings.index;
+    if (index.n_occupied() <= 1){return false;}
 
-        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
-        *this->output_file << "\n";
-        this->output_file.reset();
+    // Choose two random components
+    int comp_1 = index.random_occupied(settings.generator);
+    int comp_2;
+    if (this->interaction_graph.empty()){
+        comp_2 = index.random_other_occupied(comp_1, settings.generator);
+    }
+    else {
+        // The second component should contain a neighbour of the first one
+        __uint128_t candidates = index.components_of(this->neighbourhood(mcm.partition[comp_1])) & ~((__uint128_t) 1 << comp_1);
+        if (candidates == 0){return false;}
+        comp_2 = randomBitIndex(candidates, settings.generator);
     }
-    
-    // Clear the storage of log-evidences
-    this->evidence_storage.clear();
 
-    return this->mcm_out;
+    move.type = 0;
+    move.comp_1 = comp_1;
+    move.comp_2 = comp_2;
+    move.new_comp_1 = mcm.partition[comp_1] + mcm.partition[comp_2];
+    move.new_comp_2 = 0;
+    return true;
+}
+
+bool MCMSearch::propose_split(MCM& mcm, SA_settings& settings, SA_move& move){
+    ComponentIndex& index = settings.index;
+    if (index.n_splittable() == 0){return false;}
+
+    // Choose random component containing at least two variables and a random split of it
+    int comp_index = index.random_splittable(settings.generator);
+    __uint128_t comp_2 = index.random_split(comp_index, settings.generator);
+
+    // The second part goes to an empty component
+    move.type = 1;
+    move.comp_1 = comp_index;
+    move.comp_2 = index.empty_component();
+    move.new_comp_1 = mcm.partition[comp_index] - comp_2;
+    move.new_comp_2 = comp_2;
+    return true;
 }
 
-int MCMSearch::merge_partition(MCM& mcm, SA_settings& settings){
-    if (mcm.n_comp <= 1){return 0;}
+bool MCMSearch::propose_switch(MCM& mcm, SA_settings& settings, SA_move& move){
+    ComponentIndex& index = settings.index;
+    if (index.n_occupied() <= 1 || index.n_splittable() == 0){return false;}
 
     __uint128_t ONE = 1;
 
-    // Choose two random components
-    int comp_1 = randomBitIndex(settings.occupied_comp);
-    int comp_2 = randomBitIndex(settings.occupied_comp - (ONE << comp_1));
+    // Select a random unit of a component with at least two units and a second component
+    int comp_1_index = index.random_splittable(settings.generator);
+    int unit = index.random_unit(comp_1_index, settings.generator);
+    __uint128_t variables = index.unit(unit);
+    int comp_2_index;
+    if (this->interaction_graph.empty()){
+        comp_2_index = index.random_other_occupied(comp_1_index, settings.generator);
+    }
+    else {
+        // The second component should contain one of the neighbours of the unit (if every unit is a single variable, the unit is the variable)
+        __uint128_t neighbours = (index.n_units() == this->data->n) ? this->interaction_graph[unit] : this->neighbourhood(variables);
+        __uint128_t candidates = index.components_of(neighbours) & ~(ONE << comp_1_index);
+        if (candidates == 0){return false;}
+        comp_2_index = randomBitIndex(candidates, settings.generator);
+    }
 
-    // Calculate the change in evidence when merging
-    __uint128_t merged_comp = mcm.partition[comp_1] + mcm.partition[comp_2];
-    double merged_log_ev = this->get_log_ev_icc(merged_comp);
-    double diff_log_ev = merged_log_ev - mcm.log_ev_per_icc[comp_1] - mcm.log_ev_per_icc[comp_2];
+    // Move the unit from component 1 to component 2
+    move.type = 2;
+    move.unit = unit;
+    move.comp_1 = comp_1_index;
+    move.comp_2 = comp_2_index;
+    move.new_comp_1 = mcm.partition[comp_1_index] - variables;
+    move.new_comp_2 = mcm.partition[comp_2_index] + variables;
+    return true;
+}
 
-    // Check if new partition is accepted using metropolis acceptance probability
-    double p = exp(diff_log_ev / settings.temp);
-    double u = ((double) rand() / (RAND_MAX));
+int MCMSearch::apply_move(MCM& mcm, SA_settings& settings, const SA_move& move, double log_proposal_ratio){
+    // Calculate the change in evidence (an empty component has zero log-evidence)
+    double log_ev_1 = this->get_log_ev_icc(move.new_comp_1);
+    double log_ev_2 = move.new_comp_2 ? this->get_log_ev_icc(move.new_comp_2) : 0;
+    double diff_log_ev = log_ev_1 + log_ev_2 - mcm.log_ev_per_icc[move.comp_1] - mcm.log_ev_per_icc[move.comp_2];
+
+    // Check if new partition is accepted using metropolis acceptance probability (metropolis-hastings when sampling)
+    double p = exp(diff_log_ev / settings.temp + log_proposal_ratio);
+    double u = settings.generator.uniform_real();
 
     if (p > u){
         // Accept the new partition
-        mcm.partition[comp_1] = merged_comp;
-        mcm.partition[comp_2] = 0;
-        mcm.log_ev_per_icc[comp_1] = merged_log_ev;
-        mcm.log_ev_per_icc[comp_2] = 0;
+        mcm.partition[move.comp_1] = move.new_comp_1;
+        mcm.partition[move.comp_2] = move.new_comp_2;
+        mcm.log_ev_per_icc[move.comp_1] = log_ev_1;
+        mcm.log_ev_per_icc[move.comp_2] = log_ev_2;
         mcm.log_ev += diff_log_ev;
-        
-        settings.occupied_comp -= (ONE << comp_2);
-        if ((settings.occupied_comp2 & (ONE << comp_1)) == 0){
-            settings.occupied_comp2 += (ONE << comp_1);
+
+        if (move.type == 0){
+            mcm.n_comp--;
+            settings.index.merge(move.comp_1, move.comp_2);
         }
-        if ((settings.occupied_comp2 & (ONE << comp_2)) == (ONE << comp_2)){
-            settings.occupied_comp2 -= (ONE << comp_2);
+        else if (move.type == 1){
+            mcm.n_comp++;
+            settings.index.split(move.comp_1, move.comp_2, move.new_comp_2);
+        }
+        else {
+            settings.index.move(move.unit, move.comp_2);
         }
-        mcm.n_comp--;
-
         return 1;
     }
     return 0;
 }
 
-int MCMSearch::split_partition(MCM& mcm, SA_settings& settings){
-    if (mcm.n_comp == this->data->n){return 0;}
-    if (settings.occupied_comp2 == 0){return 0;}
-
-    __uint128_t ONE = 1;
-
-    // Choose random component containing at least two variables
-    int comp_index = randomBitIndex(settings.occupied_comp2);
-    __uint128_t comp = mcm.partition[comp_index];
+void MCMSearch::propose_batch(MCM& mcm, SA_settings& settings, std::vector<SA_move>& batch, ThreadPool* pool){
+    // All proposals are drawn from the current partition
+    batch.assign(this->SA_batch_size, SA_move());
+    EvidenceCache& storage = this->shared_evidence_storage ? *this->shared_evidence_storage : this->evidence_storage;
+    std::vector<__uint128_t> components;
+    double log_ev;
+    for (SA_move& move : batch){
+        if (! this->propose_move(mcm, settings, move)){
+            move.type = -1;
+            continue;
+        }
+        // Only the components that are not in the cache yet need to be evaluated
+        if (! storage.find(move.new_comp_1, log_ev)){components.push_back(move.new_comp_1);}
+        if (move.new_comp_2 && ! storage.find(move.new_comp_2, log_ev)){components.push_back(move.new_comp_2);}
+    }
+    if (components.size() <= 1 || ! pool){
+        for (__uint128_t component : components){
+            this->get_log_ev_icc(component);
+        }
+        return;
+    }
 
-    // Make a random split of the component
-    __uint128_t mask = random_128_int(this->data->n);
-    __uint128_t comp_1 = (comp & mask);
-    __uint128_t comp_2 = (comp & (~mask));
+    // Evaluate the new components in parallel, the moves then find their evidence in the cache
+    pool->run(components.size(), [&](int i, int thread){
+        this->get_log_ev_icc(components[i]);
+    });
+}
 
-    // Both component should at least contain 1 variable
-    while ((bit_count(comp_1) == 0) || (bit_count(comp_2) == 0)){
-        mask = random_128_int(this->data->n);
-        comp_1 = (comp & mask);
-        comp_2 = (comp & (~mask));
-    }
+/*****************
+* ComponentIndex *
+******************/
 
-    // Calculate the change in evidence when splitting
-    double log_ev_1 = this->get_log_ev_icc(comp_1);
-    double log_ev_2 = this->get_log_ev_icc(comp_2);
-    double diff_log_ev = log_ev_1 + log_ev_2 - mcm.log_ev_per_icc[comp_index];
+void ComponentIndex::IndexableSet::insert(int x){
+    if (this->position[x] >= 0){return;}
+    this->position[x] = this->size;
+    this->elements[this->size++] = x;
+}
 
-    // Check if new partition is accepted using metropolis acceptance probability
-    double p = exp(diff_log_ev / settings.temp);
-    double u = ((double) rand() / (RAND_MAX));
+void ComponentIndex::IndexableSet::erase(int x){
+    int pos = this->position[x];
+    if (pos < 0){return;}
+    // The last element takes the place of the removed one
+    int last = this->elements[--this->size];
+    this->elements[pos] = last;
+    this->position[last] = pos;
+    this->position[x] = -1;
+}
 
-    if (p > u){
-        // Accept the new partition
-        mcm.partition[comp_index] = comp_1;
-        mcm.log_ev_per_icc[comp_index] = log_ev_1;
-        // Find the first empty component
-        int comp_2_index = 0;
-        while (mcm.partition[comp_2_index]){comp_2_index++;}
-        mcm.partition[comp_2_index] = comp_2;
-        mcm.log_ev_per_icc[comp_2_index] = log_ev_2;
-        mcm.log_ev += diff_log_ev;
+void ComponentIndex::build(const std::vector<__uint128_t>& partition){
+    int n = partition.size();
+    std::vector<__uint128_t> units(n);
+    for (int v = 0; v < n; v++){
+        units[v] = (__uint128_t) 1 << v;
+    }
+    this->build(partition, units);
+}
 
-        settings.occupied_comp += (ONE << comp_2_index);
-        if (bit_count(comp_1) <= 1){
-            settings.occupied_comp2 -= (ONE << comp_index);
+void ComponentIndex::build(const std::vector<__uint128_t>& partition, const std::vector<__uint128_t>& units){
+    int n = partition.size();
+    int m = units.size();
+    this->n = n;
+    this->occupied.reset(n);
+    this->splittable.reset(n);
+    this->empty.assign(n, 0);
+    this->n_empty = 0;
+    this->units = units;
+    this->var_unit.assign(n, -1);
+    for (int u = 0; u < m; u++){
+        for (int v = 0; v < n; v++){
+            if ((units[u] >> v) & 1){this->var_unit[v] = u;}
         }
-        if (bit_count(comp_2) > 1){
-            settings.occupied_comp2 += (ONE << comp_2_index);
+    }
+    this->members.assign(n * m, 0);
+    this->member_pos.assign(m, 0);
+    this->comp_size.assign(n, 0);
+    this->unit_comp.assign(m, -1);
+    this->mask = 0;
+
+    for (int i = 0; i < n; i++){
+        for (int u = 0; u < m; u++){
+            if (partition[i] & units[u]){this->add_unit(u, i);}
         }
-        mcm.n_comp++;
-
-        return 1;
     }
-    return 0;
+    // Empty components in decreasing order, such that the first empty component is used first
+    for (int i = n - 1; i >= 0; i--){
+        if (this->comp_size[i] == 0){this->empty[this->n_empty++] = i;}
+    }
 }
 
-int MCMSearch::switch_partition(MCM& mcm, SA_settings& settings){
-    if (mcm.n_comp == 1 || mcm.n_comp == this->data->n){return 0;}
-    if (settings.occupied_comp2 == 0){return 0;}
-
-    __uint128_t ONE = 1;
+int ComponentIndex::random_other_occupied(int comp, RandomGenerator& generator) const {
+    // Uniform over the first size-1 elements, where the given component is replaced by the last element
+    int x = this->occupied.elements[generator.uniform_int(this->occupied.size - 1)];
+    if (x == comp){x = this->occupied.elements[this->occupied.size - 1];}
+    return x;
+}
 
-    // Select two random partitions, the first with at least two variables
-    int comp_1_index = randomBitIndex(settings.occupied_comp2);
-    int comp_2_index = randomBitIndex(settings.occupied_comp - (ONE << comp_1_index));
-    __uint128_t comp_1 = mcm.partition[comp_1_index];
-    __uint128_t comp_2 = mcm.partition[comp_2_index];
+__uint128_t ComponentIndex::random_split(int comp, RandomGenerator& generator) const {
+    int r = this->comp_size[comp];
+    const int* members = &this->members[comp * this->n];
+    __uint128_t subset = 0;
+    if (r < 64){
+        // Uniform integer between 1 and 2^r - 2, its bits select the units of the subset
+        uint64_t range = ((uint64_t) 1 << r) - 2;
+        uint64_t bits = 1 + (uint64_t) (((__uint128_t) generator() * range) >> 64);
+        while (bits){
+            subset += this->units[members[__builtin_ctzll(bits)]];
+            bits &= bits - 1;
+        }
+    }
+    else {
+        // A random subset of the units is trivial with a probability of at most 2^-63
+        __uint128_t comp_mask = 0;
+        for (int k = 0; k < r; k++){comp_mask += (__uint128_t) 1 << members[k];}
+        __uint128_t selected;
+        do {
+            selected = random_128_int(this->units.size(), generator) & comp_mask;
+        } while (selected == 0 || selected == comp_mask);
+        for (int k = 0; k < r; k++){
+            if ((selected >> members[k]) & 1){subset += this->units[members[k]];}
+        }
+    }
+    return subset;
+}
 
-    // Select random variable from first component
-    int var = randomBitIndex(comp_1);
-    // Move the variable from component 1 to component 2
-    __uint128_t new_comp_1 = comp_1 - (ONE << var);
-    __uint128_t new_comp_2 = comp_2 + (ONE << var);
+__uint128_t ComponentIndex::components_of(__uint128_t variables) const {
+    __uint128_t result = 0;
+    uint64_t half[2] = {(uint64_t) variables, (uint64_t) (variables >> 64)};
+    for (int h = 0; h < 2; h++){
+        while (half[h]){
+            result |= (__uint128_t) 1 << this->unit_comp[this->var_unit[64 * h + __builtin_ctzll(half[h])]];
+            half[h] &= half[h] - 1;
+        }
+    }
+    return result;
+}
 
-    // Calculate the difference in evidence when moving the variable
-    double log_ev_1 = this->get_log_ev_icc(new_comp_1);
-    double log_ev_2 = this->get_log_ev_icc(new_comp_2);
-    double diff_log_ev = log_ev_1 + log_ev_2 - mcm.log_ev_per_icc[comp_1_index] - mcm.log_ev_per_icc[comp_2_index];
+void ComponentIndex::add_unit(int unit, int comp){
+    if (this->comp_size[comp] == 0){
+        this->occupied.insert(comp);
+        this->mask |= (__uint128_t) 1 << comp;
+    }
+    this->member_pos[unit] = this->comp_size[comp];
+    this->members[comp * this->n + this->comp_size[comp]++] = unit;
+    this->unit_comp[unit] = comp;
+    if (this->comp_size[comp] == 2){this->splittable.insert(comp);}
+}
 
-    // Check if new partition is accepted using metropolis acceptance probability
-    double p = exp(diff_log_ev / settings.temp);
-    double u = ((double) rand() / (RAND_MAX));
+void ComponentIndex::remove_unit(int unit){
+    int comp = this->unit_comp[unit];
+    // The last unit of the component takes the place of the removed one
+    int last = this->members[comp * this->n + --this->comp_size[comp]];
+    this->members[comp * this->n + this->member_pos[unit]] = last;
+    this->member_pos[last] = this->member_pos[unit];
+    this->unit_comp[unit] = -1;
+    if (this->comp_size[comp] == 1){this->splittable.erase(comp);}
+    if (this->comp_size[comp] == 0){
+        this->occupied.erase(comp);
+        this->mask &= ~((__uint128_t) 1 << comp);
+        this->empty[this->n_empty++] = comp;
+    }
+}
 
-    if (p > u){
-        // Accept the new partition
-        mcm.partition[comp_1_index] = new_comp_1;
-        mcm.partition[comp_2_index] = new_comp_2;
-        mcm.log_ev_per_icc[comp_1_index] = log_ev_1;
-        mcm.log_ev_per_icc[comp_2_index] = log_ev_2;
-        mcm.log_ev += diff_log_ev;
+void ComponentIndex::merge(int comp_1, int comp_2){
+    while (this->comp_size[comp_2]){
+        int unit = this->members[comp_2 * this->n];
+        this->move(unit, comp_1);
+    }
+}
 
-        if (bit_count(new_comp_1) == 1){
-            settings.occupied_comp2 -= (ONE << comp_1_index);
-        }
-        if (bit_count(comp_2) == 1){
-            settings.occupied_comp2 += (ONE << comp_2_index);
+void ComponentIndex::split(int comp, int new_comp, __uint128_t moved){
+    // The new component is the one returned by empty_component, which is taken from the free list
+    this->n_empty--;
+    uint64_t half[2] = {(uint64_t) moved, (uint64_t) (moved >> 64)};
+    for (int h = 0; h < 2; h++){
+        while (half[h]){
+            // The other variables of a unit that was already moved are skipped
+            int unit = this->var_unit[64 * h + __builtin_ctzll(half[h])];
+            if (this->unit_comp[unit] == comp){
+                this->remove_unit(unit);
+                this->add_unit(unit, new_comp);
+            }
+            half[h] &= half[h] - 1;
         }
-        return 1;
     }
-    return 0;
-}
\ No newline at end of file
+}
+
+void ComponentIndex::move(int unit, int to){
+    this->remove_unit(unit);
+    this->add_unit(unit, to);
+}
@@ -0,0 +1,133 @@
+#include "search/mcm_search/checkpoint.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <unistd.h>
+
+void CheckpointWriter::write(const std::string& file_name, std::string buffer, std::vector<CheckpointLog> logs){
+    // Only one checkpoint is written at a time
+    this->wait();
+    if (this->failed){return;}
+    this->writer = std::thread([this, file_name](std::string data, std::vector<CheckpointLog> logs){
+        for (const CheckpointLog& log : logs){
+            std::ofstream log_file(log.file_name, log.restart ? std::ios::binary : std::ios::binary | std::ios::app);
+            log_file.write(log.records.data(), log.records.size());
+            log_file.close();
+            if (! log_file){
+                std::cerr << "Error: could not write the log of the checkpoint, no further checkpoints are written." << std::endl;
+                this->failed = true;
+                return;
+            }
+        }
+        std::string tmp_name = file_name + ".tmp";
+        std::ofstream file(tmp_name, std::ios::binary);
+        if (! file.is_open()){
+            std::cerr << "Error: could not open the checkpoint file." << std::endl;
+            return;
+        }
+        file.write(data.data(), data.size());
+        file.close();
+        if (! file){
+            std::cerr << "Error: could not write the checkpoint file." << std::endl;
+            return;
+        }
+        // Replace the previous checkpoint
+        std::rename(tmp_name.c_str(), file_name.c_str());
+    }, std::move(buffer), std::move(logs));
+}
+
+void write_binary(std::ostream& stream, const std::string& string){
+    std::vector<char> chars(string.begin(), string.end());
+    write_binary(stream, chars);
+}
+
+void read_binary(std::istream& stream, std::string& string){
+    std::vector<char> chars;
+    read_binary(stream, chars);
+    string.assign(chars.begin(), chars.end());
+}
+
+std::string cache_log_records(const std::vector<std::pair<__uint128_t, double>>& entries){
+    std::ostringstream records(std::ios::binary);
+    for (const std::pair<__uint128_t, double>& entry : entries){
+        write_binary(records, entry.first);
+        write_binary(records, entry.second);
+    }
+    return records.str();
+}
+
+void read_cache_log(const std::string& log_name, unsigned long long n_entries, EvidenceCache& cache){
+    std::ifstream log_file(log_name, std::ios::binary);
+    if (! log_file.is_open()){
+        throw std::runtime_error("Could not open the log of the evidence cache.");
+    }
+    cache.clear();
+    __uint128_t component;
+    double log_ev;
+    for (unsigned long long i = 0; i < n_entries; i++){
+        log_file.read(reinterpret_cast<char*>(&component), sizeof(__uint128_t));
+        log_file.read(reinterpret_cast<char*>(&log_ev), sizeof(double));
+        if (! log_file){
+            throw std::runtime_error("The log of the evidence cache is incomplete or corrupted.");
+        }
+        cache.insert(component, log_ev);
+    }
+    log_file.close();
+    // Remove what was logged after the checkpoint
+    if (truncate(log_name.c_str(), n_entries * (sizeof(__uint128_t) + sizeof(double))) != 0){
+        throw std::runtime_error("Could not open the log of the evidence cache.");
+    }
+}
+
+void write_binary(std::ostream& stream, const MCM& mcm){
+    write_binary(stream, mcm.n);
+    write_binary(stream, mcm.n_comp);
+    write_binary(stream, mcm.rank);
+    write_binary(stream, mcm.partition);
+    write_binary(stream, mcm.log_ev);
+    write_binary(stream, mcm.log_ev_per_icc);
+    write_binary(stream, mcm.optimized);
+}
+
+void read_binary(std::istream& stream, MCM& mcm){
+    read_binary(stream, mcm.n);
+    read_binary(stream, mcm.n_comp);
+    read_binary(stream, mcm.rank);
+    read_binary(stream, mcm.partition);
+    read_binary(stream, mcm.log_ev);
+    read_binary(stream, mcm.log_ev_per_icc);
+    read_binary(stream, mcm.optimized);
+}
+
+void write_binary(std::ostream& stream, const SA_settings& settings){
+    write_binary(stream, settings.temp);
+    write_binary(stream, settings.start_temp);
+    write_binary(stream, settings.start_iteration);
+    write_binary(stream, settings.best_temp);
+    write_binary(stream, settings.n_reheats);
+    write_binary(stream, settings.window_accepted);
+    write_binary(stream, settings.epsilon);
+    write_binary(stream, settings.max_no_improve);
+    write_binary(stream, settings.iteration);
+    write_binary(stream, settings.steps_since_improve);
+    write_binary(stream, settings.n_accepted);
+    write_binary(stream, settings.acceptance_rate);
+    write_binary(stream, settings.generator);
+}
+
+void read_binary(std::istream& stream, SA_settings& settings){
+    read_binary(stream, settings.temp);
+    read_binary(stream, settings.start_temp);
+    read_binary(stream, settings.start_iteration);
+    read_binary(stream, settings.best_temp);
+    read_binary(stream, settings.n_reheats);
+    read_binary(stream, settings.window_accepted);
+    read_binary(stream, settings.epsilon);
+    read_binary(stream, settings.max_no_improve);
+    read_binary(stream, settings.iteration);
+    read_binary(stream, settings.steps_since_improve);
+    read_binary(stream, settings.n_accepted);
+    read_binary(stream, settings.acceptance_rate);
+    read_binary(stream, settings.generator);
+}
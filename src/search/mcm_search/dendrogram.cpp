@@ -0,0 +1,71 @@
+#include "search/mcm_search/dendrogram.h"
+#include "search/mcm_search/checkpoint.h"
+
+#include <stdexcept>
+
+void Dendrogram::start(const MCM& mcm){
+    this->n = mcm.n;
+    this->base_partition = mcm.partition;
+    this->base_log_ev_per_icc = mcm.log_ev_per_icc;
+    this->base_log_ev = mcm.log_ev;
+    this->steps.clear();
+    this->best_n_merges = 0;
+}
+
+void Dendrogram::add(const DendrogramStep& step, bool improvement){
+    this->steps.push_back(step);
+    // The result of the search contains all merges up to the first one that doesn't increase the evidence
+    if (improvement && this->best_n_merges == (int) this->steps.size() - 1){
+        this->best_n_merges++;
+    }
+}
+
+MCM Dendrogram::cut(int n_merges) const {
+    if (this->n == 0){
+        throw std::runtime_error("No merge tree has been recorded.");
+    }
+    if (n_merges < 0 || n_merges > (int) this->steps.size()){
+        throw std::invalid_argument("The number of merges should be between 0 and the number of merges in the tree.");
+    }
+    MCM mcm(this->n, this->base_partition);
+    // The constructor moves the empty components to the end, restore the indices of the merging procedure
+    mcm.partition = this->base_partition;
+    mcm.log_ev_per_icc = this->base_log_ev_per_icc;
+    mcm.log_ev = this->base_log_ev;
+    for (int k = 0; k < n_merges; k++){
+        const DendrogramStep& step = this->steps[k];
+        mcm.partition[step.i] += mcm.partition[step.j];
+        mcm.partition[step.j] = 0;
+        mcm.log_ev_per_icc[step.i] = step.log_ev_merged;
+        mcm.log_ev_per_icc[step.j] = 0;
+        mcm.log_ev = step.log_ev;
+        mcm.n_comp--;
+    }
+    return mcm;
+}
+
+void Dendrogram::clear(){
+    this->n = 0;
+    this->base_partition.clear();
+    this->base_log_ev_per_icc.clear();
+    this->steps.clear();
+    this->best_n_merges = 0;
+}
+
+void Dendrogram::save(std::ostream& stream) const {
+    write_binary(stream, this->n);
+    write_binary(stream, this->base_partition);
+    write_binary(stream, this->base_log_ev_per_icc);
+    write_binary(stream, this->base_log_ev);
+    write_binary(stream, this->steps);
+    write_binary(stream, this->best_n_merges);
+}
+
+void Dendrogram::load(std::istream& stream){
+    read_binary(stream, this->n);
+    read_binary(stream, this->base_partition);
+    read_binary(stream, this->base_log_ev_per_icc);
+    read_binary(stream, this->base_log_ev);
+    read_binary(stream, this->steps);
+    read_binary(stream, this->best_n_merges);
+}
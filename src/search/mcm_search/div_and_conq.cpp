@@ -2,7 +2,11 @@
 #include "search/mcm_search/div_and_conq.h"
 #include "utilities/miscellaneous.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 MCM MCMSearch::divide_and_conquer(Data& data, MCM* init_mcm, std::string file_name){
+    StopScope scope(this->stop_condition);
     int n = data.n;
     this->data = &data;
     // Initialize an mcm to store the result
@@ -21,8 +25,11 @@ MCM MCMSearch::divide_and_conquer(Data& data, MCM* init_mcm, std::string file_na
     }
 
     // Clear from previous search
-    this->log_evidence_trajectory.clear();
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
     this->exhaustive = false;
+    this->build_interaction_graph();
 
     // Calculate the log ev
     this->mcm_out.log_ev_per_icc.assign(n, 0);
@@ -32,7 +39,7 @@ MCM MCMSearch::divide_and_conquer(Data& data, MCM* init_mcm, std::string file_na
     this->mcm_out.log_ev = this->get_log_ev(this->mcm_out.partition);
 
     // Store log_ev of starting point
-    this->log_evidence_trajectory.push_back(this->mcm_out.log_ev);
+    this->trajectory.record(this->mcm_out.log_ev);
 
     // Write the initial partition to the output file
     if (!file_name.empty()){
@@ -66,13 +73,82 @@ MCM MCMSearch::divide_and_conquer(Data& data, MCM* init_mcm, std::string file_na
         *this->output_file << "-------------- \n\n";
     }
 
-    // Start recursive algorithm by moving variables from component 0 to component 1
-    division(0, 1);
+    // Start the algorithm by moving variables from component 0 to component 1
+    std::vector<int> to_split(1, 0);
+    this->last_checkpoint = std::chrono::steady_clock::now();
+    return this->run_division(to_split, 1, file_name);
+}
+
+MCM MCMSearch::run_division(std::vector<int>& to_split, int first_empty, std::string file_name){
+    Data& data = *this->data;
+
+    // The split of a component only depends on the component itself, so the components on the stack are split in parallel.
+    // The splits are then applied in the order of the stack, which gives the same result as splitting them one by one.
+    std::unordered_map<__uint128_t, std::pair<__uint128_t, __uint128_t>, Hash128> splits;
+    std::vector<__uint128_t> pending;
+
+    // The recursion is unrolled into a stack of components that still have to be split
+    // such that the state of the search can be stored in a checkpoint
+    while (! to_split.empty()){
+        if (this->checkpoint_due()){
+            this->write_checkpoint(CheckpointMethod::divide_and_conquer, [&](std::ostream& stream){
+                write_binary(stream, to_split);
+                write_binary(stream, first_empty);
+            });
+        }
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){
+            if (this->output_file){
+                *this->output_file << "Search stopped (time limit or cancellation) \n\n";
+            }
+            break;
+        }
+        int component = to_split.back();
+        to_split.pop_back();
+
+        __uint128_t members = this->mcm_out.partition[component];
+        __uint128_t other = this->mcm_out.partition[first_empty];
+        std::pair<__uint128_t, __uint128_t> split;
+        if (other){
+            // Variables are moved to a component that is not empty (only when starting from a given partition)
+            split = this->best_split(members, other, this->n_threads);
+        }
+        else {
+            if (! splits.count(members)){
+                // Split all components on the stack that haven't been split yet
+                pending.assign(1, members);
+                for (int index : to_split){
+                    __uint128_t stacked = this->mcm_out.partition[index];
+                    if (! splits.count(stacked) && bit_count(stacked) > 1){pending.push_back(stacked);}
+                }
+                // Threads that are not needed for the components themselves evaluate the moves within a component
+                int n_inner_threads = std::max(1, this->n_threads / (int) pending.size());
+                std::vector<std::pair<__uint128_t, __uint128_t>> results(pending.size());
+                parallel_for(pending.size(), this->n_threads, [&](int task, int thread){
+                    results[task] = this->best_split(pending[task], 0, n_inner_threads);
+                });
+                for (size_t task = 0; task < pending.size(); task++){
+                    splits[pending[task]] = results[task];
+                }
+            }
+            split = splits[members];
+            splits.erase(members);
+        }
+
+        if (this->division(component, first_empty, split)){
+            // Continue with a split of the first subpart, followed by a split of the second subpart
+            to_split.push_back(first_empty);
+            to_split.push_back(component);
+            // Component 'first_empty' is no longer empty
+            first_empty++;
+        }
+    }
 
     place_empty_entries_last(this->mcm_out.partition);
     place_empty_entries_last(this->mcm_out.log_ev_per_icc);
     // Indicate that the search has been done
+    this->trajectory.finish();
     this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
 
     // Write results to the output file
     if (!file_name.empty()){
@@ -94,80 +170,94 @@ MCM MCMSearch::divide_and_conquer(Data& data, MCM* init_mcm, std::string file_na
 
     // Clear the storage of log-evidences
     this->evidence_storage.clear();
+    if (this->checkpoint_writer){
+        this->checkpoint_writer->wait();
+    }
 
     return this->mcm_out;
 }
 
-int MCMSearch::division(int move_from, int move_to){
+std::pair<__uint128_t, __uint128_t> MCMSearch::best_split(__uint128_t component, __uint128_t other, int n_threads){
+    // Best split so far (no split if none of them increases the evidence)
+    std::pair<__uint128_t, __uint128_t> split(component, other);
+
     // Number of member in the component that we want to split
-    int n_members_1 = bit_count(this->mcm_out.partition[move_from]);
+    int n_members_1 = bit_count(component);
     // If the component contains 1 variable, no further splits are possible
-    if (n_members_1 == 1){return move_to;}
-
-    // Hard copy of the starting partition
-    std::vector<__uint128_t> partition = this->mcm_out.partition;
+    if (n_members_1 == 1){return split;}
 
     // Variables for the difference in evidence before and after split
     double best_evidence_diff = 0;
     double best_evidence_diff_tmp;
-    double evidence_diff;
+    std::vector<double> evidence_diff;
 
-    // Variables to represent the unsplit and split components
-    __uint128_t component_1;
-    __uint128_t component_2;
-
-    // Variable to indicate which member is moving
-    __uint128_t member;
+    // Variables to represent the split components
+    __uint128_t component_1 = component;
+    __uint128_t component_2 = other;
 
     // Calculate the evidence of the component before splitting (reference point for the difference in evidence)
-    double evidence_unsplit_component = this->get_log_ev_icc(partition[move_from]);
+    double evidence_unsplit_component = this->get_log_ev_icc(component);
 
     // If the component has more than 2 members, we can skip the last step because it is the same as the first step
     if (n_members_1 > 2){n_members_1 -= 1;}
-    
-    while (n_members_1 > 1){
-        // Initial values
-        best_evidence_diff_tmp = -DBL_MAX; 
-        component_1 = partition[move_from];
-        component_2 = partition[move_to];
 
-        // Move each variable sequentially to component 'move_to'
-        for (int i = 0; i <= n_members_1; i++){
+    while (n_members_1 > 1){
+        // An interrupted split counts as no split
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){
+            return std::make_pair(component, other);
+        }
+        // Move each variable sequentially to the other component and calculate the difference in evidence (in parallel)
+        evidence_diff.assign(n_members_1 + 1, 0);
+        // Once the other component is not empty, only its neighbours are moved to it
+        __uint128_t neighbours = component_2 ? this->neighbourhood(component_2) : ~((__uint128_t) 0);
+        parallel_for(n_members_1 + 1, n_threads, [&](int i, int thread){
             // Integer representation of the bitstring with only a 1 in the position of the (i+1)th bit set to 1 in component
-            member = find_member_i(component_1, i+1);
-            component_1 -= member;
-            component_2 += member;
-
-            // Calculate difference in evidence from splitting
-            evidence_diff = this->get_log_ev_icc(component_1) + this->get_log_ev_icc(component_2) - evidence_unsplit_component;
-
-            // Check if this difference is the best one so far (even if negative)
-            if (evidence_diff > best_evidence_diff_tmp){
-                // Update the temporary best difference
-                best_evidence_diff_tmp = evidence_diff;
-                // Update partition
-                partition[move_from] = component_1;
-                partition[move_to] = component_2;
+            __uint128_t member = find_member_i(component_1, i+1);
+            if ((member & neighbours) == 0){
+                evidence_diff[i] = -DBL_MAX;
+                return;
             }
+            evidence_diff[i] = this->get_log_ev_icc(component_1 - member) + this->get_log_ev_icc(component_2 + member) - evidence_unsplit_component;
+        });
 
-            // Move variable back to component 'move_from'
-            component_1 += member;
-            component_2 -= member;
+        // Find the best move (even if negative), the first one in case of ties
+        best_evidence_diff_tmp = -DBL_MAX;
+        int best_move = -1;
+        for (int i = 0; i <= n_members_1; i++){
+            if (evidence_diff[i] > best_evidence_diff_tmp){
+                best_evidence_diff_tmp = evidence_diff[i];
+                best_move = i;
+            }
         }
+        // No variable can be moved anymore
+        if (best_move < 0){break;}
+        __uint128_t member = find_member_i(component_1, best_move+1);
+        component_1 -= member;
+        component_2 += member;
         // Check if the split results in an overall improvement of the evidence
         if (best_evidence_diff_tmp > best_evidence_diff){
             // Update the best difference
             best_evidence_diff = best_evidence_diff_tmp;
-            // Update the best MCM
-            this->mcm_out.partition[move_from] = partition[move_from];
-            this->mcm_out.partition[move_to] = partition[move_to];
+            split.first = component_1;
+            split.second = component_2;
         }
         // Update number of members
         n_members_1 -= 1;
     }
+    return split;
+}
+
+bool MCMSearch::division(int move_from, int move_to, const std::pair<__uint128_t, __uint128_t>& split){
+    // If the component contains 1 variable, no further splits are possible
+    if (bit_count(this->mcm_out.partition[move_from]) == 1){return false;}
+
+    // Apply the best split
+    this->mcm_out.partition[move_from] = split.first;
+    this->mcm_out.partition[move_to] = split.second;
+
     // Stop if no split increased the evidence -> component 'move_to' will be empty in that case
     if (this->mcm_out.partition[move_to] == 0){
-        return move_to;
+        return false;
     }
     // Update mcm results
     this->mcm_out.n_comp++;
@@ -175,7 +265,7 @@ int MCMSearch::division(int move_from, int move_to){
     this->mcm_out.log_ev_per_icc[move_to] = this->get_log_ev_icc(this->mcm_out.partition[move_to]);
     this->mcm_out.log_ev = this->get_log_ev(this->mcm_out.partition);
     
-    this->log_evidence_trajectory.push_back(this->mcm_out.log_ev);
+    this->trajectory.record(this->mcm_out.log_ev);
 
     if (this->output_file){
         *this->output_file << "Splitting component " << move_from << "\t Log-evidence (q-its/datapoint): " << this->mcm_out.log_ev / (this->data->N_synthetic * log(this->data->q)) << "\n";
@@ -183,14 +273,7 @@ int MCMSearch::division(int move_from, int move_to){
         *this->output_file << "\t Component " << move_to << " : \t" + int_to_string(this->mcm_out.partition[move_to], this->mcm_out.n) << "\n\n";
     }
 
-    // If there was a succesful split, component 'move_to' is no longer empty -> increase the index of the first empty component
-    int first_empty = move_to + 1;
-    // Continue with a split of the first subpart
-    first_empty = division(move_from, first_empty);
-    // Continue with a split of the second subpart
-    first_empty = division(move_to, first_empty);
-
-    return first_empty;
+    return true;
 }
 
 __uint128_t find_member_i(__uint128_t component, int i){
@@ -0,0 +1,88 @@
+#include "search/mcm_search/evidence_cache.h"
+
+EvidenceCache::EvidenceCache(int n_shards){
+    for (int i = 0; i < n_shards; i++){
+        this->shards.push_back(std::unique_ptr<Shard>(new Shard()));
+    }
+}
+
+double EvidenceCache::get(__uint128_t component, Data& data){
+    double log_ev;
+    if (this->find(component, log_ev)){
+        return log_ev;
+    }
+    // Not found -> calculate without holding the lock
+    log_ev = data.calc_log_ev_icc(component);
+    this->insert(component, log_ev);
+    return log_ev;
+}
+
+bool EvidenceCache::find(__uint128_t component, double& log_ev) const {
+    Shard& shard = this->shard_of(component);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    std::unordered_map<__uint128_t, double, Hash128>::const_iterator result = shard.storage.find(component);
+    if (result == shard.storage.end()){
+        return false;
+    }
+    log_ev = result->second;
+    return true;
+}
+
+void EvidenceCache::insert(__uint128_t component, double log_ev){
+    Shard& shard = this->shard_of(component);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.storage.emplace(component, log_ev).second && shard.tracking){
+        shard.inserted.push_back(std::make_pair(component, log_ev));
+    }
+}
+
+void EvidenceCache::clear(){
+    for (std::unique_ptr<Shard>& shard : this->shards){
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        // Release the memory of the buckets as well
+        std::unordered_map<__uint128_t, double, Hash128>().swap(shard->storage);
+        shard->tracking = false;
+        std::vector<std::pair<__uint128_t, double>>().swap(shard->inserted);
+    }
+}
+
+size_t EvidenceCache::size() const {
+    size_t size = 0;
+    for (const std::unique_ptr<Shard>& shard : this->shards){
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        size += shard->storage.size();
+    }
+    return size;
+}
+
+std::vector<std::pair<__uint128_t, double>> EvidenceCache::entries() const {
+    std::vector<std::pair<__uint128_t, double>> entries;
+    for (const std::unique_ptr<Shard>& shard : this->shards){
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        entries.insert(entries.end(), shard->storage.begin(), shard->storage.end());
+    }
+    return entries;
+}
+
+void EvidenceCache::track_insertions(){
+    for (std::unique_ptr<Shard>& shard : this->shards){
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->tracking = true;
+        shard->inserted.clear();
+    }
+}
+
+bool EvidenceCache::is_tracking() const {
+    std::lock_guard<std::mutex> lock(this->shards[0]->mutex);
+    return this->shards[0]->tracking;
+}
+
+std::vector<std::pair<__uint128_t, double>> EvidenceCache::take_insertions(){
+    std::vector<std::pair<__uint128_t, double>> entries;
+    for (std::unique_ptr<Shard>& shard : this->shards){
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        entries.insert(entries.end(), shard->inserted.begin(), shard->inserted.end());
+        std::vector<std::pair<__uint128_t, double>>().swap(shard->inserted);
+    }
+    return entries;
+}
@@ -1,9 +1,22 @@
 #include "search/mcm_search/mcm_search.h"
 #include "search/mcm_search/exhaustive.h"
 
-MCM MCMSearch::exhaustive_search(Data& data) {
+#include <mutex>
+
+MCM MCMSearch::exhaustive_search(Data& data, int shard, int n_shards, std::string result_file) {
+    StopScope scope(this->stop_condition);
+    if (n_shards < 1){
+        throw std::invalid_argument("The number of shards should be a positive number.");
+    }
+    if (shard < 0 || shard >= n_shards){
+        throw std::invalid_argument("The index of the shard should be between 0 and the number of shards - 1.");
+    }
     // Clear from previous search
-    this->log_evidence_trajectory.clear();
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->interaction_graph.clear();
+    this->mutual_information.clear();
     // Initialize an mcm object to store the result
     int n = data.n;
     this->mcm_out = MCM(n);
@@ -13,46 +26,243 @@ MCM MCMSearch::exhaustive_search(Data& data) {
     // Necessary because different data structure is used to store the evidence of ICCs
     this->exhaustive = true;
     // Reserve memory for storage of evidence of icc (2^n - 1 iccs) -> store in a vector because will encounter all of them in an exhaustive search
-    __uint128_t n_iccs = 1 << n;
-    this->evidence_storage_es.assign(n_iccs-1, 0);
-
-    // Variable to store the log evidence
-    double log_evidence;
-    // Representation of the partition that can used by the function to calculate the evidence
-    std::vector<__uint128_t> partition(n, 0);
-    // Initialize arrays to keep track of the next partition to generate
-    int a[n];
-    int b[n];
-    for (int i = 0; i < n; i++){
-        a[i] = 0;
-        b[i] = 1;
+    __uint128_t n_iccs = ((__uint128_t) 1 << n) - 1;
+    this->evidence_storage_es.assign(n_iccs, 0);
+
+    // Components larger than the maximum size are never part of an enumerated partition
+    int max_size = (this->max_component_size < n) ? this->max_component_size : 0;
+
+    // Every (admissible) component occurs in at least one partition -> calculate all evidences upfront (divided over the threads)
+    // such that the workers enumerating the partitions only have to read from the storage
+    std::vector<double>& storage = this->evidence_storage_es;
+    int n_chunks = (n_iccs < (__uint128_t) 64 * this->n_threads) ? (int) n_iccs : 64 * this->n_threads;
+    parallel_for(n_chunks, this->n_threads, [&](int chunk, int thread){
+        if (this->stop_condition.requested(-DBL_MAX)){return;}
+        for (__uint128_t component = chunk + 1; component <= n_iccs; component += n_chunks){
+            if (max_size && bit_count(component) > max_size){continue;}
+            storage[component-1] = data.calc_log_ev_icc(component);
+        }
+    });
+
+    // Divide the partitions over the workers based on the first entries of the restricted growth string
+    // With checkpoints, the tasks are kept small such that finished work is stored regularly
+    int min_prefixes = (this->n_threads > 1) ? 16 * this->n_threads : 1;
+    if (! this->checkpoint_file.empty() && min_prefixes < 1024){
+        min_prefixes = 1024;
     }
-    // Index of first value that is different (from right to left) between a and b
-    int j = n - 1;
+    // Each shard is assigned at least 64 short prefixes
+    if (min_prefixes < 64 * n_shards){
+        min_prefixes = 64 * n_shards;
+    }
+    ES_state state;
+    state.prefixes = generate_partition_prefixes(n, min_prefixes);
+    int n_tasks = state.prefixes.size();
+    state.done.assign(n_tasks, 0);
+    state.best_log_ev.assign(n_tasks, -DBL_MAX);
+    state.best_partition.resize(n_tasks);
+    state.trajectories.resize(n_tasks);
+    state.best_partitions = TopKPartitions(this->top_k);
+    // The full trajectory is not materialized if the caller asks for the k best partitions
+    state.store_trajectory = (this->top_k == 0 || this->trajectory.get_policy() != TrajectoryPolicy::all);
+
+    // Tasks of other shards are left to other processes
+    state.shard = shard;
+    state.n_shards = n_shards;
+    state.result_file = result_file;
+    state.in_shard.assign(n_tasks, 1);
+    if (n_shards > 1){
+        std::vector<int> shard_of_task = assign_prefixes_to_shards(state.prefixes, n, n_shards);
+        for (int task = 0; task < n_tasks; task++){
+            if (shard_of_task[task] != shard){
+                state.in_shard[task] = 0;
+                state.done[task] = 1;
+            }
+        }
+    }
+    state.summaries.resize(n_tasks);
+    state.max_size = max_size;
 
-    while (j != 0){
-        // Partition is written as a restricted growth string -> convert it (updates 'partition')
-        convert_partition(a, partition, n);
-        log_evidence = this->get_log_ev(partition);
+    this->last_checkpoint = std::chrono::steady_clock::now();
+    return this->run_exhaustive(state);
+}
+
+MCM MCMSearch::run_exhaustive(ES_state& state){
+    int n = this->data->n;
+    int n_tasks = state.prefixes.size();
+    std::vector<double>& storage = this->evidence_storage_es;
 
-        // Check if this is the new best log evidence
-        if (log_evidence > this->mcm_out.log_ev){
-            // Update the current best
-            this->mcm_out.log_ev = log_evidence;
-            // Make a hard copy of current partition to store
-            this->mcm_out.partition = partition;
+    // Each unfinished prefix records its own part of the trajectory, starting from the index of its first partition
+    // The parts are created when their task starts such that only the running tasks keep a file open
+    std::vector<unsigned long long> first_steps(n_tasks, 0);
+    if (state.store_trajectory){
+        for (int task = 1; task < n_tasks; task++){
+            first_steps[task] = first_steps[task-1] + count_partitions_with_prefix(state.prefixes[task-1], n, state.max_size);
+        }
+    }
+    std::vector<int> tasks;
+    for (int task = 0; task < n_tasks; task++){
+        if (! state.done[task]){tasks.push_back(task);}
+    }
+    // Protects the results of the finished tasks
+    std::mutex state_mutex;
+    bool writing_checkpoint = false;
+    // The parts of the leading finished tasks are appended to the trajectory of the search (in enumeration order)
+    // such that a checkpoint only contains the parts of the tasks that finished out of order
+    auto append_finished = [&](){
+        while (state.n_appended < n_tasks && state.done[state.n_appended]){
+            if (state.store_trajectory && state.in_shard[state.n_appended]){
+                this->trajectory.append(state.trajectories[state.n_appended]);
+            }
+            state.n_appended++;
         }
+    };
+    append_finished();
+    // Results of the tasks that were stopped before they finished, they are part of the result but not of the checkpointed state
+    std::vector<double> partial_log_ev(n_tasks, -DBL_MAX);
+    std::vector<std::vector<__uint128_t>> partial_partition(n_tasks);
+    TopKPartitions partial_best_partitions(this->top_k);
+
+    try {
+        parallel_for(tasks.size(), this->n_threads, [&](int index, int thread){
+            int task = tasks[index];
+            // Tasks that didn't start before the search was stopped stay unfinished
+            if (this->stop_condition.requested(-DBL_MAX)){return;}
+            if (state.store_trajectory){
+                state.trajectories[task] = this->trajectory.create_part(task, first_steps[task]);
+            }
+            int prefix_length = state.prefixes[task].size();
+            // Initialize arrays to keep track of the next partition to generate
+            std::vector<int> a(n);
+            std::vector<int> b(n);
+            // Number of variables in each component (only used if the size of the components is limited)
+            std::vector<int> sizes(n);
+            bool capped = (state.max_size > 0);
+            bool has_next = true;
+            if (capped){
+                has_next = init_capped_partition_with_prefix(state.prefixes[task], a.data(), b.data(), sizes.data(), n, state.max_size);
+            }
+            else {
+                init_partition_with_prefix(state.prefixes[task], a.data(), b.data(), n);
+            }
+
+            // Representation of the partition that can used to calculate the evidence
+            std::vector<__uint128_t> partition(n, 0);
+            double log_evidence;
+            double best_log_ev = -DBL_MAX;
+            std::vector<__uint128_t> best_partition;
+            TopKPartitions top_k(this->top_k);
+            TrajectoryRecorder& trajectory = state.trajectories[task];
+            // The result file of a shard contains summary statistics of all its partitions
+            bool summarize = ! state.result_file.empty();
+            TrajectorySummary summary;
+            unsigned long long count = 0;
+            bool stopped = false;
+
+            while (has_next){
+                // The time limit and the cancellation are checked every 4096 partitions
+                if ((++count & 4095) == 0 && this->stop_condition.requested(best_log_ev)){
+                    stopped = true;
+                    break;
+                }
+                // Partition is written as a restricted growth string -> convert it (updates 'partition')
+                std::fill(partition.begin(), partition.end(), 0);
+                convert_partition(a.data(), partition, n);
+
+                log_evidence = 0;
+                for (__uint128_t component : partition){
+                    if (component){
+                        log_evidence += storage[component-1];
+                    }
+                }
 
-        this->log_evidence_trajectory.push_back(log_evidence);
+                // Check if this is the new best log evidence
+                if (log_evidence > best_log_ev){
+                    best_log_ev = log_evidence;
+                    // Make a hard copy of current partition to store
+                    best_partition = partition;
+                }
+                if (state.store_trajectory){
+                    trajectory.record(log_evidence);
+                }
+                if (top_k.accepts(log_evidence)){
+                    top_k.push(log_evidence, partition);
+                }
+                if (summarize){
+                    summary.add(log_evidence);
+                }
+                if (capped){
+                    has_next = generate_next_capped_partition(a.data(), b.data(), sizes.data(), n, state.max_size, prefix_length);
+                }
+                else {
+                    has_next = generate_next_partition(a.data(), b.data(), n, prefix_length);
+                }
+            }
+            trajectory.finish();
 
-        j = generate_next_partition(a, b, n);
-        if (j == 0){
-            // All possible partitions are generated
-            break;
+            bool checkpoint;
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                // A stopped task is not finished, it is enumerated again when the search is resumed from a checkpoint
+                if (stopped){
+                    partial_log_ev[task] = best_log_ev;
+                    partial_partition[task] = best_partition;
+                    partial_best_partitions.merge(top_k);
+                    return;
+                }
+                state.best_log_ev[task] = best_log_ev;
+                state.best_partition[task] = best_partition;
+                state.best_partitions.merge(top_k);
+                state.summaries[task] = summary;
+                state.done[task] = 1;
+                append_finished();
+                // Only one worker writes a checkpoint at a time
+                checkpoint = ! writing_checkpoint && this->checkpoint_due();
+                if (checkpoint){writing_checkpoint = true;}
+            }
+            if (checkpoint){
+                // The other workers only wait for the state itself to be serialized
+                this->write_checkpoint(CheckpointMethod::exhaustive, [&](std::ostream& stream){
+                    write_binary(stream, state);
+                }, &state_mutex);
+                std::lock_guard<std::mutex> lock(state_mutex);
+                writing_checkpoint = false;
+            }
+        });
+    }
+    catch (...){
+        // Remove the temporary files of the parts before passing on the error
+        for (int task : tasks){
+            state.trajectories[task].discard();
         }
-        // Reset the converted partition
-        std::fill(partition.begin(), partition.end(), 0);
+        throw;
     }
+
+    // Combine the results of all prefixes (in enumeration order such that the result doesn't depend on the number of threads)
+    int best_task = -1;
+    TrajectorySummary summary;
+    for (int task = 0; task < n_tasks; task++){
+        if (! state.in_shard[task]){continue;}
+        if (state.done[task] && state.best_log_ev[task] > this->mcm_out.log_ev){
+            this->mcm_out.log_ev = state.best_log_ev[task];
+            this->mcm_out.partition = state.best_partition[task];
+            best_task = task;
+        }
+        else if (! state.done[task] && partial_log_ev[task] > this->mcm_out.log_ev){
+            this->mcm_out.log_ev = partial_log_ev[task];
+            this->mcm_out.partition = partial_partition[task];
+            best_task = task;
+        }
+        summary.merge(state.summaries[task]);
+        if (state.store_trajectory && task >= state.n_appended){
+            this->trajectory.append(state.trajectories[task]);
+        }
+    }
+    this->trajectory.finish();
+    // The independent model is the result if the search was stopped before any partition was evaluated
+    if (best_task < 0 && this->mcm_out.log_ev == -DBL_MAX){
+        this->mcm_out.log_ev = this->get_log_ev(this->mcm_out.partition);
+    }
+
     // Calculate the log ev per icc
     this->mcm_out.log_ev_per_icc.assign(n, 0);
 
@@ -65,21 +275,315 @@ MCM MCMSearch::exhaustive_search(Data& data) {
     }
     // Indicate that the search has been done
     this->mcm_out.optimized = true;
-    
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Store the k best partitions as MCM objects
+    if (this->top_k > 0){
+        TopKPartitions best_partitions = state.best_partitions;
+        best_partitions.merge(partial_best_partitions);
+        for (std::pair<double, std::vector<__uint128_t>>& entry : best_partitions.sorted()){
+            MCM mcm(n, entry.second);
+            mcm.log_ev = entry.first;
+            mcm.log_ev_per_icc.assign(n, 0);
+            for (int i = 0; i < mcm.n_comp; i++){
+                mcm.log_ev_per_icc[i] = this->get_log_ev_icc(mcm.partition[i]);
+            }
+            mcm.optimized = true;
+            this->top_mcms.push_back(mcm);
+        }
+    }
+    if (this->checkpoint_writer){
+        this->checkpoint_writer->wait();
+    }
+
+    // Write the result of the shard such that it can be merged with the other shards (only if all its partitions were enumerated)
+    if (! state.result_file.empty() && ! this->mcm_out.truncated){
+        ES_shard_result result;
+        result.n = this->data->n;
+        result.q = this->data->q;
+        result.N = this->data->N;
+        result.N_unique = this->data->N_unique;
+        result.N_synthetic = this->data->N_synthetic;
+        result.shard = state.shard;
+        result.n_shards = state.n_shards;
+        result.max_size = state.max_size;
+        result.best_task = best_task;
+        result.best_log_ev = this->mcm_out.log_ev;
+        result.best_partition = this->mcm_out.partition;
+        result.summary = summary;
+        result.best_partitions = state.best_partitions;
+        write_shard_result(state.result_file, result);
+    }
+
+    return this->mcm_out;
+}
+
+MCM MCMSearch::merge_shards(Data& data, const std::vector<std::string>& result_files){
+    if (result_files.empty()){
+        throw std::invalid_argument("No shard result files are given.");
+    }
+    int n = data.n;
+    this->data = &data;
+    this->mcm_out = MCM(n);
+    this->exhaustive = true;
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->interaction_graph.clear();
+    this->mutual_information.clear();
+
+    int n_shards = 0;
+    int max_size = 0;
+    int best_task = -1;
+    std::vector<char> found;
+    TopKPartitions best_partitions;
+    for (const std::string& file_name : result_files){
+        ES_shard_result result = read_shard_result(file_name);
+        if (result.n != data.n || result.q != data.q || result.N != data.N || result.N_unique != data.N_unique || result.N_synthetic != data.N_synthetic){
+            throw std::invalid_argument("The shard results were created for a different dataset.");
+        }
+        if (found.empty()){
+            n_shards = result.n_shards;
+            max_size = result.max_size;
+            found.assign(n_shards, 0);
+            best_partitions = TopKPartitions(result.best_partitions.get_k());
+        }
+        if (result.n_shards != n_shards || result.max_size != max_size || result.best_partitions.get_k() != best_partitions.get_k()){
+            throw std::invalid_argument("The shard results belong to different searches.");
+        }
+        if (found[result.shard]){
+            throw std::invalid_argument("The shard results contain shard " + std::to_string(result.shard) + " more than once.");
+        }
+        found[result.shard] = 1;
+
+        // Ties are broken in enumeration order, as in a search that is not sharded
+        if (result.best_task >= 0 && (result.best_log_ev > this->mcm_out.log_ev || (result.best_log_ev == this->mcm_out.log_ev && result.best_task < best_task))){
+            this->mcm_out.log_ev = result.best_log_ev;
+            this->mcm_out.partition = result.best_partition;
+            best_task = result.best_task;
+        }
+        this->trajectory.add_summary(result.summary);
+        best_partitions.merge(result.best_partitions);
+    }
+    for (int shard = 0; shard < n_shards; shard++){
+        if (! found[shard]){
+            throw std::invalid_argument("The result of shard " + std::to_string(shard) + " is missing.");
+        }
+    }
+    this->trajectory.finish();
+
+    // Calculate the log ev per icc
+    this->evidence_storage_es.assign(((__uint128_t) 1 << n) - 1, 0);
+    this->mcm_out.log_ev_per_icc.assign(n, 0);
+    this->mcm_out.n_comp = 0;
+    for (int i = 0; i < n; i++){
+        if (this->mcm_out.partition[i]){
+            this->mcm_out.log_ev_per_icc[i] = this->get_log_ev_icc(this->mcm_out.partition[i]);
+            this->mcm_out.n_comp++;
+        }
+    }
+    this->mcm_out.optimized = true;
+
+    for (std::pair<double, std::vector<__uint128_t>>& entry : best_partitions.sorted()){
+        MCM mcm(n, entry.second);
+        mcm.log_ev = entry.first;
+        mcm.log_ev_per_icc.assign(n, 0);
+        for (int i = 0; i < mcm.n_comp; i++){
+            mcm.log_ev_per_icc[i] = this->get_log_ev_icc(mcm.partition[i]);
+        }
+        mcm.optimized = true;
+        this->top_mcms.push_back(mcm);
+    }
+
     return this->mcm_out;
 }
 
-int generate_next_partition(int* a, int* b, int n){
-    // Compare the last bit
-    if (a[n-1] != b[n-1]){
+std::vector<int> assign_prefixes_to_shards(const std::vector<std::vector<int>>& prefixes, int n, int n_shards){
+    std::vector<int> shard_of_task(prefixes.size(), 0);
+    if (n_shards == 1){return shard_of_task;}
+
+    // Short prefixes are distributed over the shards in a round-robin fashion to balance the work
+    std::vector<std::vector<int>> shard_prefixes = generate_partition_prefixes(n, 64 * n_shards);
+    int shard_prefix_length = shard_prefixes[0].size();
+    std::map<std::vector<int>, int> shard_of_prefix;
+    for (int i = 0; i < (int) shard_prefixes.size(); i++){
+        shard_of_prefix[shard_prefixes[i]] = i % n_shards;
+    }
+    for (int task = 0; task < (int) prefixes.size(); task++){
+        if ((int) prefixes[task].size() < shard_prefix_length){
+            throw std::invalid_argument("The prefixes of the tasks are shorter than the prefixes of the shards.");
+        }
+        std::vector<int> shard_prefix(prefixes[task].begin(), prefixes[task].begin() + shard_prefix_length);
+        shard_of_task[task] = shard_of_prefix[shard_prefix];
+    }
+    return shard_of_task;
+}
+
+// Identifies a shard result file and the version of its layout
+static const std::string SHARD_MAGIC = "MCMSHRD1";
+
+void write_shard_result(const std::string& file_name, const ES_shard_result& result){
+    std::ofstream file(file_name, std::ios::binary);
+    if (! file.is_open()){
+        throw std::runtime_error("Could not open the shard result file.");
+    }
+    file.write(SHARD_MAGIC.data(), SHARD_MAGIC.size());
+    write_binary(file, result.n);
+    write_binary(file, result.q);
+    write_binary(file, result.N);
+    write_binary(file, result.N_unique);
+    write_binary(file, result.N_synthetic);
+    write_binary(file, result.shard);
+    write_binary(file, result.n_shards);
+    write_binary(file, result.max_size);
+    write_binary(file, result.best_task);
+    write_binary(file, result.best_log_ev);
+    write_binary(file, result.best_partition);
+    write_binary(file, result.summary);
+
+    std::vector<std::pair<double, std::vector<__uint128_t>>> best = result.best_partitions.sorted();
+    write_binary(file, result.best_partitions.get_k());
+    write_binary(file, (int) best.size());
+    for (std::pair<double, std::vector<__uint128_t>>& entry : best){
+        write_binary(file, entry.first);
+        write_binary(file, entry.second);
+    }
+    file.close();
+    if (! file){
+        throw std::runtime_error("Could not write the shard result file.");
+    }
+}
+
+ES_shard_result read_shard_result(const std::string& file_name){
+    std::ifstream file(file_name, std::ios::binary);
+    if (! file.is_open()){
+        throw std::invalid_argument("Could not open the shard result file " + file_name + ".");
+    }
+    std::string magic(SHARD_MAGIC.size(), ' ');
+    file.read(&magic[0], magic.size());
+    if (! file || magic != SHARD_MAGIC){
+        throw std::invalid_argument("The file " + file_name + " is not a shard result file.");
+    }
+    ES_shard_result result;
+    read_binary(file, result.n);
+    read_binary(file, result.q);
+    read_binary(file, result.N);
+    read_binary(file, result.N_unique);
+    read_binary(file, result.N_synthetic);
+    read_binary(file, result.shard);
+    read_binary(file, result.n_shards);
+    read_binary(file, result.max_size);
+    read_binary(file, result.best_task);
+    read_binary(file, result.best_log_ev);
+    read_binary(file, result.best_partition);
+    read_binary(file, result.summary);
+    if (result.n_shards < 1 || result.shard < 0 || result.shard >= result.n_shards){
+        throw std::runtime_error("The shard result file " + file_name + " is corrupted.");
+    }
+
+    int k;
+    int size;
+    read_binary(file, k);
+    read_binary(file, size);
+    result.best_partitions = TopKPartitions(k);
+    double log_ev;
+    std::vector<__uint128_t> partition;
+    for (int i = 0; i < size; i++){
+        read_binary(file, log_ev);
+        read_binary(file, partition);
+        result.best_partitions.push(log_ev, partition);
+    }
+    return result;
+}
+
+void write_binary(std::ostream& stream, ES_state& state){
+    int n_tasks = state.prefixes.size();
+    write_binary(stream, n_tasks);
+    for (std::vector<int>& prefix : state.prefixes){
+        write_binary(stream, prefix);
+    }
+    write_binary(stream, state.done);
+    write_binary(stream, state.n_appended);
+    write_binary(stream, state.best_log_ev);
+    write_binary(stream, state.store_trajectory);
+    write_binary(stream, state.in_shard);
+    write_binary(stream, state.max_size);
+    write_binary(stream, state.shard);
+    write_binary(stream, state.n_shards);
+    write_binary(stream, state.result_file);
+    for (int task = 0; task < n_tasks; task++){
+        if (! state.done[task]){continue;}
+        write_binary(stream, state.best_partition[task]);
+        write_binary(stream, state.summaries[task]);
+        // The parts of the leading tasks are already part of the trajectory of the search
+        if (state.store_trajectory && task >= state.n_appended){
+            state.trajectories[task].save(stream);
+        }
+    }
+
+    std::vector<std::pair<double, std::vector<__uint128_t>>> best = state.best_partitions.sorted();
+    write_binary(stream, state.best_partitions.get_k());
+    write_binary(stream, (int) best.size());
+    for (std::pair<double, std::vector<__uint128_t>>& entry : best){
+        write_binary(stream, entry.first);
+        write_binary(stream, entry.second);
+    }
+}
+
+void read_binary(std::istream& stream, ES_state& state){
+    int n_tasks;
+    read_binary(stream, n_tasks);
+    state.prefixes.resize(n_tasks);
+    for (std::vector<int>& prefix : state.prefixes){
+        read_binary(stream, prefix);
+    }
+    read_binary(stream, state.done);
+    read_binary(stream, state.n_appended);
+    read_binary(stream, state.best_log_ev);
+    read_binary(stream, state.store_trajectory);
+    read_binary(stream, state.in_shard);
+    read_binary(stream, state.max_size);
+    read_binary(stream, state.shard);
+    read_binary(stream, state.n_shards);
+    read_binary(stream, state.result_file);
+    state.summaries.assign(n_tasks, TrajectorySummary());
+    state.best_partition.assign(n_tasks, std::vector<__uint128_t>());
+    state.trajectories.clear();
+    state.trajectories.resize(n_tasks);
+    for (int task = 0; task < n_tasks; task++){
+        if (! state.done[task]){continue;}
+        read_binary(stream, state.best_partition[task]);
+        read_binary(stream, state.summaries[task]);
+        if (state.store_trajectory && task >= state.n_appended){
+            state.trajectories[task].load(stream);
+        }
+    }
+
+    int k;
+    int size;
+    read_binary(stream, k);
+    read_binary(stream, size);
+    state.best_partitions = TopKPartitions(k);
+    double log_ev;
+    std::vector<__uint128_t> partition;
+    for (int i = 0; i < size; i++){
+        read_binary(stream, log_ev);
+        read_binary(stream, partition);
+        state.best_partitions.push(log_ev, partition);
+    }
+}
+
+int generate_next_partition(int* a, int* b, int n, int prefix_length){
+    // Compare the last bit (unless it is part of the fixed prefix)
+    if (prefix_length < n && a[n-1] != b[n-1]){
         // Increase the last bit of 'a' by 1 to generate new partition
         a[n-1] += 1;
         return 1;
     }
     // Find the first bit that is different (starting from the right)
-    int j = find_j(a, b, n);
-    if (j == 0){
-        // All bits are the same -> all possible partitions are generated
+    int j = find_j(a, b, n, prefix_length);
+    if (j < prefix_length){
+        // All bits outside of the prefix are the same -> all possible partitions are generated
         return 0;
     }
     // Increase the first bit from the right in 'a' that is different from 'b' by 1
@@ -100,8 +604,136 @@ int generate_next_partition(int* a, int* b, int n){
     return 1;
 }
 
-int find_j(int* a, int* b, int n){
+int find_j(int* a, int* b, int n, int prefix_length){
     int j = n-2;
-    while(a[j] == b[j]){--j;}
+    while(j >= prefix_length && a[j] == b[j]){--j;}
     return j;
-}
\ No newline at end of file
+}
+
+unsigned long long count_partitions_with_prefix(const std::vector<int>& prefix, int n, int max_size){
+    int prefix_length = prefix.size();
+    int n_comp = 0;
+    for (int comp : prefix){
+        if (comp + 1 > n_comp){n_comp = comp + 1;}
+    }
+    if (max_size > 0 && max_size < n){
+        return count_capped_partitions_with_prefix(prefix, n_comp, n, max_size);
+    }
+    // counts[m] = number of ways to place the remaining variables if m components are already used
+    // Recursion: the next variable joins one of the m components or starts component m+1
+    std::vector<unsigned long long> counts(n + 1, 1);
+    for (int r = 1; r <= n - prefix_length; r++){
+        for (int m = 1; m <= n - r; m++){
+            counts[m] = m * counts[m] + counts[m+1];
+        }
+    }
+    return counts[n_comp];
+}
+
+std::vector<std::vector<int>> generate_partition_prefixes(int n, int min_prefixes){
+    std::vector<std::vector<int>> prefixes;
+    int prefix_length = 0;
+    // Increase the length of the prefix until there are enough of them
+    do {
+        prefix_length++;
+        prefixes.clear();
+        std::vector<int> a(prefix_length, 0);
+        std::vector<int> b(prefix_length, 1);
+        do {
+            prefixes.push_back(a);
+        } while (generate_next_partition(a.data(), b.data(), prefix_length));
+    } while ((int) prefixes.size() < min_prefixes && prefix_length < n);
+
+    return prefixes;
+}
+
+void init_partition_with_prefix(const std::vector<int>& prefix, int* a, int* b, int n){
+    int prefix_length = prefix.size();
+    // The first entry is always zero, b[0] acts as a sentinel
+    a[0] = 0;
+    b[0] = 1;
+    int max_comp = 0;
+    for (int i = 1; i < n; i++){
+        // Variable i can be placed in one of the existing components or in a new one
+        b[i] = max_comp + 1;
+        a[i] = (i < prefix_length) ? prefix[i] : 0;
+        if (a[i] > max_comp){max_comp = a[i];}
+    }
+}
+
+unsigned long long count_capped_partitions_with_prefix(const std::vector<int>& prefix, int n_comp, int n, int max_size){
+    int r = n - prefix.size();
+    std::vector<int> sizes(n_comp, 0);
+    for (int comp : prefix){
+        if (++sizes[comp] > max_size){return 0;}
+    }
+    // Binomial coefficients up to the number of remaining variables
+    std::vector<std::vector<unsigned long long>> binom(r + 1, std::vector<unsigned long long>(r + 1, 0));
+    for (int i = 0; i <= r; i++){
+        binom[i][0] = 1;
+        for (int k = 1; k <= i; k++){
+            binom[i][k] = binom[i-1][k-1] + binom[i-1][k];
+        }
+    }
+    // counts[m] = number of partitions of m variables into new components of at most max_size variables
+    // Recursion on the size k of the component that contains the first of the m variables
+    std::vector<unsigned long long> counts(r + 1, 0);
+    counts[0] = 1;
+    for (int m = 1; m <= r; m++){
+        for (int k = 1; k <= std::min(max_size, m); k++){
+            counts[m] += binom[m-1][k-1] * counts[m-k];
+        }
+    }
+    // Each component of the prefix can receive up to (max_size - size) of the remaining variables
+    std::vector<unsigned long long> new_counts(r + 1);
+    for (int size : sizes){
+        for (int m = 0; m <= r; m++){
+            new_counts[m] = 0;
+            for (int k = 0; k <= std::min(max_size - size, m); k++){
+                new_counts[m] += binom[m][k] * counts[m-k];
+            }
+        }
+        counts.swap(new_counts);
+    }
+    return counts[r];
+}
+
+bool init_capped_partition_with_prefix(const std::vector<int>& prefix, int* a, int* b, int* sizes, int n, int max_size){
+    init_partition_with_prefix(prefix, a, b, n);
+    std::fill(sizes, sizes + n, 0);
+    int prefix_length = prefix.size();
+    for (int i = 0; i < prefix_length; i++){
+        // The prefix itself already contains a component that is too large
+        if (++sizes[a[i]] > max_size){return false;}
+    }
+    fill_capped_partition(a, b, sizes, n, max_size, prefix_length);
+    return true;
+}
+
+int generate_next_capped_partition(int* a, int* b, int* sizes, int n, int max_size, int prefix_length){
+    // Find the last variable that can move to a later component that is not full
+    for (int j = n-1; j >= prefix_length; j--){
+        sizes[a[j]]--;
+        for (int comp = a[j] + 1; comp <= b[j]; comp++){
+            if (sizes[comp] < max_size){
+                a[j] = comp;
+                sizes[comp]++;
+                // Place the variables to the right in the first component that is not full
+                fill_capped_partition(a, b, sizes, n, max_size, j+1);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+void fill_capped_partition(int* a, int* b, int* sizes, int n, int max_size, int start){
+    for (int i = start; i < n; i++){
+        // Variable i can be placed in one of the existing components or in a new one
+        b[i] = std::max(b[i-1], a[i-1] + 1);
+        int comp = 0;
+        while (sizes[comp] >= max_size){comp++;}
+        a[i] = comp;
+        sizes[comp]++;
+    }
+}
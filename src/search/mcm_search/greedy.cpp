@@ -1,6 +1,11 @@
 #include "search/mcm_search/mcm_search.h"
+#include "search/mcm_search/greedy.h"
+
+#include <algorithm>
+#include <set>
 
 MCM MCMSearch::greedy_search(Data& data, MCM* init_mcm, std::string file_name){
+    StopScope scope(this->stop_condition);
     // Assign variables
     int n = data.n;
     this->data = &data;
@@ -20,8 +25,10 @@ MCM MCMSearch::greedy_search(Data& data, MCM* init_mcm, std::string file_name){
     }
 
     // Clear from previous search
-    this->log_evidence_trajectory.clear();
+    this->trajectory.start();
+    this->top_mcms.clear();
     this->exhaustive = false;
+    this->build_interaction_graph();
 
     // Calculate the log ev
     this->mcm_out.log_ev_per_icc.assign(n, 0);
@@ -31,7 +38,11 @@ MCM MCMSearch::greedy_search(Data& data, MCM* init_mcm, std::string file_name){
     this->mcm_out.log_ev = this->get_log_ev(this->mcm_out.partition);
 
     // Store log_ev of starting point
-    this->log_evidence_trajectory.push_back(this->mcm_out.log_ev);
+    this->trajectory.record(this->mcm_out.log_ev);
+    this->dendrogram.clear();
+    if (this->beam_width == 1){
+        this->dendrogram.start(this->mcm_out);
+    }
 
     // Write the initial partition to the output file
     if (!file_name.empty()){
@@ -60,15 +71,36 @@ MCM MCMSearch::greedy_search(Data& data, MCM* init_mcm, std::string file_name){
 
         print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
         *this->output_file << "\n";
+
+        *this->output_file << "Start merging \n";
+        *this->output_file << "------------- \n\n";
     }
 
+    this->last_checkpoint = std::chrono::steady_clock::now();
+    std::vector<MCM> beam;
+    return this->run_greedy(file_name, beam);
+}
+
+MCM MCMSearch::run_greedy(std::string file_name, std::vector<MCM>& beam){
+    Data& data = *this->data;
+
     // Hierarchical merging procedure
-    this->hierarchical_merging();
+    if (this->beam_width > 1){
+        if (beam.empty()){
+            beam.push_back(this->mcm_out);
+        }
+        this->beam_merging(beam, true);
+    }
+    else {
+        this->hierarchical_merging(true);
+    }
 
     place_empty_entries_last(this->mcm_out.partition);
     place_empty_entries_last(this->mcm_out.log_ev_per_icc);
     // Indicate that the search has been done
+    this->trajectory.finish();
     this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
 
     // Write results to the output file
     if (!file_name.empty()){
@@ -87,75 +119,306 @@ MCM MCMSearch::greedy_search(Data& data, MCM* init_mcm, std::string file_name){
 
     // Clear the storage of log-evidences
     this->evidence_storage.clear();
+    if (this->checkpoint_writer){
+        this->checkpoint_writer->wait();
+    }
 
     return this->mcm_out;
 }
 
-void MCMSearch::hierarchical_merging(){
-    // Output file
-    if (this->output_file){
-        *this->output_file << "Start merging \n";
-        *this->output_file << "------------- \n\n";
+void MCMSearch::hierarchical_merging(bool checkpoints){
+    int n = this->mcm_out.n;
+    std::vector<__uint128_t>& partition = this->mcm_out.partition;
+    std::vector<double>& log_ev_per_icc = this->mcm_out.log_ev_per_icc;
+
+    // The gain of every pair of components is kept in a priority queue
+    // After a merge, only the pairs that contain the merged component are recalculated
+    // Candidates of components that changed since their gain was calculated are outdated and skipped
+    std::vector<int> version(n, 0);
+    MergeQueue candidates;
+    this->merge_statistics = MergeStatistics();
+
+    // Evaluate the gains of a list of pairs (i < j) and add the ones that increase the evidence to the queue
+    // The evidences of the merged components are calculated in parallel, the queue is filled in the order of the pairs afterwards
+    std::vector<std::pair<int, int>> pairs;
+    std::vector<double> merged_log_ev;
+    auto evaluate_candidates = [&](){
+        this->merge_statistics.n_evaluated += pairs.size();
+        merged_log_ev.resize(pairs.size());
+        int n_chunks = std::min((int) pairs.size(), 8 * this->n_threads);
+        parallel_for(n_chunks, this->n_threads, [&](int chunk, int thread){
+            if (this->stop_condition.requested(this->mcm_out.log_ev)){return;}
+            size_t begin = pairs.size() * chunk / n_chunks;
+            size_t end = pairs.size() * (chunk + 1) / n_chunks;
+            for (size_t p = begin; p < end; p++){
+                merged_log_ev[p] = this->get_log_ev_icc(partition[pairs[p].first] + partition[pairs[p].second]);
+            }
+        });
+        // An interrupted round adds no candidates, such that no merge is done with a gain that was not calculated
+        if (this->stop_condition.triggered()){
+            pairs.clear();
+            return;
+        }
+        for (size_t p = 0; p < pairs.size(); p++){
+            MergeCandidate candidate;
+            candidate.i = pairs[p].first;
+            candidate.j = pairs[p].second;
+            candidate.log_ev = merged_log_ev[p];
+            candidate.gain = candidate.log_ev - log_ev_per_icc[candidate.i] - log_ev_per_icc[candidate.j];
+            // Merges that don't increase the evidence are only chosen to complete the merge tree
+            if (candidate.gain > 0 || this->full_dendrogram){
+                candidate.version_i = version[candidate.i];
+                candidate.version_j = version[candidate.j];
+                candidate.bound = false;
+                candidates.push(candidate);
+            }
+        }
+        pairs.clear();
+    };
+
+    // Add a list of new pairs to the queue
+    // With pruning, a pair is added with an upper bound on its gain and is only evaluated when this bound is on top of the queue
+    Data& data = *this->data;
+    auto add_candidates = [&](){
+        this->merge_statistics.n_candidates += pairs.size();
+        if (! this->merge_pruning){
+            evaluate_candidates();
+            return;
+        }
+        for (size_t p = 0; p < pairs.size(); p++){
+            MergeCandidate candidate;
+            candidate.i = pairs[p].first;
+            candidate.j = pairs[p].second;
+            candidate.gain = merge_gain_bound(data, partition[candidate.i], partition[candidate.j], log_ev_per_icc[candidate.i], log_ev_per_icc[candidate.j]);
+            if (candidate.gain <= 0 && ! this->full_dendrogram){
+                this->merge_statistics.n_pruned_bound++;
+                continue;
+            }
+            candidate.log_ev = 0;
+            candidate.version_i = version[candidate.i];
+            candidate.version_j = version[candidate.j];
+            candidate.bound = true;
+            candidates.push(candidate);
+        }
+        pairs.clear();
+    };
+
+    for (int i = 0; i < n; i++){
+        // Skip empty components
+        if (partition[i] == 0){continue;}
+        // Only components with interacting variables are merged
+        __uint128_t neighbours = this->neighbourhood(partition[i]);
+        for (int j = i+1; j < n; j++){
+            if ((partition[j] & neighbours) == 0){continue;}
+            pairs.push_back(std::make_pair(i, j));
+        }
     }
+    add_candidates();
 
-    int n = this->mcm_out.n;
-    // Variables to store the calculated evidences
-    double evidence_i;
-    double evidence_j;
-    double evidence_ij;
-    double evidence_diff;
-
-    // Variables to store the best values
-    int best_i;
-    int best_j;
-    double best_evidence;
-    double best_evidence_diff;
-
-    while (true){
-        best_evidence_diff = 0;
-        for (int i = 0; i < n; i++){
-            // Skip empty components
-            if (this->mcm_out.partition[i] == 0){continue;}
-            evidence_i = this->mcm_out.log_ev_per_icc[i];
-            for (int j = i+1; j < n; j++){
-                // Skip empty components
-                if (this->mcm_out.partition[j] == 0){continue;}
-                evidence_j = this->mcm_out.log_ev_per_icc[j];
-                // Calculate difference in evidence between merged and separate partitions
-                evidence_ij = this->get_log_ev_icc(this->mcm_out.partition[i] + this->mcm_out.partition[j]);
-                evidence_diff = evidence_ij - evidence_i - evidence_j;
-                // Check if the difference is the best merge so far
-                if (evidence_diff > best_evidence_diff){
-                    // Update the largest increase in evidence
-                    best_evidence_diff = evidence_diff;
-                    best_evidence = evidence_ij;
-                    // Keep track of the components that resulted in the largest increase
-                    best_i = i;
-                    best_j = j;
+    while (! candidates.empty()){
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){
+            if (this->output_file){
+                *this->output_file << "\nSearch stopped (time limit or cancellation) \n";
+            }
+            break;
+        }
+        if (candidates.top().bound){
+            // Evaluate the candidates with the largest bounds (in parallel), their exact gains are added to the queue again
+            while (! candidates.empty() && candidates.top().bound && (int) pairs.size() < 8 * this->n_threads){
+                MergeCandidate candidate = candidates.top();
+                candidates.pop();
+                if (candidate.version_i != version[candidate.i] || candidate.version_j != version[candidate.j]){
+                    // One of the components was merged before the bound of this pair was large enough
+                    this->merge_statistics.n_pruned_best++;
+                    continue;
                 }
+                pairs.push_back(std::make_pair(candidate.i, candidate.j));
             }
+            evaluate_candidates();
+            continue;
         }
-        // Stop the algorithm if the evidence did not increase
-        if (best_evidence_diff == 0){
-            break;
+        MergeCandidate best = candidates.top();
+        candidates.pop();
+        if (best.version_i != version[best.i] || best.version_j != version[best.j]){continue;}
+
+        // Merge the two components that results in the biggest increase in evidence
+        partition[best.i] += partition[best.j];
+        partition[best.j] = 0;
+
+        log_ev_per_icc[best.i] = best.log_ev;
+        log_ev_per_icc[best.j] = 0;
+
+        this->mcm_out.log_ev += best.gain;
+
+        // Merges after the first one that doesn't increase the evidence only complete the merge tree
+        bool first_extra = (this->dendrogram.get_best_n_merges() == this->dendrogram.get_n_merges()) && (best.gain <= 0);
+        bool result = (this->dendrogram.get_best_n_merges() == this->dendrogram.get_n_merges()) && (best.gain > 0);
+        this->dendrogram.add({best.i, best.j, best.log_ev, this->mcm_out.log_ev}, best.gain > 0);
+        if (result){
+            this->trajectory.record(this->mcm_out.log_ev);
         }
-        else{
-            // Merge the two components that results in the biggest increase in evidence
-            this->mcm_out.partition[best_i] += this->mcm_out.partition[best_j];
-            this->mcm_out.partition[best_j] = 0;
 
-            this->mcm_out.log_ev_per_icc[best_i] = best_evidence;
-            this->mcm_out.log_ev_per_icc[best_j] = 0;
+        this->mcm_out.n_comp--;
+        version[best.i]++;
+        version[best.j]++;
 
-            this->mcm_out.log_ev += best_evidence_diff;
-            this->log_evidence_trajectory.push_back(this->mcm_out.log_ev);
+        // Write to the output file
+        if (this->output_file){
+            if (first_extra){
+                *this->output_file << "\nNo merge increases the log-evidence, continue merging to complete the merge tree \n\n";
+            }
+            *this->output_file << "Merging components " << best.i << " and " << best.j << " \t Log-evidence (q-its/datapoint): "<<  (this->mcm_out.log_ev) / (this->data->N_synthetic * log(this->data->q)) << "\n";
+        }
+        // The state of the greedy search is completely described by the current partition
+        if (checkpoints && this->checkpoint_due()){
+            this->write_checkpoint(CheckpointMethod::greedy, [&](std::ostream& stream){
+                // No beam
+                write_binary(stream, this->beam_width);
+                write_binary(stream, (int) 0);
+                write_binary(stream, this->full_dendrogram);
+                this->dendrogram.save(stream);
+            });
+        }
 
-            this->mcm_out.n_comp--;
+        // Gains of the pairs with the merged component
+        __uint128_t neighbours = this->neighbourhood(partition[best.i]);
+        for (int k = 0; k < n; k++){
+            if (k == best.i || (partition[k] & neighbours) == 0){continue;}
+            pairs.push_back(std::make_pair(std::min(k, best.i), std::max(k, best.i)));
+        }
+        add_candidates();
+    }
+    // Go back to the partition at which no merge increased the evidence anymore
+    if (this->dendrogram.get_best_n_merges() < this->dendrogram.get_n_merges()){
+        MCM best_mcm = this->dendrogram.cut(this->dendrogram.get_best_n_merges());
+        partition = best_mcm.partition;
+        log_ev_per_icc = best_mcm.log_ev_per_icc;
+        this->mcm_out.log_ev = best_mcm.log_ev;
+        this->mcm_out.n_comp = best_mcm.n_comp;
+    }
+    // Output file
+    if (this->output_file){
+        *this->output_file << "\nStop merging \n";
+        *this->output_file << "------------ \n\n";
+    }
+}
+
+void MCMSearch::beam_merging(std::vector<MCM>& beam, bool checkpoints){
+    int n = this->mcm_out.n;
+    int width = this->beam_width;
 
-            // Write to the output file
+    // The best partition seen so far is stored in mcm_out
+    for (MCM& state : beam){
+        if (state.log_ev > this->mcm_out.log_ev){
+            this->mcm_out = state;
+        }
+    }
+
+    std::vector<MergeCandidate> pairs;
+    std::vector<int> pair_state;
+    int step = 0;
+    while (! beam.empty()){
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){
             if (this->output_file){
-                *this->output_file << "Merging components " << best_i << " and " << best_j << " \t Log-evidence (q-its/datapoint): "<<  (this->mcm_out.log_ev) / (this->data->N_synthetic * log(this->data->q)) << "\n";
+                *this->output_file << "\nSearch stopped (time limit or cancellation) \n";
+            }
+            break;
+        }
+        // Evaluate all pairs of components of all partitions in the beam in parallel (through the shared cache)
+        pairs.clear();
+        pair_state.clear();
+        for (int s = 0; s < (int) beam.size(); s++){
+            for (int i = 0; i < n; i++){
+                if (beam[s].partition[i] == 0){continue;}
+                __uint128_t neighbours = this->neighbourhood(beam[s].partition[i]);
+                for (int j = i+1; j < n; j++){
+                    if ((beam[s].partition[j] & neighbours) == 0){continue;}
+                    MergeCandidate candidate;
+                    candidate.i = i;
+                    candidate.j = j;
+                    pairs.push_back(candidate);
+                    pair_state.push_back(s);
+                }
+            }
+        }
+        int n_chunks = std::min((int) pairs.size(), 8 * this->n_threads);
+        parallel_for(n_chunks, this->n_threads, [&](int chunk, int thread){
+            if (this->stop_condition.requested(this->mcm_out.log_ev)){return;}
+            size_t begin = pairs.size() * chunk / n_chunks;
+            size_t end = pairs.size() * (chunk + 1) / n_chunks;
+            for (size_t p = begin; p < end; p++){
+                MCM& state = beam[pair_state[p]];
+                pairs[p].log_ev = this->get_log_ev_icc(state.partition[pairs[p].i] + state.partition[pairs[p].j]);
+                pairs[p].gain = pairs[p].log_ev - state.log_ev_per_icc[pairs[p].i] - state.log_ev_per_icc[pairs[p].j];
             }
+        });
+        // An interrupted round expands no partition
+        if (this->stop_condition.triggered()){break;}
+
+        // Expand every partition with its best merges that increase the evidence
+        std::vector<std::pair<double, std::vector<__uint128_t>>> keys;
+        std::vector<MCM> children;
+        size_t first = 0;
+        for (int s = 0; s < (int) beam.size(); s++){
+            std::vector<MergeCandidate> improving;
+            for (; first < pairs.size() && pair_state[first] == s; first++){
+                if (pairs[first].gain > 0){improving.push_back(pairs[first]);}
+            }
+            int n_expand = std::min(width, (int) improving.size());
+            std::partial_sort(improving.begin(), improving.begin() + n_expand, improving.end(), [](const MergeCandidate& a, const MergeCandidate& b){
+                return WorseMerge()(b, a);
+            });
+            for (int e = 0; e < n_expand; e++){
+                MergeCandidate& merge = improving[e];
+                MCM child = beam[s];
+                child.partition[merge.i] += child.partition[merge.j];
+                child.partition[merge.j] = 0;
+                child.log_ev_per_icc[merge.i] = merge.log_ev;
+                child.log_ev_per_icc[merge.j] = 0;
+                child.log_ev += merge.gain;
+                child.n_comp--;
+                // Equivalent partitions that are reached by merging in a different order have the same sorted components
+                std::vector<__uint128_t> key = child.partition;
+                std::sort(key.begin(), key.end());
+                keys.push_back(std::make_pair(child.log_ev, key));
+                children.push_back(child);
+            }
+        }
+        if (children.empty()){break;}
+
+        // Keep the best distinct partitions (ties are broken on the partition such that the result is deterministic)
+        std::vector<int> order(children.size());
+        for (int c = 0; c < (int) children.size(); c++){order[c] = c;}
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b){
+            return better_partition(keys[a], keys[b]);
+        });
+        std::set<std::vector<__uint128_t>> kept;
+        beam.clear();
+        for (int c = 0; c < (int) order.size() && (int) beam.size() < width; c++){
+            if (! kept.insert(keys[order[c]].second).second){continue;}
+            beam.push_back(children[order[c]]);
+        }
+        step++;
+
+        if (beam[0].log_ev > this->mcm_out.log_ev){
+            this->mcm_out = beam[0];
+        }
+        this->trajectory.record(this->mcm_out.log_ev);
+
+        // Write to the output file
+        if (this->output_file){
+            *this->output_file << "Beam step " << step << " \t Best log-evidence in beam (q-its/datapoint): " << beam[0].log_ev / (this->data->N_synthetic * log(this->data->q)) << "\n";
+        }
+        if (checkpoints && this->checkpoint_due()){
+            this->write_checkpoint(CheckpointMethod::greedy, [&](std::ostream& stream){
+                write_binary(stream, this->beam_width);
+                write_binary(stream, (int) beam.size());
+                for (MCM& state : beam){
+                    write_binary(stream, state);
+                }
+                write_binary(stream, this->full_dendrogram);
+                this->dendrogram.save(stream);
+            });
         }
     }
     // Output file
@@ -163,4 +426,17 @@ void MCMSearch::hierarchical_merging(){
         *this->output_file << "\nStop merging \n";
         *this->output_file << "------------ \n\n";
     }
-}
\ No newline at end of file
+}
+
+double merge_gain_bound(Data& data, __uint128_t component_i, __uint128_t component_j, double log_ev_i, double log_ev_j){
+    int r_i = bit_count(component_i);
+    int r_j = bit_count(component_j);
+    double prefactor_i = data.calc_log_ev_prefactor(r_i);
+    double prefactor_j = data.calc_log_ev_prefactor(r_j);
+    // The datapoint contribution is a sum of lgamma(alpha * k + 1/2) - log(pi)/2 over the bins of the histogram, which is superadditive in k.
+    // The histogram of the merged component splits the bins of both histograms, so its contribution is at most the smallest of both.
+    double data_term = std::max(log_ev_i - prefactor_i, log_ev_j - prefactor_j);
+    double bound = data.calc_log_ev_prefactor(r_i + r_j) - prefactor_i - prefactor_j - data_term;
+    // Margin for rounding errors such that the bound is never below the calculated gain
+    return bound + 1e-9 * (fabs(log_ev_i) + fabs(log_ev_j) + 1);
+}
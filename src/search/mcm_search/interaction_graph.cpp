@@ -0,0 +1,152 @@
+#include "search/mcm_search/interaction_graph.h"
+#include "utilities/parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    // Mutual information of a pair from its joint counts and the counts of both variables
+    double mutual_information_from_counts(const std::vector<double>& joint, const std::vector<double>& counts_i, const std::vector<double>& counts_j, double N, int q){
+        double mi = 0;
+        for (int a = 0; a < q; a++){
+            for (int b = 0; b < q; b++){
+                double count = joint[a * q + b];
+                if (count > 0){
+                    mi += count / N * log(count * N / (counts_i[a] * counts_j[b]));
+                }
+            }
+        }
+        return mi / log(q);
+    }
+}
+
+std::vector<double> calc_mutual_information(Data& data, int n_threads){
+    int n = data.n;
+    int q = data.q;
+    double N = data.N;
+    std::vector<double> mutual_information(n * n, 0);
+
+    if (q == 2){
+        // Number of datapoints for which both variables are 1 (popcounts of the bit planes)
+        std::vector<unsigned long long> ones(n, 0);
+        std::vector<unsigned long long> both(n * n, 0);
+
+        // The datapoints are processed in blocks to bound the memory of the bit planes
+        const int block_words = 4096;
+        std::vector<std::vector<uint64_t>> planes(n, std::vector<uint64_t>(block_words));
+        size_t index = 0;
+        unsigned int remaining = (data.N_unique > 0) ? data.dataset[0].second : 0;
+        while (index < data.dataset.size()){
+            for (std::vector<uint64_t>& plane : planes){std::fill(plane.begin(), plane.end(), 0);}
+            // Fill the planes with the datapoints (repeated as often as they occur)
+            long long position = 0;
+            while (index < data.dataset.size() && position < 64LL * block_words){
+                __uint128_t state = data.dataset[index].first[0];
+                unsigned int n_copies = std::min((long long) remaining, 64LL * block_words - position);
+                for (int v = 0; v < n; v++){
+                    if (! ((state >> v) & 1)){continue;}
+                    for (long long p = position; p < position + n_copies; p++){
+                        planes[v][p / 64] |= (uint64_t) 1 << (p % 64);
+                    }
+                }
+                position += n_copies;
+                remaining -= n_copies;
+                if (remaining == 0){
+                    index++;
+                    if (index < data.dataset.size()){remaining = data.dataset[index].second;}
+                }
+            }
+            int n_words = (position + 63) / 64;
+            parallel_for(n, n_threads, [&](int i, int thread){
+                for (int w = 0; w < n_words; w++){
+                    ones[i] += __builtin_popcountll(planes[i][w]);
+                }
+                for (int j = i+1; j < n; j++){
+                    unsigned long long count = 0;
+                    for (int w = 0; w < n_words; w++){
+                        count += __builtin_popcountll(planes[i][w] & planes[j][w]);
+                    }
+                    both[i * n + j] += count;
+                }
+            });
+        }
+        parallel_for(n, n_threads, [&](int i, int thread){
+            std::vector<double> counts_i = {N - ones[i], (double) ones[i]};
+            std::vector<double> joint(4);
+            for (int j = i+1; j < n; j++){
+                std::vector<double> counts_j = {N - ones[j], (double) ones[j]};
+                joint[3] = both[i * n + j];
+                joint[2] = ones[i] - joint[3];
+                joint[1] = ones[j] - joint[3];
+                joint[0] = N - joint[1] - joint[2] - joint[3];
+                mutual_information[i * n + j] = mutual_information_from_counts(joint, counts_i, counts_j, N, q);
+                mutual_information[j * n + i] = mutual_information[i * n + j];
+            }
+        });
+    }
+    else {
+        // Value of every variable in every unique datapoint
+        std::vector<int> values(data.N_unique * n, 0);
+        for (int d = 0; d < data.N_unique; d++){
+            const std::vector<__uint128_t>& state = data.dataset[d].first;
+            for (int v = 0; v < n; v++){
+                for (int b = 0; b < data.n_ints; b++){
+                    values[d * n + v] += ((state[b] >> v) & 1) << b;
+                }
+            }
+        }
+        // Joint counts of every pair in a q x q table
+        parallel_for(n, n_threads, [&](int i, int thread){
+            std::vector<double> counts_i(q, 0);
+            for (int d = 0; d < data.N_unique; d++){
+                counts_i[values[d * n + i]] += data.dataset[d].second;
+            }
+            std::vector<double> counts_j(q);
+            std::vector<double> joint(q * q);
+            for (int j = i+1; j < n; j++){
+                std::fill(counts_j.begin(), counts_j.end(), 0);
+                std::fill(joint.begin(), joint.end(), 0);
+                for (int d = 0; d < data.N_unique; d++){
+                    counts_j[values[d * n + j]] += data.dataset[d].second;
+                    joint[values[d * n + i] * q + values[d * n + j]] += data.dataset[d].second;
+                }
+                mutual_information[i * n + j] = mutual_information_from_counts(joint, counts_i, counts_j, N, q);
+                mutual_information[j * n + i] = mutual_information[i * n + j];
+            }
+        });
+    }
+    return mutual_information;
+}
+
+std::vector<__uint128_t> build_interaction_graph(const std::vector<double>& mutual_information, int n, int k){
+    std::vector<__uint128_t> graph(n, 0);
+    std::vector<int> others;
+    for (int i = 0; i < n; i++){
+        others.clear();
+        for (int j = 0; j < n; j++){
+            if (j != i){others.push_back(j);}
+        }
+        // Variables with the largest mutual information first
+        int n_neighbours = std::min(k, (int) others.size());
+        std::partial_sort(others.begin(), others.begin() + n_neighbours, others.end(), [&](int a, int b){
+            if (mutual_information[i * n + a] != mutual_information[i * n + b]){
+                return mutual_information[i * n + a] > mutual_information[i * n + b];
+            }
+            return a < b;
+        });
+        for (int m = 0; m < n_neighbours; m++){
+            graph[i] |= (__uint128_t) 1 << others[m];
+            graph[others[m]] |= (__uint128_t) 1 << i;
+        }
+    }
+    return graph;
+}
+
+__uint128_t neighbourhood(const std::vector<__uint128_t>& graph, __uint128_t component){
+    __uint128_t neighbours = 0;
+    for (int v = 0; component; v++, component >>= 1){
+        if (component & 1){neighbours |= graph[v];}
+    }
+    return neighbours;
+}
@@ -1,4 +1,11 @@
 #include "search/mcm_search/mcm_search.h"
+#include "search/mcm_search/exhaustive.h"
+#include "search/mcm_search/tempering.h"
+
+#include <sstream>
+
+// Identifies a checkpoint file and the version of its layout
+static const std::string CHECKPOINT_MAGIC = "MCMCKPT2";
 
 /**************
 * Constructor *
@@ -9,6 +16,38 @@ MCMSearch::MCMSearch() : mcm_in(1), mcm_out(1) {
     this->SA_max_iter = 50000;
     this->SA_T0 = 100;
     this->SA_update_schedule = 100;
+    this->SA_batch_size = 1;
+    this->SA_schedule = CoolingSchedule::logarithmic;
+    this->SA_cooling_rate = 0.99;
+    this->SA_min_temp = 0.01;
+    this->SA_target_acceptance = 0.1;
+    this->SA_max_no_improve = 10000;
+    this->SA_reheats = 0;
+    // Default settings for PT
+    this->PT_n_replicas = 8;
+    this->PT_min_temp = 1;
+    this->PT_max_temp = 100;
+    this->PT_swap_interval = 100;
+    // Default settings for all searches
+    this->n_threads = 1;
+    this->top_k = 0;
+    this->max_component_size = 0;
+    this->beam_width = 1;
+    this->full_dendrogram = false;
+    this->merge_pruning = true;
+    this->interaction_neighbours = 0;
+    this->polish_size = 12;
+    this->multilevel_group_size = 4;
+    this->multilevel_coarse_search = "greedy";
+    this->multistart_restarts = 16;
+    this->multistart_patience = 0;
+    this->sampling_chains = 4;
+    this->sampling_iter = 100000;
+    this->sampling_burn_in = 10000;
+    // Checkpoints are disabled by default
+    this->checkpoint_interval = 600;
+    // Random seed unless a seed is given
+    this->set_seed(random_seed());
 }
 
 /*****************
@@ -17,7 +56,7 @@ MCMSearch::MCMSearch() : mcm_in(1), mcm_out(1) {
 
 MCM MCMSearch::get_mcm_in() {
     // Check if a search has occured
-    if (! this->log_evidence_trajectory.size()){
+    if (! this->mcm_out.optimized){
         throw std::runtime_error("No search has been ran yet.");
     }
     if (this->exhaustive){
@@ -28,7 +67,7 @@ MCM MCMSearch::get_mcm_in() {
 
 MCM MCMSearch::get_mcm_out() {
     // Check if a search has occured
-    if (! this->log_evidence_trajectory.size()){
+    if (! this->mcm_out.optimized){
         throw std::runtime_error("No search has been ran yet.");
     }
     return this->mcm_out;
@@ -41,8 +80,8 @@ void MCMSearch::set_SA_max_iter(int n_iter) {
     this->SA_max_iter = n_iter;
 }
 
-void MCMSearch::set_SA_init_temp(int temp) {
-    if (temp < 1) {
+void MCMSearch::set_SA_init_temp(double temp) {
+    if (temp <= 0) {
         throw std::invalid_argument("The initial annealing temperature should be positive.");
     }
     this->SA_T0 = temp;
@@ -55,17 +94,390 @@ void MCMSearch::set_SA_update_schedule(int n_iter) {
     this->SA_update_schedule = n_iter;
 }
 
+void MCMSearch::set_SA_batch_size(int batch_size) {
+    if (batch_size < 1) {
+        throw std::invalid_argument("The number of moves proposed at once should be a positive number.");
+    }
+    this->SA_batch_size = batch_size;
+}
+
+void MCMSearch::set_SA_schedule(const std::string& schedule) {
+    if (schedule == "logarithmic"){this->SA_schedule = CoolingSchedule::logarithmic;}
+    else if (schedule == "geometric"){this->SA_schedule = CoolingSchedule::geometric;}
+    else if (schedule == "linear"){this->SA_schedule = CoolingSchedule::linear;}
+    else if (schedule == "adaptive"){this->SA_schedule = CoolingSchedule::adaptive;}
+    else {
+        throw std::invalid_argument("Invalid cooling schedule. Options are 'logarithmic', 'geometric', 'linear' or 'adaptive'.");
+    }
+}
+
+std::string MCMSearch::get_SA_schedule() {
+    switch (this->SA_schedule){
+        case CoolingSchedule::logarithmic: return "logarithmic";
+        case CoolingSchedule::geometric: return "geometric";
+        case CoolingSchedule::linear: return "linear";
+        case CoolingSchedule::adaptive: return "adaptive";
+    }
+    return "logarithmic";
+}
+
+void MCMSearch::set_SA_cooling_rate(double rate) {
+    if (rate <= 0 || rate >= 1) {
+        throw std::invalid_argument("The cooling rate should be between 0 and 1.");
+    }
+    this->SA_cooling_rate = rate;
+}
+
+void MCMSearch::set_SA_min_temp(double temp) {
+    if (temp <= 0) {
+        throw std::invalid_argument("The minimum annealing temperature should be positive.");
+    }
+    this->SA_min_temp = temp;
+}
+
+void MCMSearch::set_SA_target_acceptance(double rate) {
+    if (rate <= 0 || rate >= 1) {
+        throw std::invalid_argument("The target acceptance rate should be between 0 and 1.");
+    }
+    this->SA_target_acceptance = rate;
+}
+
+void MCMSearch::set_SA_max_no_improve(int n_iter) {
+    if (n_iter < 1) {
+        throw std::invalid_argument("The number of iterations without improvement should be a positive number.");
+    }
+    this->SA_max_no_improve = n_iter;
+}
+
+void MCMSearch::set_SA_reheats(int n_reheats) {
+    if (n_reheats < 0) {
+        throw std::invalid_argument("The number of reheats should be a non-negative number.");
+    }
+    this->SA_reheats = n_reheats;
+}
+
 std::vector<double> MCMSearch::get_log_evidence_trajectory(){
-    if (! this->log_evidence_trajectory.size()){
+    return *this->get_log_evidence_trajectory_ptr();
+}
+
+std::shared_ptr<std::vector<double>> MCMSearch::get_log_evidence_trajectory_ptr(){
+    if (! this->mcm_out.optimized){
         throw std::runtime_error("No search has been ran.");
     }
-    return this->log_evidence_trajectory;
+    return this->trajectory.get_values();
+}
+
+std::vector<unsigned long long> MCMSearch::get_log_evidence_trajectory_steps(){
+    if (! this->mcm_out.optimized){
+        throw std::runtime_error("No search has been ran.");
+    }
+    return this->trajectory.get_steps();
+}
+
+std::vector<std::pair<double, unsigned long long>> MCMSearch::get_log_evidence_histogram(){
+    if (! this->mcm_out.optimized){
+        throw std::runtime_error("No search has been ran.");
+    }
+    return this->trajectory.get_histogram();
+}
+
+TrajectorySummary MCMSearch::get_log_evidence_summary(){
+    if (! this->mcm_out.optimized){
+        throw std::runtime_error("No search has been ran.");
+    }
+    return this->trajectory.get_summary();
+}
+
+void MCMSearch::set_seed(uint64_t seed) {
+    this->seed = seed;
+    this->generator.seed(seed);
+}
+
+RandomGenerator MCMSearch::next_stream() {
+    RandomGenerator stream = this->generator;
+    this->generator.jump();
+    return stream;
+}
+
+void MCMSearch::set_n_threads(int n_threads) {
+    if (n_threads < 1) {
+        throw std::invalid_argument("The number of threads should be a positive number.");
+    }
+    this->n_threads = n_threads;
+}
+
+void MCMSearch::set_top_k(int k) {
+    if (k < 0) {
+        throw std::invalid_argument("The number of best partitions to keep should be a non-negative number.");
+    }
+    this->top_k = k;
+}
+
+MCM MCMSearch::get_dendrogram_cut(int n_merges) {
+    MCM mcm = this->dendrogram.cut(n_merges);
+    place_empty_entries_last(mcm.partition);
+    place_empty_entries_last(mcm.log_ev_per_icc);
+    mcm.optimized = true;
+    return mcm;
+}
+
+void MCMSearch::set_interaction_neighbours(int k) {
+    if (k < 0) {
+        throw std::invalid_argument("The number of neighbours in the interaction graph should be a non-negative number.");
+    }
+    this->interaction_neighbours = k;
+}
+
+void MCMSearch::build_interaction_graph() {
+    if (this->interaction_graph_given){return;}
+    this->interaction_graph.clear();
+    this->mutual_information.clear();
+    // With n-1 neighbours, all pairs interact
+    if (this->interaction_neighbours == 0 || this->interaction_neighbours >= this->data->n - 1){return;}
+    this->mutual_information = calc_mutual_information(*this->data, this->n_threads);
+    this->interaction_graph = ::build_interaction_graph(this->mutual_information, this->data->n, this->interaction_neighbours);
+}
+
+__uint128_t MCMSearch::neighbourhood(__uint128_t component) {
+    // Without a graph, every variable is a neighbour
+    if (this->interaction_graph.empty()){return ~((__uint128_t) 0);}
+    return ::neighbourhood(this->interaction_graph, component);
+}
+
+void MCMSearch::set_beam_width(int width) {
+    if (width < 1) {
+        throw std::invalid_argument("The beam width should be a positive number.");
+    }
+    this->beam_width = width;
+}
+
+void MCMSearch::set_max_component_size(int max_size) {
+    if (max_size < 0) {
+        throw std::invalid_argument("The maximum number of variables in a component should be a non-negative number.");
+    }
+    this->max_component_size = max_size;
+}
+
+std::vector<MCM> MCMSearch::get_top_mcms() {
+    if (! this->top_mcms.size()){
+        throw std::runtime_error("No exhaustive search with top_k > 0 has been ran.");
+    }
+    return this->top_mcms;
+}
+
+void MCMSearch::set_checkpoint(const std::string& file_name, double interval) {
+    if (interval < 0) {
+        throw std::invalid_argument("The interval between two checkpoints should be a non-negative number.");
+    }
+    this->checkpoint_file = file_name;
+    this->checkpoint_interval = interval;
+}
+
+MCM MCMSearch::resume_search(Data& data, const std::string& checkpoint_file, std::string file_name) {
+    StopScope scope(this->stop_condition);
+    // Make sure that the last checkpoint of this object is completely written
+    if (this->checkpoint_writer){
+        this->checkpoint_writer->wait();
+    }
+    std::ifstream stream(checkpoint_file, std::ios::binary);
+    if (! stream.is_open()){
+        throw std::invalid_argument("Could not open the checkpoint file.");
+    }
+    std::string magic(CHECKPOINT_MAGIC.size(), ' ');
+    stream.read(&magic[0], magic.size());
+    if (! stream || magic != CHECKPOINT_MAGIC){
+        throw std::invalid_argument("The given file is not a checkpoint of a search.");
+    }
+    int method;
+    read_binary(stream, method);
+
+    // The checkpoint can only be resumed on the same dataset
+    int n, q, N, N_unique, N_synthetic;
+    read_binary(stream, n);
+    read_binary(stream, q);
+    read_binary(stream, N);
+    read_binary(stream, N_unique);
+    read_binary(stream, N_synthetic);
+    if (n != data.n || q != data.q || N != data.N || N_unique != data.N_unique || N_synthetic != data.N_synthetic){
+        throw std::invalid_argument("The checkpoint was created for a different dataset.");
+    }
+    this->data = &data;
+
+    // Settings of the interrupted search
+    read_binary(stream, this->SA_max_iter);
+    read_binary(stream, this->SA_T0);
+    read_binary(stream, this->SA_update_schedule);
+    read_binary(stream, this->SA_schedule);
+    read_binary(stream, this->SA_cooling_rate);
+    read_binary(stream, this->SA_min_temp);
+    read_binary(stream, this->SA_target_acceptance);
+    read_binary(stream, this->SA_reheats);
+    read_binary(stream, this->top_k);
+    read_binary(stream, this->interaction_neighbours);
+    read_binary(stream, this->interaction_graph);
+    read_binary(stream, this->mutual_information);
+
+    // State shared by all search methods
+    read_binary(stream, this->mcm_in);
+    read_binary(stream, this->mcm_out);
+    read_binary(stream, this->cache_log_name);
+    read_binary(stream, this->n_cache_logged);
+    if (this->cache_log_name.empty()){
+        this->evidence_storage.clear();
+    }
+    else {
+        // Only the entries that are inserted from now on are added to the log at the next checkpoint
+        read_cache_log(this->cache_log_name, this->n_cache_logged, this->evidence_storage);
+        this->evidence_storage.track_insertions();
+    }
+    read_binary(stream, this->evidence_storage_es);
+    this->trajectory.load(stream);
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->exhaustive = (method == (int) CheckpointMethod::exhaustive);
+
+    // Continue writing to the output file of the interrupted search
+    if (!file_name.empty()){
+        this->output_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name, std::ios::app));
+        if (! this->output_file->is_open()){
+            std::cerr <<"Error: could not open the given output file.";
+        }
+        *this->output_file << "\nResumed from checkpoint \n\n";
+    }
+    this->last_checkpoint = std::chrono::steady_clock::now();
+
+    switch ((CheckpointMethod) method){
+        case CheckpointMethod::exhaustive: {
+            ES_state state;
+            read_binary(stream, state);
+            return this->run_exhaustive(state);
+        }
+        case CheckpointMethod::greedy: {
+            int beam_size;
+            read_binary(stream, this->beam_width);
+            read_binary(stream, beam_size);
+            std::vector<MCM> beam(beam_size, MCM(n));
+            for (MCM& mcm : beam){
+                read_binary(stream, mcm);
+            }
+            read_binary(stream, this->full_dendrogram);
+            this->dendrogram.load(stream);
+            return this->run_greedy(file_name, beam);
+        }
+        case CheckpointMethod::divide_and_conquer: {
+            std::vector<int> to_split;
+            int first_empty;
+            read_binary(stream, to_split);
+            read_binary(stream, first_empty);
+            return this->run_division(to_split, first_empty, file_name);
+        }
+        case CheckpointMethod::simulated_annealing: {
+            MCM mcm_tmp(n);
+            SA_settings settings(this->SA_T0, mcm_tmp.partition);
+            read_binary(stream, mcm_tmp);
+            read_binary(stream, settings);
+            settings.index.build(mcm_tmp.partition);
+            return this->run_annealing(mcm_tmp, settings, file_name);
+        }
+        case CheckpointMethod::parallel_tempering: {
+            PT_state state;
+            read_binary(stream, this->PT_n_replicas);
+            read_binary(stream, this->PT_min_temp);
+            read_binary(stream, this->PT_max_temp);
+            read_binary(stream, this->PT_swap_interval);
+            read_binary(stream, state);
+            return this->run_tempering(state, file_name);
+        }
+    }
+    throw std::invalid_argument("The given file is not a checkpoint of a search.");
 }
 
 /******************
 * Private methods *
 ******************/
 
+bool MCMSearch::checkpoint_due(){
+    if (this->checkpoint_file.empty()){
+        return false;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->last_checkpoint;
+    return elapsed.count() >= this->checkpoint_interval;
+}
+
+void MCMSearch::write_checkpoint(CheckpointMethod method, const std::function<void(std::ostream&)>& write_state, std::mutex* state_mutex){
+    // Serialize in memory such that the search can continue while the file is written
+    std::ostringstream stream(std::ios::binary);
+    stream.write(CHECKPOINT_MAGIC.data(), CHECKPOINT_MAGIC.size());
+    write_binary(stream, (int) method);
+
+    write_binary(stream, this->data->n);
+    write_binary(stream, this->data->q);
+    write_binary(stream, this->data->N);
+    write_binary(stream, this->data->N_unique);
+    write_binary(stream, this->data->N_synthetic);
+
+    write_binary(stream, this->SA_max_iter);
+    write_binary(stream, this->SA_T0);
+    write_binary(stream, this->SA_update_schedule);
+    write_binary(stream, this->SA_schedule);
+    write_binary(stream, this->SA_cooling_rate);
+    write_binary(stream, this->SA_min_temp);
+    write_binary(stream, this->SA_target_acceptance);
+    write_binary(stream, this->SA_reheats);
+    write_binary(stream, this->top_k);
+    write_binary(stream, this->interaction_neighbours);
+    write_binary(stream, this->interaction_graph);
+    write_binary(stream, this->mutual_information);
+
+    write_binary(stream, this->mcm_in);
+    write_binary(stream, this->mcm_out);
+
+    // The entries of the evidence cache are logged next to the checkpoint such that each checkpoint only writes the new entries
+    std::vector<CheckpointLog> logs(2);
+    CheckpointLog& cache_log = logs[0];
+    cache_log.file_name = this->checkpoint_file + ".cache";
+    std::vector<std::pair<__uint128_t, double>> entries;
+    if (cache_log.file_name != this->cache_log_name || ! this->evidence_storage.is_tracking()){
+        // The log is rewritten with all entries at the first checkpoint of a search
+        this->evidence_storage.track_insertions();
+        entries = this->evidence_storage.entries();
+        cache_log.restart = true;
+        this->cache_log_name = cache_log.file_name;
+        this->n_cache_logged = 0;
+    }
+    else {
+        entries = this->evidence_storage.take_insertions();
+    }
+    cache_log.records = cache_log_records(entries);
+    this->n_cache_logged += entries.size();
+    write_binary(stream, this->cache_log_name);
+    write_binary(stream, this->n_cache_logged);
+    write_binary(stream, this->evidence_storage_es);
+
+    {
+        std::unique_lock<std::mutex> lock;
+        if (state_mutex){
+            lock = std::unique_lock<std::mutex>(*state_mutex);
+        }
+        // The same holds for the stored values of the trajectory
+        logs[1].file_name = this->checkpoint_file + ".trajectory";
+        this->trajectory.save(stream, &logs[1]);
+
+        // State specific to the search method
+        write_state(stream);
+
+        if (this->output_file){
+            this->output_file->flush();
+        }
+        this->last_checkpoint = std::chrono::steady_clock::now();
+    }
+    if (! this->checkpoint_writer){
+        this->checkpoint_writer = std::unique_ptr<CheckpointWriter>(new CheckpointWriter());
+    }
+    this->checkpoint_writer->write(this->checkpoint_file, stream.str(), std::move(logs));
+}
+
+
 double MCMSearch::get_log_ev(std::vector<__uint128_t> partition){
     double log_ev = 0;
     // Iterate over all the ICCs in the partition
@@ -82,18 +494,9 @@ double MCMSearch::get_log_ev_icc(__uint128_t component){
     double log_ev;
     // Check if it evidence for this component is already calculated
     if (!this->exhaustive){
-        // Not an exhaustive search -> the storage is a map
-        std::map<__uint128_t, double>::iterator result = this->evidence_storage.find(component);
-        if (result == this->evidence_storage.end()){
-            // Not found -> needs to be calculated
-            log_ev = this->data->calc_log_ev_icc(component);
-            // Store the result
-            this->evidence_storage[component] = log_ev;
-        }
-        else{
-            // Retrieve value from storage
-            log_ev = this->evidence_storage[component];
-        }
+        // Not an exhaustive search -> the storage is a (thread-safe) hash map, calculated if it is not found
+        EvidenceCache& storage = this->shared_evidence_storage ? *this->shared_evidence_storage : this->evidence_storage;
+        log_ev = storage.get(component, *this->data);
     }
     else{
         // Exhaustive search -> Search for value in storage, which is a vector
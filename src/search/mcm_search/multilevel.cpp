@@ -0,0 +1,245 @@
+#include "search/mcm_search/mcm_search.h"
+
+#include <algorithm>
+#include <set>
+
+MCM MCMSearch::multilevel_search(Data& data, std::string file_name){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    this->data = &data;
+    // The coarsest level starts from the independent model
+    this->mcm_in = MCM(n, "independent");
+    this->mcm_out = this->mcm_in;
+
+    // Clear from previous search
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->exhaustive = false;
+    this->build_interaction_graph();
+
+    // Write the settings to the output file
+    if (!file_name.empty()){
+        this->output_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name));
+        if (! this->output_file->is_open()){
+            std::cerr <<"Error: could not open the given output file.";
+        }
+        *this->output_file << "=========================== \n";
+        *this->output_file << "Multilevel Search Procedure \n";
+        *this->output_file << "=========================== \n\n";
+
+        *this->output_file << "Data statistics \n";
+        *this->output_file << "--------------- \n\n";
+
+        *this->output_file << "Number of variables: " << data.n << "\n";
+        *this->output_file << "Number of states per variable: " << data.q << "\n";
+        *this->output_file << "Number of datapoints: " << data.N << "\n";
+        *this->output_file << "Number of synthetic datapoints: " << data.N_synthetic << "\n";
+        *this->output_file << "Number of unique datapoint: " << data.N_unique << "\n";
+        *this->output_file << "Entropy of the data: " << data.entropy() << " q-its \n\n";
+
+        *this->output_file << "Start coarsening \n";
+        *this->output_file << "---------------- \n\n";
+    }
+
+    // Coarsening: strongly dependent groups of variables are combined level by level
+    std::vector<double> mutual_information = this->mutual_information;
+    if (mutual_information.empty()){
+        mutual_information = calc_mutual_information(data, this->n_threads);
+    }
+    std::vector<__uint128_t> groups(n);
+    for (int v = 0; v < n; v++){
+        groups[v] = (__uint128_t) 1 << v;
+    }
+    this->coarsening_levels.assign(1, groups);
+    while (true){
+        groups = this->coarsen(this->coarsening_levels.back(), mutual_information);
+        if (groups.empty()){break;}
+        this->coarsening_levels.push_back(groups);
+        if (this->output_file){
+            *this->output_file << "Level " << this->coarsening_levels.size() - 1 << " \t Number of groups: " << groups.size() << "\n";
+        }
+    }
+    int n_levels = this->coarsening_levels.size();
+
+    // Every group of the coarsest level is a component of the starting partition
+    std::vector<__uint128_t>& partition = this->mcm_out.partition;
+    std::vector<double>& log_ev_per_icc = this->mcm_out.log_ev_per_icc;
+    partition.assign(n, 0);
+    log_ev_per_icc.assign(n, 0);
+    std::copy(this->coarsening_levels.back().begin(), this->coarsening_levels.back().end(), partition.begin());
+    this->mcm_out.n_comp = this->coarsening_levels.back().size();
+    for (int i = 0; i < this->mcm_out.n_comp; i++){
+        log_ev_per_icc[i] = this->get_log_ev_icc(partition[i]);
+    }
+    this->mcm_out.log_ev = this->get_log_ev(partition);
+
+    // Store log_ev of starting point
+    this->trajectory.record(this->mcm_out.log_ev);
+
+    if (this->output_file){
+        *this->output_file << "\nCoarsest partition \n";
+        *this->output_file << "------------------ \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+    }
+
+    // Search on the coarsest level, the variables of a group are never separated
+    // (the greedy merging only combines components and the annealing splits, merges and switches whole groups)
+    if (this->multilevel_coarse_search == "annealing"){
+        if (this->output_file){
+            *this->output_file << "Start annealing \n";
+            *this->output_file << "--------------- \n\n";
+        }
+        MCM mcm_tmp = this->mcm_out;
+        SA_settings settings(this->SA_T0, mcm_tmp.partition);
+        settings.index.build(mcm_tmp.partition, this->coarsening_levels.back());
+        settings.max_no_improve = this->SA_max_no_improve;
+        settings.generator = this->next_stream();
+        this->annealing(mcm_tmp, settings);
+    }
+    else if (this->output_file){
+        *this->output_file << "Start merging \n";
+        *this->output_file << "------------- \n\n";
+    }
+    this->dendrogram.start(this->mcm_out);
+    this->hierarchical_merging();
+    // The merge tree doesn't describe the refined partition
+    this->dendrogram.clear();
+
+    if (this->output_file){
+        *this->output_file << "Start refining \n";
+        *this->output_file << "-------------- \n\n";
+    }
+    // Uncoarsening: the parts of the groups of every level are moved between the components, from the coarsest to the finest level
+    // Only moves are used (as in the refinement of graph partitioners), swaps cost a number of evaluations that is quadratic in the number of units
+    for (int level = n_levels - 1; level >= 0; level--){
+        std::vector<__uint128_t> units;
+        for (__uint128_t group : this->coarsening_levels[level]){
+            for (int i = 0; i < n; i++){
+                if (group & partition[i]){units.push_back(group & partition[i]);}
+            }
+        }
+        this->refine_partition(units, false);
+
+        if (this->output_file){
+            *this->output_file << "Level " << level << " \t Log-evidence (q-its/datapoint): " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << "\n";
+        }
+    }
+
+    place_empty_entries_last(this->mcm_out.partition);
+    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Write results to the output file
+    if (!file_name.empty()){
+        double max_log_likelihood = data.calc_log_likelihood(this->mcm_out.partition);
+
+        *this->output_file << "\nFinal partition \n";
+        *this->output_file << "----------------- \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n";
+        *this->output_file << "Max-Log-likelihood: " << max_log_likelihood << " = " << max_log_likelihood / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+        this->output_file.reset();
+    }
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+
+    return this->mcm_out;
+}
+
+std::vector<__uint128_t> MCMSearch::coarsen(const std::vector<__uint128_t>& groups, const std::vector<double>& mutual_information){
+    int n = this->data->n;
+    int m = groups.size();
+
+    // Pairs of groups that didn't increase the evidence when combined are not proposed again
+    std::set<std::pair<__uint128_t, __uint128_t>> rejected;
+    while (true){
+        // Weight of two groups is the total mutual information between their variables (only interacting groups that fit in the maximum size)
+        std::vector<std::pair<double, std::pair<int, int>>> edges;
+        for (int a = 0; a < m; a++){
+            __uint128_t neighbours = this->neighbourhood(groups[a]);
+            for (int b = a+1; b < m; b++){
+                if ((groups[b] & neighbours) == 0){continue;}
+                if (bit_count(groups[a]) + bit_count(groups[b]) > this->multilevel_group_size){continue;}
+                if (rejected.count(std::make_pair(groups[a], groups[b]))){continue;}
+                double weight = 0;
+                for (int u = 0; u < n; u++){
+                    if (! ((groups[a] >> u) & 1)){continue;}
+                    for (int v = 0; v < n; v++){
+                        if ((groups[b] >> v) & 1){weight += mutual_information[u * n + v];}
+                    }
+                }
+                if (weight > 0){edges.push_back(std::make_pair(weight, std::make_pair(a, b)));}
+            }
+        }
+        if (edges.empty()){return std::vector<__uint128_t>();}
+
+        // Heavy-edge matching: the heaviest edges are matched first (ties on the smallest indices)
+        std::sort(edges.begin(), edges.end(), [](const std::pair<double, std::pair<int, int>>& x, const std::pair<double, std::pair<int, int>>& y){
+            if (x.first != y.first){return x.first > y.first;}
+            return x.second < y.second;
+        });
+        std::vector<int> match(m, -1);
+        std::vector<std::pair<int, int>> matched;
+        for (const std::pair<double, std::pair<int, int>>& edge : edges){
+            int a = edge.second.first;
+            int b = edge.second.second;
+            if (match[a] >= 0 || match[b] >= 0){continue;}
+            match[a] = b;
+            match[b] = a;
+            matched.push_back(edge.second);
+        }
+
+        // Only matched groups whose combination increases the evidence are combined (evaluated in parallel)
+        std::vector<char> accepted(matched.size());
+        parallel_for(matched.size(), this->n_threads, [&](int p, int thread){
+            __uint128_t group_a = groups[matched[p].first];
+            __uint128_t group_b = groups[matched[p].second];
+            double gain = this->get_log_ev_icc(group_a + group_b) - this->get_log_ev_icc(group_a) - this->get_log_ev_icc(group_b);
+            accepted[p] = (gain > 0);
+        });
+        bool combined = false;
+        for (size_t p = 0; p < matched.size(); p++){
+            if (accepted[p]){
+                combined = true;
+                continue;
+            }
+            match[matched[p].first] = -1;
+            match[matched[p].second] = -1;
+            rejected.insert(std::make_pair(groups[matched[p].first], groups[matched[p].second]));
+        }
+        if (! combined){continue;}
+
+        // Groups of the next level in the order of their first group
+        std::vector<__uint128_t> coarse_groups;
+        for (int a = 0; a < m; a++){
+            if (match[a] < 0){coarse_groups.push_back(groups[a]);}
+            else if (match[a] > a){coarse_groups.push_back(groups[a] + groups[match[a]]);}
+        }
+        return coarse_groups;
+    }
+}
+
+void MCMSearch::set_multilevel_group_size(int max_size){
+    if (max_size < 1){
+        throw std::invalid_argument("The maximum number of variables in a group of the multilevel search should be a positive number.");
+    }
+    this->multilevel_group_size = max_size;
+}
+
+void MCMSearch::set_multilevel_coarse_search(const std::string& method){
+    if (method != "greedy" && method != "annealing"){
+        throw std::invalid_argument("Invalid search method for the coarsest level. Options are 'greedy' or 'annealing'.");
+    }
+    this->multilevel_coarse_search = method;
+}
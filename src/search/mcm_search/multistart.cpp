@@ -0,0 +1,204 @@
+#include "search/mcm_search/mcm_search.h"
+
+#include <atomic>
+#include <mutex>
+
+MCM MCMSearch::multistart_search(Data& data, const std::string& method, std::string file_name){
+    StopScope scope(this->stop_condition);
+    if (method != "greedy" && method != "divide_and_conquer" && method != "annealing"){
+        throw std::invalid_argument("Invalid search method for the restarts. Options are 'greedy', 'divide_and_conquer' or 'annealing'.");
+    }
+    int n = data.n;
+    int n_restarts = this->multistart_restarts;
+    this->data = &data;
+
+    // Clear from previous search
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->coarsening_levels.clear();
+    this->exhaustive = false;
+    this->build_interaction_graph();
+
+    // Write the settings to the output file
+    if (!file_name.empty()){
+        this->output_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name));
+        if (! this->output_file->is_open()){
+            std::cerr <<"Error: could not open the given output file.";
+        }
+        *this->output_file << "============================ \n";
+        *this->output_file << "Multi-Start Search Procedure \n";
+        *this->output_file << "============================ \n\n";
+
+        *this->output_file << "Data statistics \n";
+        *this->output_file << "--------------- \n\n";
+
+        *this->output_file << "Number of variables: " << data.n << "\n";
+        *this->output_file << "Number of states per variable: " << data.q << "\n";
+        *this->output_file << "Number of datapoints: " << data.N << "\n";
+        *this->output_file << "Number of synthetic datapoints: " << data.N_synthetic << "\n";
+        *this->output_file << "Number of unique datapoint: " << data.N_unique << "\n";
+        *this->output_file << "Entropy of the data: " << data.entropy() << " q-its \n\n";
+
+        *this->output_file << "Search method of the restarts: " << method << "\n";
+        *this->output_file << "Number of restarts: " << n_restarts << "\n";
+        *this->output_file << "Number of repeats of the best result before stopping: " << this->multistart_patience << "\n\n";
+
+        *this->output_file << "Start restarts \n";
+        *this->output_file << "-------------- \n\n";
+    }
+
+    // Every restart has its own stream of random numbers, which also draws its starting partition
+    std::vector<RandomGenerator> streams;
+    std::vector<MCM> starts;
+    for (int r = 0; r < n_restarts; r++){
+        streams.push_back(this->next_stream());
+        starts.push_back(MCM(n, generate_random_partition(n, streams[r])));
+    }
+
+    // Every thread runs its restarts on a separate searcher with the same settings and the evidence cache of this searcher
+    int n_workers = std::min(this->n_threads, n_restarts);
+    std::vector<MCMSearch> workers;
+    for (int t = 0; t < n_workers; t++){
+        workers.push_back(this->create_worker());
+    }
+
+    // The results are taken in the order of the restarts, such that the early stopping doesn't depend on the number of threads
+    std::vector<MCM> results(n_restarts, MCM(n));
+    std::vector<char> done(n_restarts, 0);
+    int n_counted = 0;
+    int n_best = 0;
+    int best_restart = -1;
+    std::mutex mutex;
+    std::atomic<bool> stop(false);
+    parallel_for(n_restarts, n_workers, [&](int r, int thread){
+        if (stop){return;}
+        // Restarts that didn't start before the search was stopped are skipped (the first one always runs)
+        if (r > 0){
+            double best_log_ev = -DBL_MAX;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (best_restart >= 0){best_log_ev = results[best_restart].log_ev;}
+            }
+            if (this->stop_condition.requested(best_log_ev)){return;}
+        }
+        MCMSearch& worker = workers[thread];
+        worker.generator = streams[r];
+        MCM result(n);
+        if (method == "greedy"){
+            result = worker.greedy_search(data, &starts[r]);
+        }
+        else if (method == "divide_and_conquer"){
+            result = worker.divide_and_conquer(data, &starts[r]);
+        }
+        else {
+            result = worker.simulated_annealing(data, &starts[r]);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        results[r] = result;
+        done[r] = 1;
+        while (!stop && n_counted < n_restarts && done[n_counted]){
+            // Differences due to rounding count as the same value
+            double log_ev = results[n_counted].log_ev;
+            if (best_restart < 0 || log_ev > results[best_restart].log_ev + 1e-6){
+                best_restart = n_counted;
+                n_best = 1;
+            }
+            else if (log_ev > results[best_restart].log_ev - 1e-6){
+                n_best++;
+            }
+            n_counted++;
+            if (this->multistart_patience > 0 && n_best >= this->multistart_patience){
+                stop = true;
+            }
+        }
+    });
+
+    // Final evidence of every restart that was counted and the best value so far as trajectory
+    this->multistart_log_evidences.clear();
+    double best_log_ev = -DBL_MAX;
+    for (int r = 0; r < n_counted; r++){
+        this->multistart_log_evidences.push_back(results[r].log_ev);
+        best_log_ev = std::max(best_log_ev, results[r].log_ev);
+        this->trajectory.record(best_log_ev);
+
+        if (this->output_file){
+            *this->output_file << "Restart " << r << " \t Log-evidence (q-its/datapoint): " << results[r].log_ev / (data.N_synthetic * log(data.q)) << "\n";
+        }
+    }
+    this->mcm_in = starts[best_restart];
+    this->mcm_out = results[best_restart];
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Write results to the output file
+    if (!file_name.empty()){
+        double max_log_likelihood = data.calc_log_likelihood(this->mcm_out.partition);
+
+        *this->output_file << "\nFinal partition (restart " << best_restart << ") \n";
+        *this->output_file << "----------------- \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n";
+        *this->output_file << "Max-Log-likelihood: " << max_log_likelihood << " = " << max_log_likelihood / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+        this->output_file.reset();
+    }
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+
+    return this->mcm_out;
+}
+
+MCMSearch MCMSearch::create_worker(){
+    MCMSearch worker;
+    worker.SA_max_iter = this->SA_max_iter;
+    worker.SA_T0 = this->SA_T0;
+    worker.SA_update_schedule = this->SA_update_schedule;
+    worker.SA_schedule = this->SA_schedule;
+    worker.SA_cooling_rate = this->SA_cooling_rate;
+    worker.SA_min_temp = this->SA_min_temp;
+    worker.SA_target_acceptance = this->SA_target_acceptance;
+    worker.SA_max_no_improve = this->SA_max_no_improve;
+    worker.SA_reheats = this->SA_reheats;
+    worker.beam_width = this->beam_width;
+    worker.merge_pruning = this->merge_pruning;
+    worker.interaction_neighbours = this->interaction_neighbours;
+    // The graph of this search is used by all workers (they run on the same data)
+    worker.interaction_graph = this->interaction_graph;
+    worker.mutual_information = this->mutual_information;
+    worker.interaction_graph_given = true;
+    // The restarts are the parallel tasks, every restart runs on a single thread without trajectory or checkpoints
+    worker.n_threads = 1;
+    worker.trajectory.set_policy("off");
+    worker.shared_evidence_storage = &this->evidence_storage;
+    // The worker stops together with the search that created it
+    worker.stop_condition = this->stop_condition;
+    return worker;
+}
+
+std::vector<double> MCMSearch::get_multistart_log_evidences(){
+    if (this->multistart_log_evidences.empty()){
+        throw std::runtime_error("No multi-start search has been ran.");
+    }
+    return this->multistart_log_evidences;
+}
+
+void MCMSearch::set_multistart_restarts(int n_restarts){
+    if (n_restarts < 1){
+        throw std::invalid_argument("The number of restarts should be a positive number.");
+    }
+    this->multistart_restarts = n_restarts;
+}
+
+void MCMSearch::set_multistart_patience(int n_repeats){
+    if (n_repeats < 0){
+        throw std::invalid_argument("The number of repeats of the best result before stopping should be a non-negative number.");
+    }
+    this->multistart_patience = n_repeats;
+}
@@ -0,0 +1,238 @@
+#include "search/mcm_search/mcm_search.h"
+
+#include <algorithm>
+
+/**
+ * Divide the components of a partition into disjoint clusters of adjacent components.
+ * The two clusters with the largest total mutual information between their variables are combined first,
+ * as long as the total number of variables stays below the maximum size.
+ *
+ * @param partition             Partition as a vector of n integers representing the components.
+ * @param mutual_information    Matrix of n * n values obtained from calc_mutual_information.
+ * @param max_size              Maximum number of variables in a cluster.
+ *
+ * @return Indices of the components in every cluster that contains at least two variables.
+ */
+static std::vector<std::vector<int>> adjacent_clusters(const std::vector<__uint128_t>& partition, const std::vector<double>& mutual_information, int max_size){
+    int n = partition.size();
+
+    // Components that fit in a cluster
+    std::vector<std::vector<int>> clusters;
+    std::vector<int> size;
+    for (int i = 0; i < n; i++){
+        int r = bit_count(partition[i]);
+        if (r == 0 || r > max_size){continue;}
+        clusters.push_back(std::vector<int>(1, i));
+        size.push_back(r);
+    }
+    int c = clusters.size();
+
+    // Total mutual information between the variables of every pair of clusters
+    std::vector<double> weight(c * c, 0);
+    for (int a = 0; a < c; a++){
+        for (int b = a+1; b < c; b++){
+            for (int u = 0; u < n; u++){
+                if (! ((partition[clusters[a][0]] >> u) & 1)){continue;}
+                for (int v = 0; v < n; v++){
+                    if ((partition[clusters[b][0]] >> v) & 1){weight[a * c + b] += mutual_information[u * n + v];}
+                }
+            }
+            weight[b * c + a] = weight[a * c + b];
+        }
+    }
+
+    // Combine the clusters with the largest weight (ties on the smallest indices)
+    while (true){
+        double best_weight = 0;
+        int best_a = -1;
+        int best_b = -1;
+        for (int a = 0; a < c; a++){
+            if (clusters[a].empty()){continue;}
+            for (int b = a+1; b < c; b++){
+                if (clusters[b].empty() || size[a] + size[b] > max_size){continue;}
+                if (weight[a * c + b] > best_weight){
+                    best_weight = weight[a * c + b];
+                    best_a = a;
+                    best_b = b;
+                }
+            }
+        }
+        if (best_a < 0){break;}
+
+        clusters[best_a].insert(clusters[best_a].end(), clusters[best_b].begin(), clusters[best_b].end());
+        clusters[best_b].clear();
+        size[best_a] += size[best_b];
+        for (int x = 0; x < c; x++){
+            weight[best_a * c + x] += weight[best_b * c + x];
+            weight[x * c + best_a] = weight[best_a * c + x];
+        }
+        weight[best_a * c + best_a] = 0;
+    }
+
+    // A cluster with a single variable can't be improved
+    std::vector<std::vector<int>> result;
+    for (int a = 0; a < c; a++){
+        if (size[a] > 1){result.push_back(clusters[a]);}
+    }
+    return result;
+}
+
+MCM MCMSearch::polish(Data& data, MCM* init_mcm){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    // Initialize the mcm that is polished
+    if (!init_mcm){
+        // Default is the result of the previous search
+        if (!this->mcm_out.optimized){
+            throw std::runtime_error("No search has been run before, give the MCM that should be polished.");
+        }
+        this->mcm_in = this->mcm_out;
+    }
+    else {
+        this->mcm_in = *init_mcm;
+    }
+    // Check if the number of variables in the data and the mcm match
+    if (n != this->mcm_in.n) {
+        throw std::invalid_argument("Number of variables in the data doesn't match the number of variables in the given MCM.");
+    }
+    this->data = &data;
+    this->mcm_out = this->mcm_in;
+
+    // Clear from previous search
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->interaction_graph.clear();
+    this->mutual_information.clear();
+    this->exhaustive = false;
+
+    std::vector<__uint128_t>& partition = this->mcm_out.partition;
+    std::vector<double>& log_ev_per_icc = this->mcm_out.log_ev_per_icc;
+
+    // Calculate the log ev
+    log_ev_per_icc.assign(n, 0);
+    for (int i = 0; i < n; i++){
+        if (partition[i]){
+            log_ev_per_icc[i] = this->get_log_ev_icc(partition[i]);
+        }
+    }
+    this->mcm_out.log_ev = this->get_log_ev(partition);
+
+    // Store log_ev of starting point
+    this->trajectory.record(this->mcm_out.log_ev);
+
+    std::vector<double> mutual_information = calc_mutual_information(data, this->n_threads);
+    while (true){
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){break;}
+        std::vector<std::vector<int>> clusters = adjacent_clusters(partition, mutual_information, this->polish_size);
+        int n_clusters = clusters.size();
+
+        // Variables in every cluster and the position of its subsets in the list of all subsets
+        std::vector<std::vector<int>> variables(n_clusters);
+        std::vector<size_t> offset(n_clusters + 1, 0);
+        for (int a = 0; a < n_clusters; a++){
+            __uint128_t cluster = 0;
+            for (int i : clusters[a]){cluster += partition[i];}
+            for (int v = 0; v < n; v++){
+                if ((cluster >> v) & 1){variables[a].push_back(v);}
+            }
+            offset[a+1] = offset[a] + ((size_t) 1 << variables[a].size());
+        }
+        // Variables of a subset, given by the bits of its index within the cluster
+        auto subset_component = [&](int a, size_t subset){
+            __uint128_t component = 0;
+            for (size_t k = 0; k < variables[a].size(); k++){
+                if ((subset >> k) & 1){component += (__uint128_t) 1 << variables[a][k];}
+            }
+            return component;
+        };
+
+        // Evidence of all subsets of all clusters (in parallel)
+        std::vector<double> subset_log_ev(offset[n_clusters], 0);
+        std::vector<int> subset_cluster;
+        for (int a = 0; a < n_clusters; a++){
+            subset_cluster.insert(subset_cluster.end(), offset[a+1] - offset[a], a);
+        }
+        int n_chunks = std::min((int) offset[n_clusters], 8 * this->n_threads);
+        parallel_for(n_chunks, this->n_threads, [&](int chunk, int thread){
+            size_t begin = offset[n_clusters] * chunk / n_chunks;
+            size_t end = offset[n_clusters] * (chunk + 1) / n_chunks;
+            for (size_t s = begin; s < end; s++){
+                int a = subset_cluster[s];
+                if (s == offset[a]){continue;}
+                subset_log_ev[s] = this->get_log_ev_icc(subset_component(a, s - offset[a]));
+            }
+        });
+
+        // Best partition of every cluster by dynamic programming over its subsets (in parallel)
+        // The best partition of a subset combines the component that contains its first variable with the best partition of the rest
+        std::vector<std::vector<size_t>> choice(n_clusters);
+        std::vector<double> best_log_ev(n_clusters);
+        parallel_for(n_clusters, this->n_threads, [&](int a, int thread){
+            size_t n_subsets = offset[a+1] - offset[a];
+            const double* log_ev = &subset_log_ev[offset[a]];
+            std::vector<double> best(n_subsets, 0);
+            choice[a].assign(n_subsets, 0);
+            for (size_t subset = 1; subset < n_subsets; subset++){
+                size_t first = subset & (~subset + 1);
+                best[subset] = -DBL_MAX;
+                for (size_t part = subset; part; part = (part - 1) & subset){
+                    if (! (part & first)){continue;}
+                    double value = log_ev[part] + best[subset ^ part];
+                    if (value > best[subset]){
+                        best[subset] = value;
+                        choice[a][subset] = part;
+                    }
+                }
+            }
+            best_log_ev[a] = best[n_subsets - 1];
+        });
+
+        // Replace the components of the clusters that improved (differences due to rounding are ignored)
+        bool improved = false;
+        for (int a = 0; a < n_clusters; a++){
+            double current = 0;
+            for (int i : clusters[a]){current += log_ev_per_icc[i];}
+            if (best_log_ev[a] - current < 1e-9){continue;}
+            improved = true;
+
+            for (int i : clusters[a]){
+                partition[i] = 0;
+                log_ev_per_icc[i] = 0;
+                this->mcm_out.n_comp--;
+            }
+            // The new components are placed in the first empty entries
+            int i = 0;
+            for (size_t subset = offset[a+1] - offset[a] - 1; subset; subset ^= choice[a][subset]){
+                while (partition[i]){i++;}
+                partition[i] = subset_component(a, choice[a][subset]);
+                log_ev_per_icc[i] = subset_log_ev[offset[a] + choice[a][subset]];
+                this->mcm_out.n_comp++;
+            }
+            this->mcm_out.log_ev = this->get_log_ev(partition);
+
+            this->trajectory.record(this->mcm_out.log_ev);
+        }
+        // New clusters are formed around the changed components
+        if (! improved){break;}
+    }
+
+    place_empty_entries_last(this->mcm_out.partition);
+    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+
+    return this->mcm_out;
+}
+
+void MCMSearch::set_polish_size(int max_size){
+    if (max_size < 1 || max_size > 20){
+        throw std::invalid_argument("The maximum number of variables in a polished union of components should be between 1 and 20.");
+    }
+    this->polish_size = max_size;
+}
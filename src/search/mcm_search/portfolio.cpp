@@ -0,0 +1,172 @@
+#include "search/mcm_search/mcm_search.h"
+
+#include <mutex>
+
+// Strategies of the portfolio, in the order of their tasks
+static const std::vector<std::string> STRATEGIES = {"greedy", "divide_and_conquer", "annealing"};
+
+MCM MCMSearch::portfolio_search(Data& data, std::string file_name){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    int n_strategies = STRATEGIES.size();
+    this->data = &data;
+
+    // Clear from previous search
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->coarsening_levels.clear();
+    this->exhaustive = false;
+    this->build_interaction_graph();
+
+    // Write the settings to the output file
+    if (!file_name.empty()){
+        this->output_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name));
+        if (! this->output_file->is_open()){
+            std::cerr <<"Error: could not open the given output file.";
+        }
+        *this->output_file << "========================== \n";
+        *this->output_file << "Portfolio Search Procedure \n";
+        *this->output_file << "========================== \n\n";
+
+        *this->output_file << "Data statistics \n";
+        *this->output_file << "--------------- \n\n";
+
+        *this->output_file << "Number of variables: " << data.n << "\n";
+        *this->output_file << "Number of states per variable: " << data.q << "\n";
+        *this->output_file << "Number of datapoints: " << data.N << "\n";
+        *this->output_file << "Number of synthetic datapoints: " << data.N_synthetic << "\n";
+        *this->output_file << "Number of unique datapoint: " << data.N_unique << "\n";
+        *this->output_file << "Entropy of the data: " << data.entropy() << " q-its \n\n";
+
+        *this->output_file << "Number of threads: " << std::min(this->n_threads, n_strategies) << "\n";
+        *this->output_file << "Time limit (seconds): " << this->stop_condition.get_time_limit() << "\n\n";
+
+        *this->output_file << "Start strategies \n";
+        *this->output_file << "---------------- \n\n";
+    }
+
+    // Best partition of all strategies (the incumbent), its starting partition, the strategy that found it and a counter of its improvements
+    std::mutex mutex;
+    MCM incumbent(n);
+    MCM incumbent_start(n);
+    int incumbent_strategy = -1;
+    int n_improvements = 0;
+    std::vector<double> strategy_log_ev(n_strategies, -DBL_MAX);
+
+    // Offer the result of a strategy, it replaces the incumbent if it has a larger log-evidence
+    auto offer = [&](const MCM& result, const MCM& start, int strategy){
+        std::lock_guard<std::mutex> lock(mutex);
+        strategy_log_ev[strategy] = std::max(strategy_log_ev[strategy], result.log_ev);
+        if (incumbent_strategy >= 0 && result.log_ev <= incumbent.log_ev + 1e-6){return;}
+        incumbent = result;
+        incumbent_start = start;
+        incumbent_strategy = strategy;
+        n_improvements++;
+        this->trajectory.record(incumbent.log_ev);
+
+        if (this->output_file){
+            *this->output_file << "Strategy " << STRATEGIES[strategy] << " \t Log-evidence (q-its/datapoint): " << result.log_ev / (data.N_synthetic * log(data.q)) << "\n";
+        }
+    };
+
+    // Every strategy runs on a separate searcher with the same settings and the evidence cache of this searcher
+    std::vector<RandomGenerator> streams;
+    for (int s = 0; s < n_strategies; s++){
+        streams.push_back(this->next_stream());
+    }
+    parallel_for(n_strategies, std::min(this->n_threads, n_strategies), [&](int s, int thread){
+        MCMSearch worker = this->create_worker();
+        worker.generator = streams[s];
+        if (STRATEGIES[s] == "greedy"){
+            MCM result = worker.greedy_search(data);
+            offer(result, worker.get_mcm_in(), s);
+        }
+        else if (STRATEGIES[s] == "divide_and_conquer"){
+            MCM result = worker.divide_and_conquer(data);
+            offer(result, worker.get_mcm_in(), s);
+        }
+        else {
+            // The annealing starts from the incumbent of the other strategies (the independent model if there is none yet),
+            // and starts again whenever another strategy found a better partition during the last run
+            MCM start(n, "independent");
+            bool rerun = true;
+            while (rerun){
+                int seen;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (incumbent_strategy >= 0 && incumbent_strategy != s){start = incumbent;}
+                    seen = n_improvements;
+                }
+                MCM result = worker.simulated_annealing(data, &start);
+                offer(result, start, s);
+
+                double best_log_ev;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    rerun = (incumbent_strategy != s && n_improvements > seen);
+                    best_log_ev = incumbent.log_ev;
+                }
+                if (this->stop_condition.requested(best_log_ev)){break;}
+            }
+        }
+    });
+
+    // The best partition goes through a merge and a refine pass (until no merge or move increases the log-evidence anymore)
+    MCMSearch worker = this->create_worker();
+    MCM merged = worker.greedy_search(data, &incumbent);
+    MCM refined = worker.refine(data, &merged);
+    double polish_gain = std::max(refined.log_ev - incumbent.log_ev, 0.);
+    if (refined.log_ev > incumbent.log_ev + 1e-6){
+        incumbent.log_ev = refined.log_ev;
+        incumbent.log_ev_per_icc = refined.log_ev_per_icc;
+        incumbent.partition = refined.partition;
+        incumbent.n_comp = refined.n_comp;
+        this->trajectory.record(incumbent.log_ev);
+    }
+
+    this->portfolio_winner = STRATEGIES[incumbent_strategy];
+    this->portfolio_log_evidences = strategy_log_ev;
+    this->mcm_in = incumbent_start;
+    this->mcm_out = incumbent;
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Write results to the output file
+    if (!file_name.empty()){
+        double max_log_likelihood = data.calc_log_likelihood(this->mcm_out.partition);
+
+        *this->output_file << "\nGain of the final merge and refine pass (q-its/datapoint): " << polish_gain / (data.N_synthetic * log(data.q)) << "\n";
+
+        *this->output_file << "\nFinal partition (strategy " << this->portfolio_winner << ") \n";
+        *this->output_file << "----------------- \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n";
+        *this->output_file << "Max-Log-likelihood: " << max_log_likelihood << " = " << max_log_likelihood / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+        this->output_file.reset();
+    }
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+
+    return this->mcm_out;
+}
+
+std::string MCMSearch::get_portfolio_winner(){
+    if (this->portfolio_winner.empty()){
+        throw std::runtime_error("No portfolio search has been ran.");
+    }
+    return this->portfolio_winner;
+}
+
+std::vector<double> MCMSearch::get_portfolio_log_evidences(){
+    if (this->portfolio_winner.empty()){
+        throw std::runtime_error("No portfolio search has been ran.");
+    }
+    return this->portfolio_log_evidences;
+}
@@ -0,0 +1,204 @@
+#include "search/mcm_search/mcm_search.h"
+
+MCM MCMSearch::refine(Data& data, MCM* init_mcm){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    // Initialize the mcm that is refined
+    if (!init_mcm){
+        // Default is the result of the previous search
+        if (!this->mcm_out.optimized){
+            throw std::runtime_error("No search has been run before, give the MCM that should be refined.");
+        }
+        this->mcm_in = this->mcm_out;
+    }
+    else {
+        this->mcm_in = *init_mcm;
+    }
+    // Check if the number of variables in the data and the mcm match
+    if (n != this->mcm_in.n) {
+        throw std::invalid_argument("Number of variables in the data doesn't match the number of variables in the given MCM.");
+    }
+    this->data = &data;
+    this->mcm_out = this->mcm_in;
+
+    // Clear from previous search
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->interaction_graph.clear();
+    this->mutual_information.clear();
+    this->exhaustive = false;
+
+    std::vector<__uint128_t>& partition = this->mcm_out.partition;
+    std::vector<double>& log_ev_per_icc = this->mcm_out.log_ev_per_icc;
+
+    // Calculate the log ev
+    log_ev_per_icc.assign(n, 0);
+    for (int i = 0; i < n; i++){
+        if (partition[i]){
+            log_ev_per_icc[i] = this->get_log_ev_icc(partition[i]);
+        }
+    }
+    this->mcm_out.log_ev = this->get_log_ev(partition);
+
+    // Store log_ev of starting point
+    this->trajectory.record(this->mcm_out.log_ev);
+
+    // Every variable is moved on its own
+    std::vector<__uint128_t> units(n);
+    for (int v = 0; v < n; v++){
+        units[v] = (__uint128_t) 1 << v;
+    }
+    this->refine_partition(units);
+
+    place_empty_entries_last(this->mcm_out.partition);
+    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+
+    return this->mcm_out;
+}
+
+
+void MCMSearch::refine_partition(const std::vector<__uint128_t>& units, bool swaps){
+    int n = this->mcm_out.n;
+    int m = units.size();
+    std::vector<__uint128_t>& partition = this->mcm_out.partition;
+    std::vector<double>& log_ev_per_icc = this->mcm_out.log_ev_per_icc;
+
+    // Component of every unit (-1 if the unit is not in the model)
+    std::vector<int> component_of(m, -1);
+    for (int i = 0; i < n; i++){
+        for (int v = 0; v < m; v++){
+            if (partition[i] & units[v]){component_of[v] = i;}
+        }
+    }
+    // Variables that interact with every unit (all variables without an interaction graph)
+    std::vector<__uint128_t> unit_neighbours(m);
+    for (int v = 0; v < m; v++){
+        unit_neighbours[v] = this->neighbourhood(units[v]);
+    }
+    // Evidence of a component (the empty component doesn't contribute)
+    auto log_ev_icc = [&](__uint128_t component){
+        return component ? this->get_log_ev_icc(component) : 0;
+    };
+
+    // Gain of moving unit v to component c is stored in move_gain[v * (n+1) + c], c = n is a new component
+    // Gain of swapping units u < v is stored in swap_gain[u * m + v]
+    std::vector<double> move_gain(m * (n+1), -DBL_MAX);
+    std::vector<double> swap_gain(m * m, -DBL_MAX);
+
+    // Units whose gains all have to be recalculated and components that changed
+    std::vector<bool> affected(m, true);
+    int changed_1 = -1;
+    int changed_2 = -1;
+
+    while (true){
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){break;}
+        // Only the gains that involve a changed component are recalculated (in parallel)
+        parallel_for(m, this->n_threads, [&](int v, int thread){
+            int from = component_of[v];
+            if (from < 0){return;}
+            __uint128_t unit = units[v];
+            __uint128_t from_without = partition[from] - unit;
+            double base = log_ev_icc(from_without) - log_ev_per_icc[from];
+            if (affected[v]){
+                // Moves to all other components that contain an interacting variable
+                for (int c = 0; c < n; c++){
+                    if (c == from || (partition[c] & unit_neighbours[v]) == 0){
+                        move_gain[v * (n+1) + c] = -DBL_MAX;
+                        continue;
+                    }
+                    move_gain[v * (n+1) + c] = base + log_ev_icc(partition[c] + unit) - log_ev_per_icc[c];
+                }
+                // Move to a new component (nothing changes for a component with a single unit)
+                move_gain[v * (n+1) + n] = from_without ? base + log_ev_icc(unit) : -DBL_MAX;
+
+                // Swaps with units in other components (pairs of two affected units are calculated by the smallest one)
+                for (int u = 0; u < m && swaps; u++){
+                    int other = component_of[u];
+                    if (u == v || (affected[u] && u < v)){continue;}
+                    double& gain = swap_gain[std::min(u, v) * m + std::max(u, v)];
+                    if (other < 0 || other == from || (partition[other] & unit_neighbours[v]) == 0 || (partition[from] & unit_neighbours[u]) == 0){
+                        gain = -DBL_MAX;
+                        continue;
+                    }
+                    gain = log_ev_icc(from_without + units[u]) + log_ev_icc(partition[other] - units[u] + unit) - log_ev_per_icc[from] - log_ev_per_icc[other];
+                }
+            }
+            else {
+                // Only the moves to the changed components
+                for (int c : {changed_1, changed_2}){
+                    if (c == from){continue;}
+                    bool interacting = (partition[c] & unit_neighbours[v]) != 0;
+                    move_gain[v * (n+1) + c] = interacting ? base + log_ev_icc(partition[c] + unit) - log_ev_per_icc[c] : -DBL_MAX;
+                }
+            }
+        });
+
+        // Best move or swap (moves first and the smallest indices in case of ties)
+        double best_gain = 0;
+        int best_v = -1;
+        int best_target = -1;
+        bool best_swap = false;
+        for (int v = 0; v < m; v++){
+            for (int c = 0; c <= n; c++){
+                if (move_gain[v * (n+1) + c] > best_gain){
+                    best_gain = move_gain[v * (n+1) + c];
+                    best_v = v;
+                    best_target = c;
+                    best_swap = false;
+                }
+            }
+        }
+        for (int u = 0; u < m; u++){
+            for (int v = u+1; v < m; v++){
+                if (swap_gain[u * m + v] > best_gain){
+                    best_gain = swap_gain[u * m + v];
+                    best_v = u;
+                    best_target = v;
+                    best_swap = true;
+                }
+            }
+        }
+        // Stop when no move increases the evidence (differences due to rounding are ignored)
+        if (best_v < 0 || best_gain < 1e-9){break;}
+
+        __uint128_t unit = units[best_v];
+        changed_1 = component_of[best_v];
+        if (best_swap){
+            changed_2 = component_of[best_target];
+            __uint128_t unit_2 = units[best_target];
+            partition[changed_1] += unit_2 - unit;
+            partition[changed_2] += unit - unit_2;
+            component_of[best_target] = changed_1;
+        }
+        else {
+            changed_2 = best_target;
+            if (best_target == n){
+                // First empty component
+                changed_2 = 0;
+                while (partition[changed_2]){changed_2++;}
+                this->mcm_out.n_comp++;
+            }
+            partition[changed_1] -= unit;
+            partition[changed_2] += unit;
+            if (partition[changed_1] == 0){this->mcm_out.n_comp--;}
+        }
+        component_of[best_v] = changed_2;
+        log_ev_per_icc[changed_1] = log_ev_icc(partition[changed_1]);
+        log_ev_per_icc[changed_2] = log_ev_icc(partition[changed_2]);
+        this->mcm_out.log_ev = this->get_log_ev(partition);
+
+        this->trajectory.record(this->mcm_out.log_ev);
+
+        for (int v = 0; v < m; v++){
+            affected[v] = (component_of[v] == changed_1 || component_of[v] == changed_2);
+        }
+    }
+}
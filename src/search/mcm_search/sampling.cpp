@@ -0,0 +1,308 @@
+#include "search/mcm_search/mcm_search.h"
+
+namespace {
+    /**
+     * Time-weighted statistics of the partitions that are visited by a chain.
+     * A pair of variables is added to the co-membership once it is separated (or at the end of the chain), with the number of iterations
+     * it spent in the same component, such that only the pairs within the changed components are updated after an accepted move.
+     */
+    struct ChainStatistics {
+        int n;
+        std::vector<double> together;       // Number of iterations that every pair (i < j) spent in the same component
+        std::vector<long long> since;       // Iteration at which the pair was joined (if it is joined)
+        std::vector<double> n_comp;         // Number of iterations with k components
+        int current_n_comp = 0;
+        long long last_change = 0;
+
+        ChainStatistics(int n) : n(n), together(n * n, 0), since(n * n, 0), n_comp(n + 1, 0) {};
+
+        void start(const std::vector<__uint128_t>& partition, int k, long long t){
+            for (__uint128_t comp : partition){
+                this->update(0, 0, comp, 0, t);
+            }
+            this->current_n_comp = k;
+            this->last_change = t;
+        }
+
+        // Updates the pairs within two components that are replaced by two new components
+        void update(__uint128_t old_1, __uint128_t old_2, __uint128_t new_1, __uint128_t new_2, long long t){
+            __uint128_t ONE = 1;
+            __uint128_t changed = old_1 | old_2 | new_1 | new_2;
+            std::vector<int> vars;
+            for (int v = 0; v < this->n; v++){
+                if ((changed >> v) & ONE){vars.push_back(v);}
+            }
+            for (size_t a = 0; a < vars.size(); a++){
+                for (size_t b = a + 1; b < vars.size(); b++){
+                    __uint128_t pair = (ONE << vars[a]) | (ONE << vars[b]);
+                    bool was = ((old_1 & pair) == pair) || ((old_2 & pair) == pair);
+                    bool is = ((new_1 & pair) == pair) || ((new_2 & pair) == pair);
+                    int index = vars[a] * this->n + vars[b];
+                    if (was && !is){this->together[index] += t - this->since[index];}
+                    else if (!was && is){this->since[index] = t;}
+                }
+            }
+        }
+
+        void set_n_comp(int k, long long t){
+            this->n_comp[this->current_n_comp] += t - this->last_change;
+            this->current_n_comp = k;
+            this->last_change = t;
+        }
+
+        void finish(const std::vector<__uint128_t>& partition, long long t){
+            for (__uint128_t comp : partition){
+                this->update(comp, 0, 0, 0, t);
+            }
+            this->set_n_comp(this->current_n_comp, t);
+        }
+    };
+}
+
+MCM MCMSearch::posterior_sampling(Data& data, MCM* init_mcm, std::string file_name){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    if (init_mcm && n != init_mcm->n){
+        throw std::invalid_argument("Number of variables in the data doesn't match the number of variables in the given MCM.");
+    }
+    this->data = &data;
+    int n_chains = this->sampling_chains;
+    long long burn_in = this->sampling_burn_in;
+    long long n_iter = this->sampling_iter;
+
+    // Clear from previous search, the moves are proposed between all components
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->dendrogram.clear();
+    this->coarsening_levels.clear();
+    this->exhaustive = false;
+    this->interaction_graph.clear();
+    this->mutual_information.clear();
+
+    MCM start = init_mcm ? *init_mcm : MCM(n, "independent");
+    start.log_ev_per_icc.assign(n, 0);
+    for (int i = 0; i < n; i++){
+        if (start.partition[i]){start.log_ev_per_icc[i] = this->get_log_ev_icc(start.partition[i]);}
+    }
+    start.log_ev = this->get_log_ev(start.partition);
+    this->mcm_in = start;
+
+    if (!file_name.empty()){
+        this->output_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name));
+        if (! this->output_file->is_open()){
+            std::cerr <<"Error: could not open the given output file.";
+        }
+        *this->output_file << "============================ \n";
+        *this->output_file << "Posterior Sampling Procedure \n";
+        *this->output_file << "============================ \n\n";
+
+        *this->output_file << "Data statistics \n";
+        *this->output_file << "--------------- \n\n";
+
+        *this->output_file << "Number of variables: " << data.n << "\n";
+        *this->output_file << "Number of states per variable: " << data.q << "\n";
+        *this->output_file << "Number of datapoints: " << data.N << "\n";
+        *this->output_file << "Number of synthetic datapoints: " << data.N_synthetic << "\n";
+        *this->output_file << "Number of unique datapoint: " << data.N_unique << "\n";
+        *this->output_file << "Entropy of the data: " << data.entropy() << " q-its \n\n";
+
+        *this->output_file << "Number of chains: " << n_chains << "\n";
+        *this->output_file << "Number of burn-in iterations: " << burn_in << "\n";
+        *this->output_file << "Number of sampling iterations: " << n_iter << "\n\n";
+    }
+
+    std::vector<RandomGenerator> streams;
+    for (int c = 0; c < n_chains; c++){
+        streams.push_back(this->next_stream());
+    }
+
+    std::vector<ChainStatistics> statistics(n_chains, ChainStatistics(n));
+    std::vector<MCM> best(n_chains, start);
+    std::vector<double> acceptance(n_chains, 0);
+    std::vector<long long> n_samples(n_chains, 0);
+    parallel_for(n_chains, this->n_threads, [&](int c, int thread){
+        MCM mcm = start;
+        SA_settings settings(1, mcm.partition);
+        settings.generator = streams[c];
+        ChainStatistics& stats = statistics[c];
+        long long n_accepted = 0;
+
+        // The partition at the start of iteration t is the sample of iteration t
+        SA_move move;
+        long long first = burn_in;
+        long long t = 0;
+        for (; t < burn_in + n_iter; t++){
+            // The time limit and the cancellation are checked every 64 iterations
+            if ((t & 63) == 63 && this->stop_condition.requested(best[c].log_ev)){break;}
+            if (t == burn_in){
+                stats.start(mcm.partition, mcm.n_comp, t);
+            }
+            if (! this->propose_move(mcm, settings, move)){continue;}
+
+            __uint128_t old_1 = mcm.partition[move.comp_1];
+            __uint128_t old_2 = mcm.partition[move.comp_2];
+            double log_ratio = this->proposal_log_ratio(settings.index, move);
+            if (! this->apply_move(mcm, settings, move, log_ratio)){continue;}
+
+            if (t >= burn_in){
+                n_accepted++;
+                stats.update(old_1, old_2, move.new_comp_1, move.new_comp_2, t + 1);
+                if (move.type != 2){stats.set_n_comp(mcm.n_comp, t + 1);}
+            }
+            if (mcm.log_ev > best[c].log_ev && fabs(mcm.log_ev - best[c].log_ev) > settings.epsilon){
+                best[c] = mcm;
+            }
+        }
+        // A chain that was stopped during the burn-in counts its last partition as a single sample
+        if (t <= burn_in){
+            first = t;
+            stats.start(mcm.partition, mcm.n_comp, t);
+            t++;
+        }
+        stats.finish(mcm.partition, t);
+        n_samples[c] = t - first;
+        acceptance[c] = (double) n_accepted / n_samples[c];
+    });
+
+    // Combine the chains (a stopped chain has fewer samples)
+    double total_samples = 0;
+    for (int c = 0; c < n_chains; c++){
+        total_samples += n_samples[c];
+    }
+    this->sampling_comembership.assign(n * n, 0);
+    this->sampling_n_comp.assign(n + 1, 0);
+    for (int c = 0; c < n_chains; c++){
+        for (int i = 0; i < n; i++){
+            for (int j = i + 1; j < n; j++){
+                double p = statistics[c].together[i * n + j] / total_samples;
+                this->sampling_comembership[i * n + j] += p;
+                this->sampling_comembership[j * n + i] += p;
+            }
+        }
+        for (int k = 0; k <= n; k++){
+            this->sampling_n_comp[k] += statistics[c].n_comp[k] / total_samples;
+        }
+    }
+    for (int i = 0; i < n; i++){
+        this->sampling_comembership[i * n + i] = 1;
+    }
+    this->sampling_acceptance = acceptance;
+
+    // Best partition that was visited, the trajectory contains the best log-evidence after every chain
+    int best_chain = 0;
+    for (int c = 0; c < n_chains; c++){
+        if (best[c].log_ev > best[best_chain].log_ev){best_chain = c;}
+        this->trajectory.record(best[best_chain].log_ev);
+    }
+    this->mcm_out = best[best_chain];
+    place_empty_entries_last(this->mcm_out.partition);
+    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    if (this->output_file){
+        for (int c = 0; c < n_chains; c++){
+            *this->output_file << "Chain " << c << " \t Acceptance rate: " << acceptance[c] << " \t Best log-evidence (q-its/datapoint): " << best[c].log_ev / (data.N_synthetic * log(data.q)) << "\n";
+        }
+        if (this->mcm_out.truncated){
+            *this->output_file << "\nSampling stopped (time limit or cancellation) after " << total_samples << " samples \n";
+        }
+        *this->output_file << "\nPosterior distribution of the number of components \n";
+        *this->output_file << "-------------------------------------------------- \n\n";
+        for (int k = 1; k <= n; k++){
+            if (this->sampling_n_comp[k] > 0){
+                *this->output_file << k << "\t" << this->sampling_n_comp[k] << "\n";
+            }
+        }
+
+        *this->output_file << "\nBest partition \n";
+        *this->output_file << "-------------- \n\n";
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+        this->output_file.reset();
+    }
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+
+    return this->mcm_out;
+}
+
+double MCMSearch::proposal_log_ratio(const ComponentIndex& index, const SA_move& move){
+    int n = this->data->n;
+    int k = index.n_occupied();
+    int s = index.n_splittable();
+
+    // Probability of the type of move (only merges with n components and only splits with a single component)
+    auto log_type = [n](int n_comp){return (n_comp == n || n_comp == 1) ? 0. : -log(3.);};
+    // Probability of a pair of components to merge and of a split of a component of r variables into two given parts
+    auto log_merge = [](int n_comp){return log(2.) - log(n_comp) - log(n_comp - 1);};
+    auto log_split = [](int n_splittable, int r){return -log(n_splittable) - (r - 1) * log(2.) - log1p(-pow(2., 1 - r));};
+
+    if (move.type == 0){
+        int r_1 = index.size(move.comp_1);
+        int r_2 = index.size(move.comp_2);
+        int s_new = s - (r_1 >= 2) - (r_2 >= 2) + 1;
+        return log_type(k - 1) + log_split(s_new, r_1 + r_2) - log_type(k) - log_merge(k);
+    }
+    else if (move.type == 1){
+        int r = index.size(move.comp_1);
+        return log_type(k + 1) + log_merge(k + 1) - log_type(k) - log_split(s, r);
+    }
+    else {
+        // The variable moves back from the second component, the number of components doesn't change
+        int r_1 = index.size(move.comp_1);
+        int r_2 = index.size(move.comp_2);
+        int s_new = s - (r_1 >= 2) + (r_1 - 1 >= 2) - (r_2 >= 2) + 1;
+        return -log(s_new) - log(r_2 + 1) + log(s) + log(r_1);
+    }
+}
+
+void MCMSearch::set_sampling_chains(int n_chains){
+    if (n_chains < 1){
+        throw std::invalid_argument("The number of chains should be a positive number.");
+    }
+    this->sampling_chains = n_chains;
+}
+
+void MCMSearch::set_sampling_iter(int n_iter){
+    if (n_iter < 1){
+        throw std::invalid_argument("The number of sampling iterations should be a positive number.");
+    }
+    this->sampling_iter = n_iter;
+}
+
+void MCMSearch::set_sampling_burn_in(int n_iter){
+    if (n_iter < 0){
+        throw std::invalid_argument("The number of burn-in iterations should be a non-negative number.");
+    }
+    this->sampling_burn_in = n_iter;
+}
+
+std::vector<std::vector<double>> MCMSearch::get_sampling_comembership(){
+    if (this->sampling_comembership.empty()){
+        throw std::runtime_error("No posterior sampling has been ran.");
+    }
+    int n = this->sampling_n_comp.size() - 1;
+    std::vector<std::vector<double>> matrix(n);
+    for (int i = 0; i < n; i++){
+        matrix[i].assign(this->sampling_comembership.begin() + i * n, this->sampling_comembership.begin() + (i + 1) * n);
+    }
+    return matrix;
+}
+
+std::vector<double> MCMSearch::get_sampling_n_comp(){
+    if (this->sampling_n_comp.empty()){
+        throw std::runtime_error("No posterior sampling has been ran.");
+    }
+    return this->sampling_n_comp;
+}
+
+std::vector<double> MCMSearch::get_sampling_acceptance(){
+    if (this->sampling_acceptance.empty()){
+        throw std::runtime_error("No posterior sampling has been ran.");
+    }
+    return this->sampling_acceptance;
+}
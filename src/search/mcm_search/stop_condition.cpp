@@ -0,0 +1,69 @@
+#include "search/mcm_search/stop_condition.h"
+
+#include <stdexcept>
+
+void StopCondition::set_time_limit(double seconds){
+    if (seconds < 0){
+        throw std::invalid_argument("The time limit should be a non-negative number.");
+    }
+    this->time_limit = seconds;
+}
+
+void StopCondition::set_progress_callback(const ProgressCallback& callback, double interval){
+    if (interval <= 0){
+        throw std::invalid_argument("The interval between two progress reports should be positive.");
+    }
+    this->progress_callback = callback;
+    this->progress_interval = interval;
+}
+
+void StopCondition::enter(){
+    // A search within a running search keeps the condition of the outer search
+    if (this->state && this->state->depth > 0){
+        this->state->depth++;
+        return;
+    }
+    std::shared_ptr<State> state = std::make_shared<State>();
+    state->depth = 1;
+    state->stopped = false;
+    state->start = std::chrono::steady_clock::now();
+    state->has_deadline = (this->time_limit > 0);
+    state->deadline = state->start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->time_limit));
+    state->token = this->token;
+    state->callback = this->progress_callback;
+    state->interval = std::chrono::duration<double>(this->progress_interval);
+    state->owner = std::this_thread::get_id();
+    state->next_report = state->start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(state->interval);
+    this->state = state;
+}
+
+void StopCondition::leave(){
+    if (this->state){
+        this->state->depth--;
+    }
+}
+
+bool StopCondition::requested(double log_ev){
+    if (! this->state){return false;}
+    State& state = *this->state;
+    if (state.stopped.load(std::memory_order_relaxed)){return true;}
+
+    bool stop = state.token.is_cancelled();
+    if (! stop && (state.has_deadline || state.callback)){
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (state.has_deadline && now >= state.deadline){
+            stop = true;
+        }
+        else if (state.callback && now >= state.next_report && std::this_thread::get_id() == state.owner){
+            state.next_report = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(state.interval);
+            SearchProgress progress;
+            progress.elapsed = std::chrono::duration<double>(now - state.start).count();
+            progress.log_ev = log_ev;
+            stop = ! state.callback(progress);
+        }
+    }
+    if (stop){
+        state.stopped = true;
+    }
+    return stop;
+}
@@ -0,0 +1,306 @@
+#include "search/mcm_search/mcm_search.h"
+#include "search/mcm_search/tempering.h"
+#include "search/mcm_search/checkpoint.h"
+
+MCM MCMSearch::parallel_tempering(Data& data, MCM* init_mcm, std::string file_name){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    this->data = &data;
+    if (this->PT_min_temp > this->PT_max_temp){
+        throw std::invalid_argument("The minimum temperature of the replicas should not be larger than the maximum temperature.");
+    }
+    // Initialize an mcm to store the result
+    if(!init_mcm){
+        // Default initial mcm is the independent model
+        this->mcm_in = MCM(n, "independent");
+        this->mcm_out = this->mcm_in;
+    }
+    else{
+        // Check if the number of variables in the data and the mcm match
+        if (n != init_mcm->n) {
+            throw std::invalid_argument("Number of variables in the data doesn't match the number of variables in the given MCM.");
+        }
+        this->mcm_in = *init_mcm;
+        this->mcm_out = *init_mcm;
+    }
+    // Clear from previous search
+    this->trajectory.start();
+    this->top_mcms.clear();
+    this->exhaustive = false;
+    this->build_interaction_graph();
+
+    // Calculate the log ev
+    this->mcm_out.log_ev_per_icc.assign(n, 0);
+    for (int i = 0; i < n; i++){
+        if (this->mcm_out.partition[i]){
+            this->mcm_out.log_ev_per_icc[i] = this->get_log_ev_icc(this->mcm_out.partition[i]);
+        }
+    }
+    this->mcm_out.log_ev = this->get_log_ev(this->mcm_out.partition);
+
+    // Store log_ev of starting point
+    this->trajectory.record(this->mcm_out.log_ev);
+
+    // Write the initial partition to the output file
+    if (!file_name.empty()){
+        this->output_file = std::unique_ptr<std::ofstream>(new std::ofstream(file_name));
+        if (! this->output_file->is_open()){
+            std::cerr <<"Error: could not open the given output file.";
+        }
+        *this->output_file << "============================ \n";
+        *this->output_file << "Parallel Tempering Procedure \n";
+        *this->output_file << "============================ \n\n";
+
+        *this->output_file << "Data statistics \n";
+        *this->output_file << "--------------- \n\n";
+
+        *this->output_file << "Number of variables: " << data.n << "\n";
+        *this->output_file << "Number of states per variable: " << data.q << "\n";
+        *this->output_file << "Number of datapoints: " << data.N << "\n";
+        *this->output_file << "Number of synthetic datapoints: " << data.N_synthetic << "\n";
+        *this->output_file << "Number of unique datapoint: " << data.N_unique << "\n";
+        *this->output_file << "Entropy of the data: " << data.entropy() << " q-its \n\n";
+
+        *this->output_file << "Initial partition \n";
+        *this->output_file << "----------------- \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+
+        *this->output_file << "Start tempering \n";
+        *this->output_file << "--------------- \n\n";
+    }
+
+    // Every replica starts from the initial partition at its own temperature of the ladder
+    PT_state state;
+    std::vector<double> temperatures = this->get_PT_temperatures();
+    for (int r = 0; r < this->PT_n_replicas; r++){
+        state.replicas.push_back(this->mcm_out);
+        state.settings.push_back(SA_settings(this->SA_T0, this->mcm_out.partition));
+        state.settings.back().temp = temperatures[r];
+        state.settings.back().generator = this->next_stream();
+    }
+    state.generator = this->next_stream();
+    state.swap_attempts.assign(this->PT_n_replicas - 1, 0);
+    state.swap_accepted.assign(this->PT_n_replicas - 1, 0);
+
+    this->last_checkpoint = std::chrono::steady_clock::now();
+    return this->run_tempering(state, file_name);
+}
+
+MCM MCMSearch::run_tempering(PT_state& state, std::string file_name){
+    Data& data = *this->data;
+    int n_replicas = state.replicas.size();
+
+    // Best partition of every replica within a round (only if it improves the best partition at the start of the round)
+    std::vector<MCM> round_best(n_replicas, this->mcm_out);
+    std::vector<char> improved(n_replicas);
+
+    while (state.iteration < this->SA_max_iter){
+        if (this->stop_condition.requested(this->mcm_out.log_ev)){
+            if (this->output_file){
+                *this->output_file << "\nSearch stopped at iteration " << state.iteration << " (time limit or cancellation) \n";
+            }
+            break;
+        }
+        // Store the state at the start of a round
+        if (this->checkpoint_due()){
+            this->write_checkpoint(CheckpointMethod::parallel_tempering, [&](std::ostream& stream){
+                write_binary(stream, this->PT_n_replicas);
+                write_binary(stream, this->PT_min_temp);
+                write_binary(stream, this->PT_max_temp);
+                write_binary(stream, this->PT_swap_interval);
+                write_binary(stream, state);
+            });
+        }
+        int n_iter = std::min(this->PT_swap_interval, this->SA_max_iter - state.iteration);
+
+        // The replicas move independently (in parallel), all of them through the shared evidence cache
+        double best_log_ev = this->mcm_out.log_ev;
+        parallel_for(n_replicas, this->n_threads, [&](int r, int thread){
+            MCM& mcm = state.replicas[r];
+            SA_settings& settings = state.settings[r];
+            improved[r] = false;
+            for (int i = 0; i < n_iter; i++){
+                // The time limit and the cancellation are checked every 64 iterations, the round ends for all replicas
+                if ((i & 63) == 63 && this->stop_condition.requested(best_log_ev)){break;}
+                this->annealing_step(mcm, settings);
+
+                double reference = improved[r] ? round_best[r].log_ev : best_log_ev;
+                if (mcm.log_ev > reference && fabs(mcm.log_ev - reference) > settings.epsilon){
+                    round_best[r] = mcm;
+                    improved[r] = true;
+                }
+            }
+        });
+        state.iteration += n_iter;
+
+        // Update solution if one of the replicas improved it (the first replica in case of ties)
+        for (int r = 0; r < n_replicas; r++){
+            if (! improved[r]){continue;}
+            if (round_best[r].log_ev > this->mcm_out.log_ev && fabs(round_best[r].log_ev - this->mcm_out.log_ev) > state.settings[r].epsilon){
+                this->mcm_out.log_ev = round_best[r].log_ev;
+                this->mcm_out.log_ev_per_icc = round_best[r].log_ev_per_icc;
+                this->mcm_out.partition = round_best[r].partition;
+                this->mcm_out.n_comp = round_best[r].n_comp;
+
+                // Write to output file
+                if (this->output_file){
+                    *this->output_file << "Iteration " << state.iteration << " \t\t Replica " << r << " \t\t Temperature: " << state.settings[r].temp << " \t\t Log-evidence (q-its/datapoint): " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << "\n";
+                }
+            }
+        }
+        this->trajectory.record(this->mcm_out.log_ev);
+
+        // Swap neighbouring replicas with the Metropolis criterion, alternating between the even and the odd pairs
+        for (int r = state.round % 2; r + 1 < n_replicas; r += 2){
+            MCM& cold = state.replicas[r];
+            MCM& hot = state.replicas[r+1];
+            double delta = (hot.log_ev - cold.log_ev) * (1 / state.settings[r].temp - 1 / state.settings[r+1].temp);
+            double u = state.generator.uniform_real();
+            state.swap_attempts[r]++;
+            if (delta >= 0 || exp(delta) > u){
+                // The partitions change places, the temperatures stay
+                std::swap(cold, hot);
+                std::swap(state.settings[r].index, state.settings[r+1].index);
+                state.swap_accepted[r]++;
+            }
+        }
+        state.round++;
+    }
+
+    // Acceptance rate of the swaps between every pair of neighbouring replicas
+    this->PT_swap_acceptance.assign(n_replicas - 1, 0);
+    for (int r = 0; r + 1 < n_replicas; r++){
+        if (state.swap_attempts[r]){
+            this->PT_swap_acceptance[r] = (double) state.swap_accepted[r] / state.swap_attempts[r];
+        }
+    }
+
+    if (this->output_file){
+        *this->output_file << "\nAcceptance rate of the swaps between neighbouring replicas\n";
+        *this->output_file << "---------------------------------------------------------\n\n";
+
+        for (int r = 0; r + 1 < n_replicas; r++){
+            *this->output_file << "Replicas " << r << " and " << r+1 << " (temperatures " << state.settings[r].temp << " and " << state.settings[r+1].temp << ")\t" << this->PT_swap_acceptance[r] << "\n";
+        }
+        *this->output_file << "\n";
+
+        *this->output_file << "Start merging \n";
+        *this->output_file << "------------- \n\n";
+    }
+
+    // Hierarchical merging procedure
+    this->dendrogram.start(this->mcm_out);
+    this->hierarchical_merging();
+
+    place_empty_entries_last(this->mcm_out.partition);
+    place_empty_entries_last(this->mcm_out.log_ev_per_icc);
+    // Indicate that the search has been done
+    this->trajectory.finish();
+    this->mcm_out.optimized = true;
+    this->mcm_out.truncated = this->stop_condition.triggered();
+
+    // Write results to the output file
+    if (!file_name.empty()){
+        double max_log_likelihood = data.calc_log_likelihood(this->mcm_out.partition);
+
+        *this->output_file << "\nFinal partition \n";
+        *this->output_file << "----------------- \n\n";
+
+        *this->output_file << "Log-evidence: " << this->mcm_out.log_ev << " = " << this->mcm_out.log_ev / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n";
+        *this->output_file << "Max-Log-likelihood: " << max_log_likelihood << " = " << max_log_likelihood / (data.N_synthetic * log(data.q)) << " q-its/datapoint \n\n";
+
+        print_partition_details_to_file(*this->output_file, this->mcm_out, data.N_synthetic, data.q);
+        *this->output_file << "\n";
+        this->output_file.reset();
+    }
+
+    // Clear the storage of log-evidences
+    this->evidence_storage.clear();
+    if (this->checkpoint_writer){
+        this->checkpoint_writer->wait();
+    }
+
+    return this->mcm_out;
+}
+
+std::vector<double> MCMSearch::get_PT_temperatures(){
+    // Geometric ladder between the minimum and the maximum temperature
+    std::vector<double> temperatures(this->PT_n_replicas);
+    for (int r = 0; r < this->PT_n_replicas; r++){
+        temperatures[r] = this->PT_min_temp * pow(this->PT_max_temp / this->PT_min_temp, (double) r / (this->PT_n_replicas - 1));
+    }
+    return temperatures;
+}
+
+void MCMSearch::set_PT_n_replicas(int n_replicas){
+    if (n_replicas < 2){
+        throw std::invalid_argument("The number of replicas should be at least 2.");
+    }
+    this->PT_n_replicas = n_replicas;
+}
+
+void MCMSearch::set_PT_min_temp(double temp){
+    if (temp <= 0){
+        throw std::invalid_argument("The temperature of the replicas should be positive.");
+    }
+    this->PT_min_temp = temp;
+}
+
+void MCMSearch::set_PT_max_temp(double temp){
+    if (temp <= 0){
+        throw std::invalid_argument("The temperature of the replicas should be positive.");
+    }
+    this->PT_max_temp = temp;
+}
+
+void MCMSearch::set_PT_swap_interval(int n_iter){
+    if (n_iter < 1){
+        throw std::invalid_argument("The number of iterations between two swaps should be a positive number.");
+    }
+    this->PT_swap_interval = n_iter;
+}
+
+std::vector<double> MCMSearch::get_PT_swap_acceptance(){
+    if (this->PT_swap_acceptance.empty()){
+        throw std::runtime_error("No parallel tempering search has been ran.");
+    }
+    return this->PT_swap_acceptance;
+}
+
+void write_binary(std::ostream& stream, const PT_state& state){
+    int n_replicas = state.replicas.size();
+    write_binary(stream, n_replicas);
+    for (int r = 0; r < n_replicas; r++){
+        write_binary(stream, state.replicas[r]);
+        write_binary(stream, state.settings[r]);
+    }
+    write_binary(stream, state.swap_attempts);
+    write_binary(stream, state.swap_accepted);
+    write_binary(stream, state.iteration);
+    write_binary(stream, state.round);
+    write_binary(stream, state.generator);
+}
+
+void read_binary(std::istream& stream, PT_state& state){
+    int n_replicas;
+    read_binary(stream, n_replicas);
+    state.replicas.clear();
+    state.settings.clear();
+    for (int r = 0; r < n_replicas; r++){
+        MCM mcm(1);
+        read_binary(stream, mcm);
+        SA_settings settings(0, mcm.partition);
+        read_binary(stream, settings);
+        state.replicas.push_back(mcm);
+        state.settings.push_back(settings);
+    }
+    read_binary(stream, state.swap_attempts);
+    read_binary(stream, state.swap_accepted);
+    read_binary(stream, state.iteration);
+    read_binary(stream, state.round);
+    read_binary(stream, state.generator);
+}
@@ -0,0 +1,48 @@
+#include "search/mcm_search/top_k.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+TopKPartitions::TopKPartitions(int k){
+    if (k < 0){
+        throw std::invalid_argument("The number of partitions to keep should be a non-negative number.");
+    }
+    this->k = k;
+    this->heap.reserve(k);
+}
+
+void TopKPartitions::push(double log_ev, const std::vector<__uint128_t>& partition){
+    if (! this->accepts(log_ev)){return;}
+
+    std::pair<double, std::vector<__uint128_t>> entry(log_ev, partition);
+    if ((int) this->heap.size() < this->k){
+        // Collection is not full yet
+        this->heap.push_back(entry);
+        std::push_heap(this->heap.begin(), this->heap.end(), better_partition);
+    }
+    else if (better_partition(entry, this->heap.front())){
+        // Replace the worst partition in the collection
+        std::pop_heap(this->heap.begin(), this->heap.end(), better_partition);
+        this->heap.back() = entry;
+        std::push_heap(this->heap.begin(), this->heap.end(), better_partition);
+    }
+}
+
+void TopKPartitions::merge(const TopKPartitions& other){
+    for (const std::pair<double, std::vector<__uint128_t>>& entry : other.heap){
+        this->push(entry.first, entry.second);
+    }
+}
+
+std::vector<std::pair<double, std::vector<__uint128_t>>> TopKPartitions::sorted() const {
+    std::vector<std::pair<double, std::vector<__uint128_t>>> result = this->heap;
+    std::sort(result.begin(), result.end(), better_partition);
+    return result;
+}
+
+bool better_partition(const std::pair<double, std::vector<__uint128_t>>& a, const std::pair<double, std::vector<__uint128_t>>& b){
+    if (a.first != b.first){
+        return a.first > b.first;
+    }
+    return a.second < b.second;
+}
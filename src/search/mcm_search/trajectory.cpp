@@ -0,0 +1,344 @@
+#include "search/mcm_search/trajectory.h"
+#include "search/mcm_search/checkpoint.h"
+
+#include <cmath>
+#include <sstream>
+#include <cstdio>
+#include <stdexcept>
+#include <unistd.h>
+
+void TrajectorySummary::add(double value){
+    if (this->count == 0){
+        this->min = value;
+        this->max = value;
+    }
+    else {
+        if (value < this->min){this->min = value;}
+        if (value > this->max){this->max = value;}
+    }
+    this->count++;
+    double delta = value - this->mean;
+    this->mean += delta / this->count;
+    this->m2 += delta * (value - this->mean);
+}
+
+void TrajectorySummary::merge(const TrajectorySummary& other){
+    if (! other.count){return;}
+    if (! this->count){
+        *this = other;
+        return;
+    }
+    // Parallel variant of Welford's algorithm
+    double total = this->count + other.count;
+    double delta = other.mean - this->mean;
+    this->mean += delta * other.count / total;
+    this->m2 += other.m2 + delta * delta * this->count * other.count / total;
+    if (other.min < this->min){this->min = other.min;}
+    if (other.max > this->max){this->max = other.max;}
+    this->count += other.count;
+}
+
+TrajectoryRecorder::TrajectoryRecorder(){
+    this->policy = TrajectoryPolicy::all;
+    this->interval = 1;
+    this->bin_width = 1;
+    this->first_step = 0;
+    this->step = 0;
+    this->n_logged = 0;
+    this->values = std::make_shared<std::vector<double>>();
+}
+
+void TrajectoryRecorder::set_policy(const std::string& policy){
+    if (policy == "all"){this->policy = TrajectoryPolicy::all;}
+    else if (policy == "off"){this->policy = TrajectoryPolicy::off;}
+    else if (policy == "every_k"){this->policy = TrajectoryPolicy::every_k;}
+    else if (policy == "improvements"){this->policy = TrajectoryPolicy::improvements;}
+    else if (policy == "histogram"){this->policy = TrajectoryPolicy::histogram;}
+    else if (policy == "file"){this->policy = TrajectoryPolicy::file;}
+    else {
+        throw std::invalid_argument("Invalid trajectory policy. Options are 'all', 'off', 'every_k', 'improvements', 'histogram' or 'file'.");
+    }
+}
+
+std::string TrajectoryRecorder::get_policy_name() const {
+    switch (this->policy){
+        case TrajectoryPolicy::all: return "all";
+        case TrajectoryPolicy::off: return "off";
+        case TrajectoryPolicy::every_k: return "every_k";
+        case TrajectoryPolicy::improvements: return "improvements";
+        case TrajectoryPolicy::histogram: return "histogram";
+        case TrajectoryPolicy::file: return "file";
+    }
+    return "all";
+}
+
+void TrajectoryRecorder::set_interval(int k){
+    if (k < 1){
+        throw std::invalid_argument("The trajectory interval should be a positive number.");
+    }
+    this->interval = k;
+}
+
+void TrajectoryRecorder::set_file(const std::string& file_name){
+    this->file_name = file_name;
+}
+
+void TrajectoryRecorder::set_bin_width(double width){
+    if (width <= 0){
+        throw std::invalid_argument("The width of the histogram bins should be positive.");
+    }
+    this->bin_width = width;
+}
+
+void TrajectoryRecorder::start(){
+    this->first_step = 0;
+    this->step = 0;
+    // Release the previous trajectory (views on it keep their own reference)
+    this->values = std::make_shared<std::vector<double>>();
+    this->steps.clear();
+    this->bins.clear();
+    this->summary = TrajectorySummary();
+
+    // The log of a previous trajectory is rewritten at the next checkpoint
+    this->log_name.clear();
+    this->n_logged = 0;
+
+    this->output.reset();
+    if (this->policy == TrajectoryPolicy::file){
+        if (this->file_name.empty()){
+            throw std::invalid_argument("No file is given to write the trajectory to.");
+        }
+        this->open_output(this->file_name);
+    }
+}
+
+TrajectoryRecorder TrajectoryRecorder::create_part(int index, unsigned long long first_step) const {
+    TrajectoryRecorder part;
+    part.policy = this->policy;
+    part.interval = this->interval;
+    part.bin_width = this->bin_width;
+    part.file_name = this->file_name;
+    part.first_step = first_step;
+    part.step = first_step;
+    if (this->policy == TrajectoryPolicy::file){
+        // Each part writes to its own temporary file
+        part.open_output(this->file_name + ".part" + std::to_string(index));
+    }
+    return part;
+}
+
+void TrajectoryRecorder::append(TrajectoryRecorder& part){
+    switch (this->policy){
+        case TrajectoryPolicy::all:
+            this->values->insert(this->values->end(), part.values->begin(), part.values->end());
+            break;
+        case TrajectoryPolicy::off:
+            break;
+        case TrajectoryPolicy::every_k:
+            this->values->insert(this->values->end(), part.values->begin(), part.values->end());
+            this->steps.insert(this->steps.end(), part.steps.begin(), part.steps.end());
+            break;
+        case TrajectoryPolicy::improvements:
+            // The part only knows its own best value -> keep the values that improve on the full trajectory
+            for (size_t i = 0; i < part.values->size(); i++){
+                if (this->values->empty() || (*part.values)[i] > this->values->back()){
+                    this->values->push_back((*part.values)[i]);
+                    this->steps.push_back(part.steps[i]);
+                }
+            }
+            break;
+        case TrajectoryPolicy::histogram: {
+            for (const std::pair<const long long, unsigned long long>& bin : part.bins){
+                this->bins[bin.first] += bin.second;
+            }
+            this->summary.merge(part.summary);
+            break;
+        }
+        case TrajectoryPolicy::file:
+            // Copy the temporary file to the output file and remove it (parts of tasks that never started have no file)
+            part.output.reset();
+            if (part.output_name.empty()){break;}
+            {
+                std::ifstream part_file(part.output_name, std::ios::binary);
+                if (part_file.peek() != std::ifstream::traits_type::eof()){
+                    *this->output << part_file.rdbuf();
+                }
+            }
+            std::remove(part.output_name.c_str());
+            break;
+    }
+    this->step += part.step - part.first_step;
+    // Release the memory of the part
+    part.values = std::make_shared<std::vector<double>>();
+    std::vector<unsigned long long>().swap(part.steps);
+    part.bins.clear();
+}
+
+void TrajectoryRecorder::finish(){
+    if (this->output){
+        this->output->flush();
+        this->output.reset();
+    }
+}
+
+void TrajectoryRecorder::discard(){
+    this->output.reset();
+    if (! this->output_name.empty()){
+        std::remove(this->output_name.c_str());
+        this->output_name.clear();
+    }
+}
+
+void TrajectoryRecorder::save(std::ostream& stream, CheckpointLog* log){
+    write_binary(stream, (int) this->policy);
+    write_binary(stream, this->interval);
+    write_binary(stream, this->file_name);
+    write_binary(stream, this->bin_width);
+    write_binary(stream, this->first_step);
+    write_binary(stream, this->step);
+
+    // Only policies that store values in memory use the log
+    bool logged = log && (this->policy == TrajectoryPolicy::all || this->policy == TrajectoryPolicy::every_k || this->policy == TrajectoryPolicy::improvements);
+    if (! logged){
+        write_binary(stream, std::string());
+        write_binary(stream, *this->values);
+        write_binary(stream, this->steps);
+    }
+    else {
+        if (log->file_name != this->log_name){
+            this->log_name = log->file_name;
+            this->n_logged = 0;
+            log->restart = true;
+        }
+        // Add the values since the previous checkpoint (with their step if the policy doesn't store every step)
+        bool with_steps = (this->policy != TrajectoryPolicy::all);
+        std::ostringstream records(std::ios::binary);
+        for (unsigned long long i = this->n_logged; i < this->values->size(); i++){
+            write_binary(records, (*this->values)[i]);
+            if (with_steps){
+                write_binary(records, this->steps[i]);
+            }
+        }
+        log->records = records.str();
+        this->n_logged = this->values->size();
+        write_binary(stream, this->log_name);
+        write_binary(stream, this->n_logged);
+    }
+
+    std::vector<long long> bin_indices;
+    std::vector<unsigned long long> bin_counts;
+    for (const std::pair<const long long, unsigned long long>& bin : this->bins){
+        bin_indices.push_back(bin.first);
+        bin_counts.push_back(bin.second);
+    }
+    write_binary(stream, bin_indices);
+    write_binary(stream, bin_counts);
+    write_binary(stream, this->summary);
+
+    // Position up to which the output file is valid
+    long long position = -1;
+    if (this->output){
+        this->output->flush();
+        position = this->output->tellp();
+    }
+    write_binary(stream, this->output_name);
+    write_binary(stream, position);
+}
+
+void TrajectoryRecorder::load(std::istream& stream){
+    int policy;
+    read_binary(stream, policy);
+    this->policy = (TrajectoryPolicy) policy;
+    read_binary(stream, this->interval);
+    read_binary(stream, this->file_name);
+    read_binary(stream, this->bin_width);
+    read_binary(stream, this->first_step);
+    read_binary(stream, this->step);
+    this->values = std::make_shared<std::vector<double>>();
+    this->steps.clear();
+    std::string log_name;
+    read_binary(stream, log_name);
+    this->log_name.clear();
+    this->n_logged = 0;
+    if (log_name.empty()){
+        read_binary(stream, *this->values);
+        read_binary(stream, this->steps);
+    }
+    else {
+        unsigned long long n_logged;
+        read_binary(stream, n_logged);
+        bool with_steps = (this->policy != TrajectoryPolicy::all);
+        std::ifstream log_file(log_name, std::ios::binary);
+        if (! log_file.is_open()){
+            throw std::runtime_error("Could not open the log of the trajectory.");
+        }
+        this->values->resize(n_logged);
+        if (with_steps){
+            this->steps.resize(n_logged);
+        }
+        for (unsigned long long i = 0; i < n_logged; i++){
+            log_file.read(reinterpret_cast<char*>(&(*this->values)[i]), sizeof(double));
+            if (with_steps){
+                log_file.read(reinterpret_cast<char*>(&this->steps[i]), sizeof(unsigned long long));
+            }
+        }
+        if (! log_file){
+            throw std::runtime_error("The log of the trajectory is incomplete or corrupted.");
+        }
+        log_file.close();
+        // Remove what was logged after the checkpoint and continue logging at the end
+        unsigned long long record_size = with_steps ? sizeof(double) + sizeof(unsigned long long) : sizeof(double);
+        if (truncate(log_name.c_str(), n_logged * record_size) != 0){
+            throw std::runtime_error("Could not open the log of the trajectory.");
+        }
+        this->log_name = log_name;
+        this->n_logged = n_logged;
+    }
+
+    std::vector<long long> bin_indices;
+    std::vector<unsigned long long> bin_counts;
+    read_binary(stream, bin_indices);
+    read_binary(stream, bin_counts);
+    this->bins.clear();
+    for (size_t i = 0; i < bin_indices.size(); i++){
+        this->bins[bin_indices[i]] = bin_counts[i];
+    }
+    read_binary(stream, this->summary);
+
+    long long position;
+    read_binary(stream, this->output_name);
+    read_binary(stream, position);
+    this->output.reset();
+    if (position >= 0){
+        // Remove what was written after the checkpoint and continue writing at the end
+        if (truncate(this->output_name.c_str(), position) != 0){
+            throw std::runtime_error("Could not open the file to write the trajectory to.");
+        }
+        this->output = std::unique_ptr<std::ofstream>(new std::ofstream(this->output_name, std::ios::binary | std::ios::app));
+        if (! this->output->is_open()){
+            throw std::runtime_error("Could not open the file to write the trajectory to.");
+        }
+    }
+}
+
+std::vector<std::pair<double, unsigned long long>> TrajectoryRecorder::get_histogram() const {
+    std::vector<std::pair<double, unsigned long long>> histogram;
+    for (const std::pair<const long long, unsigned long long>& bin : this->bins){
+        // Lower edge of the bin and the number of values in it
+        histogram.push_back(std::make_pair(bin.first * this->bin_width, bin.second));
+    }
+    return histogram;
+}
+
+void TrajectoryRecorder::add_to_histogram(double log_ev){
+    this->bins[(long long) std::floor(log_ev / this->bin_width)]++;
+    this->summary.add(log_ev);
+}
+
+void TrajectoryRecorder::open_output(const std::string& name){
+    this->output_name = name;
+    this->output = std::unique_ptr<std::ofstream>(new std::ofstream(name, std::ios::binary));
+    if (! this->output->is_open()){
+        throw std::runtime_error("Could not open the file to write the trajectory to.");
+    }
+}
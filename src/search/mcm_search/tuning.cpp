@@ -0,0 +1,193 @@
+#include "search/mcm_search/mcm_search.h"
+
+#include <algorithm>
+
+// Number of pilot chains of every stage of the tuning
+static const int N_PILOTS = 4;
+
+// Returns the value at a fraction of the sorted values (0 if there are none)
+static double quantile(std::vector<double> values, double fraction){
+    if (values.empty()){return 0;}
+    size_t k = (size_t) (fraction * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+MCM MCMSearch::auto_annealing(Data& data, MCM* init_mcm, std::string file_name){
+    StopScope scope(this->stop_condition);
+    int n = data.n;
+    if (init_mcm && n != init_mcm->n){
+        throw std::invalid_argument("Number of variables in the data doesn't match the number of variables in the given MCM.");
+    }
+    this->data = &data;
+    this->exhaustive = false;
+    this->build_interaction_graph();
+    MCM start = init_mcm ? *init_mcm : MCM(n, "independent");
+    start.log_ev_per_icc.assign(n, 0);
+    for (int i = 0; i < n; i++){
+        if (start.partition[i]){start.log_ev_per_icc[i] = this->get_log_ev_icc(start.partition[i]);}
+    }
+    start.log_ev = this->get_log_ev(start.partition);
+
+    SA_tuning tuning;
+    std::vector<RandomGenerator> streams;
+    for (int p = 0; p < N_PILOTS; p++){
+        streams.push_back(this->next_stream());
+    }
+
+    // Random walks in which every move is accepted, recording the decrease of the log-evidence of the worsening moves
+    int walk_length = 100 + 10 * n;
+    std::vector<std::vector<double>> deltas(3 * N_PILOTS);
+    parallel_for(N_PILOTS, this->n_threads, [&](int p, int thread){
+        MCM mcm = start;
+        SA_settings settings(HUGE_VAL, mcm.partition);
+        settings.generator = streams[p];
+
+        SA_move move;
+        for (int w = 0; w < walk_length; w++){
+            if (! this->propose_move(mcm, settings, move)){continue;}
+            double log_ev_2 = move.new_comp_2 ? this->get_log_ev_icc(move.new_comp_2) : 0;
+            double diff_log_ev = this->get_log_ev_icc(move.new_comp_1) + log_ev_2 - mcm.log_ev_per_icc[move.comp_1] - mcm.log_ev_per_icc[move.comp_2];
+            if (diff_log_ev < 0){
+                deltas[3 * p + move.type].push_back(-diff_log_ev);
+            }
+            this->apply_move(mcm, settings, move);
+        }
+    });
+
+    std::vector<double> all_deltas;
+    std::vector<double> type_deltas[3];
+    for (int p = 0; p < N_PILOTS; p++){
+        for (int type = 0; type < 3; type++){
+            type_deltas[type].insert(type_deltas[type].end(), deltas[3 * p + type].begin(), deltas[3 * p + type].end());
+        }
+    }
+    for (int type = 0; type < 3; type++){
+        all_deltas.insert(all_deltas.end(), type_deltas[type].begin(), type_deltas[type].end());
+    }
+    tuning.merge_delta = quantile(type_deltas[0], 0.5);
+    tuning.split_delta = quantile(type_deltas[1], 0.5);
+    tuning.switch_delta = quantile(type_deltas[2], 0.5);
+
+    // A worsening move of median size is accepted with probability 1/2 at the start,
+    // a worsening move of the smallest tenth is accepted with probability 1/1000 at the end
+    tuning.init_temp = this->SA_T0;
+    tuning.min_temp = this->SA_min_temp;
+    if (! all_deltas.empty()){
+        tuning.init_temp = quantile(all_deltas, 0.5) / log(2.);
+        tuning.min_temp = std::max(quantile(all_deltas, 0.1) / log(1000.), 1e-6 * tuning.init_temp);
+    }
+    tuning.min_temp = std::min(tuning.min_temp, tuning.init_temp / 2);
+    tuning.update_schedule = std::max(10, n);
+
+    // Geometric cooling over the budget, which is doubled as long as the mean result of the pilot chains improves.
+    // The pilot chains only anneal, the greedy merging afterwards would hide the difference between the budgets.
+    double tolerance = 1e-3 * data.N_synthetic * log(data.q);
+    int budget = std::min(std::max(1000, 10 * n), this->SA_max_iter);
+    // Best partition of the pilot chains, the annealing starts from it if the search is stopped during the tuning
+    MCM best_pilot = start;
+    while (true){
+        double rate = pow(tuning.min_temp / tuning.init_temp, (double) tuning.update_schedule / budget);
+        std::vector<MCM> results(N_PILOTS, start);
+        parallel_for(N_PILOTS, this->n_threads, [&](int p, int thread){
+            MCMSearch worker = this->create_worker();
+            worker.data = &data;
+            worker.exhaustive = false;
+            worker.SA_schedule = CoolingSchedule::geometric;
+            worker.SA_cooling_rate = std::min(std::max(rate, 1e-12), 1 - 1e-12);
+            worker.SA_min_temp = tuning.min_temp;
+            worker.SA_update_schedule = tuning.update_schedule;
+            worker.SA_max_iter = budget;
+            worker.SA_reheats = 0;
+            worker.mcm_out = start;
+
+            MCM mcm = start;
+            SA_settings settings(tuning.init_temp, mcm.partition);
+            settings.max_no_improve = this->SA_max_no_improve;
+            settings.generator = streams[p];
+            settings.generator.jump();
+            worker.annealing(mcm, settings);
+            results[p] = worker.mcm_out;
+        });
+        double mean = 0;
+        for (MCM& result : results){
+            mean += result.log_ev / N_PILOTS;
+            if (result.log_ev > best_pilot.log_ev){best_pilot = result;}
+        }
+        if (this->stop_condition.requested(best_pilot.log_ev)){
+            start = best_pilot;
+            break;
+        }
+
+        // Stop when doubling the budget doesn't improve the result, the previous budget is used
+        bool converged = ! tuning.pilot_log_evidences.empty() && mean <= tuning.pilot_log_evidences.back() + tolerance;
+        int previous_budget = converged ? tuning.pilot_budgets.back() : budget;
+        tuning.pilot_budgets.push_back(budget);
+        tuning.pilot_log_evidences.push_back(mean);
+        if (converged){
+            budget = previous_budget;
+            break;
+        }
+        if (budget >= this->SA_max_iter){break;}
+        budget = std::min(2 * budget, this->SA_max_iter);
+    }
+    tuning.max_iter = budget;
+    tuning.cooling_rate = std::min(std::max(pow(tuning.min_temp / tuning.init_temp, (double) tuning.update_schedule / budget), 1e-12), 1 - 1e-12);
+
+    this->SA_tuning_result = tuning;
+
+    // The annealing runs with the chosen settings, the settings of the searcher are restored afterwards (also if the annealing throws)
+    struct SettingsGuard {
+        MCMSearch& searcher;
+        double T0;
+        CoolingSchedule schedule;
+        double cooling_rate;
+        double min_temp;
+        int update_schedule;
+        int max_iter;
+        ~SettingsGuard() {
+            this->searcher.SA_T0 = this->T0;
+            this->searcher.SA_schedule = this->schedule;
+            this->searcher.SA_cooling_rate = this->cooling_rate;
+            this->searcher.SA_min_temp = this->min_temp;
+            this->searcher.SA_update_schedule = this->update_schedule;
+            this->searcher.SA_max_iter = this->max_iter;
+        };
+    };
+    {
+        SettingsGuard guard = {*this, this->SA_T0, this->SA_schedule, this->SA_cooling_rate, this->SA_min_temp, this->SA_update_schedule, this->SA_max_iter};
+        this->SA_T0 = tuning.init_temp;
+        this->SA_schedule = CoolingSchedule::geometric;
+        this->SA_cooling_rate = tuning.cooling_rate;
+        this->SA_min_temp = tuning.min_temp;
+        this->SA_update_schedule = tuning.update_schedule;
+        this->SA_max_iter = tuning.max_iter;
+
+        this->simulated_annealing(data, &start, file_name);
+    }
+
+    // Append the tuning to the output file of the annealing
+    if (!file_name.empty()){
+        std::ofstream output(file_name, std::ios::app);
+        output << "Tuning of the annealing \n";
+        output << "----------------------- \n\n";
+
+        output << "Median decrease of the log-evidence of worsening moves: merge " << tuning.merge_delta << ", split " << tuning.split_delta << ", switch " << tuning.switch_delta << "\n";
+        for (size_t i = 0; i < tuning.pilot_budgets.size(); i++){
+            output << "Pilot budget " << tuning.pilot_budgets[i] << " \t Mean log-evidence (q-its/datapoint): " << tuning.pilot_log_evidences[i] / (data.N_synthetic * log(data.q)) << "\n";
+        }
+        output << "Initial temperature: " << tuning.init_temp << "\n";
+        output << "Minimum temperature: " << tuning.min_temp << "\n";
+        output << "Cooling rate (geometric): " << tuning.cooling_rate << "\n";
+        output << "Iterations between temperature updates: " << tuning.update_schedule << "\n";
+        output << "Maximum number of iterations: " << tuning.max_iter << "\n";
+    }
+    return this->mcm_out;
+}
+
+SA_tuning MCMSearch::get_SA_tuning(){
+    if (this->SA_tuning_result.max_iter == 0){
+        throw std::runtime_error("No tuning of the annealing has been ran.");
+    }
+    return this->SA_tuning_result;
+}
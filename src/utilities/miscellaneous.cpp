@@ -1,55 +1,43 @@
 #include "utilities/miscellaneous.h"
 
 int bit_count(__uint128_t integer){
-    int size = 0;
-    while(integer){
-        // Check if last bit is equal to 1
-        if (integer & 1){
-            size += 1;
-        }
-        // Bitshift to the right
-        integer >>= 1;
-    }
-    return size;
+    // Population count of both 64bit halves
+    return __builtin_popcountll((uint64_t) integer) + __builtin_popcountll((uint64_t) (integer >> 64));
 }
 
-int randomBitIndex(__uint128_t integer){
-    __uint128_t ONE = 1;
-    std::string r;
-
-	int nb = bit_count(integer);
-
-	int x = 0;
-	int y = 0;
-	
-	int my_index = rand()/(RAND_MAX/nb);
-	int loc = 0;
-
-	while(integer) {
-
-		r = ((integer & ONE) + '0');
-
-		if (r == "1") {
-			if (x == my_index){
-				loc = y;
-				break;
-			}
-			x++;
-		}
-		integer >>= 1;
-		y++;
-	}	
-
-	return loc;
+int randomBitIndex(__uint128_t integer, RandomGenerator& generator){
+    uint64_t low = (uint64_t) integer;
+    uint64_t high = (uint64_t) (integer >> 64);
+    int n_low = __builtin_popcountll(low);
+
+    // Select the k-th bit that is set, first the half that contains it
+    int k = generator.uniform_int(n_low + __builtin_popcountll(high));
+    uint64_t word = low;
+    int offset = 0;
+    if (k >= n_low){
+        word = high;
+        offset = 64;
+        k -= n_low;
+    }
+    // Then the byte that contains it
+    while (true){
+        int n_byte = __builtin_popcountll(word & 0xff);
+        if (k < n_byte){break;}
+        k -= n_byte;
+        word >>= 8;
+        offset += 8;
+    }
+    // Clear the k lowest bits that are set
+    for (; k > 0; k--){word &= word - 1;}
+    return offset + __builtin_ctzll(word);
 }
 
-__uint128_t random_128_int(int n){
-    __uint128_t integer=0;
-    integer += rand() % 2;
-    for (int i = 1; i < n; i++){
-        integer <<= 1;
-        integer += rand() % 2;
-        
+__uint128_t random_128_int(int n, RandomGenerator& generator){
+    if (n <= 0){return 0;}
+    // 64 random bits at a time
+    __uint128_t integer = ((__uint128_t) generator() << 64) + generator();
+    if (n < 128){
+        integer &= ((__uint128_t) 1 << n) - 1;
     }
     return integer;
 }
@@ -0,0 +1,146 @@
+#include "utilities/parallel.h"
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <exception>
+
+void parallel_for(int n_tasks, int n_threads, const std::function<void(int, int)>& task){
+    if (n_tasks <= 0){return;}
+    // No need for more threads than tasks
+    if (n_threads > n_tasks){n_threads = n_tasks;}
+    if (n_threads <= 1){
+        // Run everything on the calling thread
+        for (int i = 0; i < n_tasks; i++){
+            task(i, 0);
+        }
+        return;
+    }
+
+    std::atomic<int> next_task(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error = nullptr;
+    std::mutex error_mutex;
+
+    auto worker = [&](int thread_index){
+        while (!failed){
+            // Take the next task that has not been handed out yet
+            int i = next_task.fetch_add(1);
+            if (i >= n_tasks){break;}
+            try {
+                task(i, thread_index);
+            }
+            catch (...) {
+                // Store the first exception and stop handing out tasks
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error){error = std::current_exception();}
+                failed = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < n_threads; t++){
+        threads.push_back(std::thread(worker, t));
+    }
+    // The calling thread also takes part in the work
+    worker(0);
+    for (std::thread& thread : threads){
+        thread.join();
+    }
+    if (error){
+        std::rethrow_exception(error);
+    }
+}
+
+ThreadPool::ThreadPool(int n_threads) : next_task(0), failed(false) {
+    for (int t = 1; t < n_threads; t++){
+        this->threads.push_back(std::thread(&ThreadPool::work, this, t));
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->start.notify_all();
+    for (std::thread& thread : this->threads){
+        thread.join();
+    }
+}
+
+void ThreadPool::run(int n_tasks, const std::function<void(int, int)>& task){
+    if (n_tasks <= 0){return;}
+    if (this->threads.empty() || n_tasks == 1){
+        // Run everything on the calling thread
+        for (int i = 0; i < n_tasks; i++){
+            task(i, 0);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->task = &task;
+        this->n_tasks = n_tasks;
+        this->next_task = 0;
+        this->failed = false;
+        this->error = nullptr;
+        this->n_busy = this->threads.size();
+        this->generation++;
+    }
+    this->start.notify_all();
+    // The calling thread also takes part in the work
+    this->execute(0);
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->finished.wait(lock, [this]{return this->n_busy == 0;});
+        this->task = nullptr;
+        error = this->error;
+        this->error = nullptr;
+    }
+    if (error){
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::work(int thread_index){
+    unsigned long long seen = 0;
+    while (true){
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->start.wait(lock, [&]{return this->stopping || this->generation != seen;});
+            if (this->stopping){return;}
+            seen = this->generation;
+        }
+        this->execute(thread_index);
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (--this->n_busy == 0){this->finished.notify_one();}
+        }
+    }
+}
+
+void ThreadPool::execute(int thread_index){
+    while (!this->failed){
+        // Take the next task that has not been handed out yet
+        int i = this->next_task.fetch_add(1);
+        if (i >= this->n_tasks){break;}
+        try {
+            (*this->task)(i, thread_index);
+        }
+        catch (...) {
+            // Store the first exception and stop handing out tasks
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (!this->error){this->error = std::current_exception();}
+            this->failed = true;
+        }
+    }
+}
+
+int available_threads(){
+    int n_threads = std::thread::hardware_concurrency();
+    return (n_threads > 0) ? n_threads : 1;
+}
@@ -1,7 +1,7 @@
 #include "utilities/partition.h"
 #include "utilities/miscellaneous.h"
 
-std::vector<__uint128_t> generate_random_partition(int n){
+std::vector<__uint128_t> generate_random_partition(int n, RandomGenerator& generator){
     // Check if the number of variables is a valid number
     if (n > 128){
         throw std::domain_error("The maximum system size is 128 variables.");
@@ -15,7 +15,7 @@ std::vector<__uint128_t> generate_random_partition(int n){
     std::vector<__uint128_t> partition(n, 0);
     for (int i = 0; i < n; i++){
         // Generate a random number between 0 and n-1
-        component = rand()/(RAND_MAX/n);
+        component = generator.uniform_int(n);
         // Add variable i to this component
         partition[component] += element;
         element <<= 1;
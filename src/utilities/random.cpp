@@ -0,0 +1,74 @@
+#include "utilities/random.h"
+
+#include <random>
+
+namespace {
+    inline uint64_t rotl(uint64_t x, int k){
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Expands a 64bit seed into well mixed values (splitmix64)
+    inline uint64_t splitmix64(uint64_t& x){
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+}
+
+void RandomGenerator::seed(uint64_t seed){
+    for (int i = 0; i < 4; i++){
+        this->state[i] = splitmix64(seed);
+    }
+}
+
+uint64_t RandomGenerator::operator()(){
+    uint64_t* s = this->state;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+
+    return result;
+}
+
+void RandomGenerator::jump(){
+    static const uint64_t JUMP[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+
+    uint64_t s[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 4; i++){
+        for (int b = 0; b < 64; b++){
+            if (JUMP[i] & ((uint64_t) 1 << b)){
+                for (int j = 0; j < 4; j++){s[j] ^= this->state[j];}
+            }
+            (*this)();
+        }
+    }
+    for (int j = 0; j < 4; j++){this->state[j] = s[j];}
+}
+
+uint64_t random_seed(){
+    std::random_device device;
+    return ((uint64_t) device() << 32) ^ device();
+}
+
+RandomGenerator& thread_generator(){
+    thread_local RandomGenerator generator(random_seed());
+    return generator;
+}
+
+RandomGenerator seeded_generator(long long seed){
+    if (seed >= 0){
+        return RandomGenerator(seed);
+    }
+    // Copy of the generator of this thread, which continues with a different stream
+    RandomGenerator& generator = thread_generator();
+    RandomGenerator copy = generator;
+    generator.jump();
+    return copy;
+}
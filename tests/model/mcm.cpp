@@ -176,6 +176,19 @@ TEST(model, init_string){
     EXPECT_EQ(mcm.partition.size(),  n);
     EXPECT_EQ(mcm.partition, exp_partition);
     EXPECT_FALSE(mcm.optimized);
+
+    // Random model with a seed
+    n = 30;
+    partition = "random";
+    mcm = MCM(n, partition, 11);
+    EXPECT_EQ(mcm.partition, MCM(n, partition, 11).partition);
+    EXPECT_NE(mcm.partition, MCM(n, partition, 12).partition);
+    __uint128_t all_vars = 0;
+    for (__uint128_t component : mcm.partition){
+        EXPECT_EQ(all_vars & component, 0);
+        all_vars += component;
+    }
+    EXPECT_EQ(all_vars, ((__uint128_t) 1 << n) - 1);
 }
 
 TEST(model, get_partition){
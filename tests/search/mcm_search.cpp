@@ -1,5 +1,13 @@
 #include "gtest/gtest.h"
 #include "search/mcm_search/mcm_search.h"
+#include "search/mcm_search/exhaustive.h"
+#include "search/mcm_search/greedy.h"
+#include "utilities/histogram.h"
+#include <set>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <chrono>
 
 TEST(search, init_n) {
     // Initialize
@@ -287,3 +295,1656 @@ TEST(search, sim_annealing) {
     }
 }
 
+
+TEST(search, exhaustive_top_k) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+
+    try {
+        searcher.set_top_k(-1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of best partitions to keep should be a non-negative number."));
+    }
+    try {
+        searcher.get_top_mcms();
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch(std::runtime_error const & err) {
+        EXPECT_EQ(err.what(), std::string("No exhaustive search with top_k > 0 has been ran."));
+    }
+
+    // Full trajectory as reference
+    searcher.exhaustive_search(data);
+    std::vector<double> all_evs = searcher.get_log_evidence_trajectory();
+    std::sort(all_evs.begin(), all_evs.end(), std::greater<double>());
+
+    searcher.set_top_k(10);
+    MCM best = searcher.exhaustive_search(data);
+    std::vector<MCM> top_mcms = searcher.get_top_mcms();
+
+    // Trajectory is not stored when only the best partitions are requested
+    EXPECT_EQ(searcher.get_log_evidence_trajectory().size(), 0);
+    EXPECT_EQ(top_mcms.size(), 10);
+    EXPECT_EQ(top_mcms[0].partition, best.partition);
+    for (int i = 0; i < 10; i++){
+        EXPECT_DOUBLE_EQ(top_mcms[i].get_best_log_ev(), all_evs[i]);
+        EXPECT_DOUBLE_EQ(top_mcms[i].get_best_log_ev(), data.calc_log_ev(top_mcms[i].partition));
+    }
+
+    // Same result when the enumeration is divided over multiple threads
+    searcher.set_n_threads(4);
+    searcher.exhaustive_search(data);
+    std::vector<MCM> top_mcms_parallel = searcher.get_top_mcms();
+    for (int i = 0; i < 10; i++){
+        EXPECT_EQ(top_mcms[i].partition, top_mcms_parallel[i].partition);
+        EXPECT_EQ(top_mcms[i].get_best_log_ev(), top_mcms_parallel[i].get_best_log_ev());
+    }
+}
+
+TEST(search, exhaustive_threads) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+
+    try {
+        searcher.set_n_threads(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of threads should be a positive number."));
+    }
+
+    MCM mcm_serial = searcher.exhaustive_search(data);
+    std::vector<double> trajectory_serial = searcher.get_log_evidence_trajectory();
+    EXPECT_EQ(trajectory_serial.size(), 21147);
+
+    searcher.set_n_threads(3);
+    MCM mcm_parallel = searcher.exhaustive_search(data);
+
+    // Partitions are enumerated in the same order
+    EXPECT_EQ(trajectory_serial, searcher.get_log_evidence_trajectory());
+    EXPECT_EQ(mcm_serial.partition, mcm_parallel.partition);
+    EXPECT_EQ(mcm_serial.get_best_log_ev(), mcm_parallel.get_best_log_ev());
+    EXPECT_EQ(mcm_parallel.n_comp, 2);
+}
+
+TEST(search, trajectory_policy) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+
+    try {
+        searcher.set_trajectory_policy("sometimes");
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Invalid trajectory policy. Options are 'all', 'off', 'every_k', 'improvements', 'histogram' or 'file'."));
+    }
+    try {
+        searcher.set_trajectory_interval(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The trajectory interval should be a positive number."));
+    }
+
+    // Reference: all partitions
+    EXPECT_EQ(searcher.get_trajectory_policy(), "all");
+    searcher.exhaustive_search(data);
+    std::vector<double> all_evs = searcher.get_log_evidence_trajectory();
+
+    // Run the other policies with multiple threads to check that the parts are combined in order
+    searcher.set_n_threads(3);
+
+    searcher.set_trajectory_policy("off");
+    searcher.exhaustive_search(data);
+    EXPECT_EQ(searcher.get_log_evidence_trajectory().size(), 0);
+
+    searcher.set_trajectory_policy("every_k");
+    searcher.set_trajectory_interval(100);
+    searcher.exhaustive_search(data);
+    std::vector<double> values = searcher.get_log_evidence_trajectory();
+    std::vector<unsigned long long> steps = searcher.get_log_evidence_trajectory_steps();
+    EXPECT_EQ(values.size(), 212);
+    EXPECT_EQ(steps.size(), 212);
+    for (int i = 0; i < values.size(); i++){
+        EXPECT_EQ(steps[i], 100 * i);
+        EXPECT_EQ(values[i], all_evs[100 * i]);
+    }
+
+    searcher.set_trajectory_policy("improvements");
+    searcher.exhaustive_search(data);
+    values = searcher.get_log_evidence_trajectory();
+    steps = searcher.get_log_evidence_trajectory_steps();
+    std::vector<double> improvements;
+    for (double log_ev : all_evs){
+        if (improvements.empty() || log_ev > improvements.back()){improvements.push_back(log_ev);}
+    }
+    EXPECT_EQ(values, improvements);
+    for (int i = 0; i < values.size(); i++){
+        EXPECT_EQ(values[i], all_evs[steps[i]]);
+    }
+
+    searcher.set_trajectory_policy("histogram");
+    searcher.set_trajectory_bin_width(10);
+    searcher.exhaustive_search(data);
+    TrajectorySummary summary = searcher.get_log_evidence_summary();
+    EXPECT_EQ(summary.count, 21147);
+    EXPECT_EQ(summary.min, *std::min_element(all_evs.begin(), all_evs.end()));
+    EXPECT_EQ(summary.max, *std::max_element(all_evs.begin(), all_evs.end()));
+    unsigned long long n_values = 0;
+    for (std::pair<double, unsigned long long>& bin : searcher.get_log_evidence_histogram()){
+        n_values += bin.second;
+    }
+    EXPECT_EQ(n_values, 21147);
+
+    searcher.set_trajectory_policy("file");
+    searcher.set_trajectory_file("trajectory_test.bin");
+    searcher.exhaustive_search(data);
+    std::ifstream file("trajectory_test.bin", std::ios::binary);
+    std::vector<double> file_values(all_evs.size());
+    file.read(reinterpret_cast<char*>(file_values.data()), all_evs.size() * sizeof(double));
+    EXPECT_EQ(file.gcount(), all_evs.size() * sizeof(double));
+    EXPECT_EQ(file_values, all_evs);
+    file.close();
+
+    // The temporary files of the parts are removed if the search fails
+    MCMSearch failing_searcher = MCMSearch();
+    failing_searcher.set_trajectory_policy("file");
+    failing_searcher.set_trajectory_file("trajectory_test.bin");
+    failing_searcher.set_checkpoint("checkpoint_trajectory_test.bin", 1000);
+    int n_calls = 0;
+    failing_searcher.set_progress_callback([&](const SearchProgress& progress){
+        if (++n_calls > 200){throw std::runtime_error("Failure during the search");}
+        return true;
+    },1e-9);
+    EXPECT_THROW(failing_searcher.exhaustive_search(data), std::runtime_error);
+    for (int i = 0; i < 1024; i++){
+        EXPECT_FALSE(std::ifstream("trajectory_test.bin.part" + std::to_string(i)).is_open());
+    }
+    std::remove("checkpoint_trajectory_test.bin");
+    std::remove("checkpoint_trajectory_test.bin.trajectory");
+    std::remove("checkpoint_trajectory_test.bin.cache");
+    std::remove("trajectory_test.bin");
+
+    // Heuristic searches use the same policies
+    searcher.set_trajectory_policy("improvements");
+    searcher.simulated_annealing(data);
+    values = searcher.get_log_evidence_trajectory();
+    for (int i = 1; i < values.size(); i++){
+        EXPECT_GT(values[i], values[i-1]);
+    }
+}
+
+TEST(search, checkpoint_cache_log) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    EvidenceCache cache;
+    cache.get(3, data);
+    EXPECT_FALSE(cache.is_tracking());
+    EXPECT_TRUE(cache.take_insertions().empty());
+
+    // Only the entries inserted after track_insertions are collected, each of them once
+    cache.track_insertions();
+    EXPECT_TRUE(cache.is_tracking());
+    cache.get(3, data);
+    cache.get(5, data);
+    cache.get(6, data);
+    cache.get(5, data);
+    std::vector<std::pair<__uint128_t, double>> inserted = cache.take_insertions();
+    std::sort(inserted.begin(), inserted.end());
+    ASSERT_EQ(inserted.size(), 2);
+    EXPECT_TRUE(inserted[0].first == 5 && inserted[1].first == 6);
+    EXPECT_TRUE(cache.take_insertions().empty());
+
+    // The records appended after the checkpoint are removed from the log
+    std::ofstream log("cache_log_test.bin", std::ios::binary);
+    std::string records = cache_log_records(cache.entries());
+    log.write(records.data(), records.size());
+    log.write(records.data(), 10);
+    log.close();
+    EvidenceCache loaded;
+    read_cache_log("cache_log_test.bin", 3, loaded);
+    EXPECT_EQ(loaded.size(), 3);
+    EXPECT_FALSE(loaded.is_tracking());
+    double log_ev;
+    EXPECT_TRUE(loaded.find(6, log_ev));
+    EXPECT_EQ(log_ev, data.calc_log_ev_icc(6));
+    EXPECT_EQ((size_t) std::ifstream("cache_log_test.bin", std::ios::binary | std::ios::ate).tellg(), records.size());
+    EXPECT_THROW(read_cache_log("cache_log_test.bin", 4, loaded), std::runtime_error);
+    std::remove("cache_log_test.bin");
+}
+
+TEST(search, checkpoint) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    Data other_data("../tests/test.dat", 3, 3);
+    MCMSearch searcher = MCMSearch();
+
+    try {
+        searcher.set_checkpoint("checkpoint_test.bin", -1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The interval between two checkpoints should be a non-negative number."));
+    }
+    try {
+        searcher.resume_search(data, "missing_checkpoint.bin");
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Could not open the checkpoint file."));
+    }
+
+    // Write a checkpoint after every step
+    searcher.set_checkpoint("checkpoint_test.bin", 0);
+    EXPECT_EQ(searcher.get_checkpoint_file(), "checkpoint_test.bin");
+    EXPECT_EQ(searcher.get_checkpoint_interval(), 0);
+
+    // Greedy search
+    MCM mcm = searcher.greedy_search(data);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+
+    MCMSearch resumed_searcher = MCMSearch();
+    MCM mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_test.bin");
+    EXPECT_EQ(mcm.partition, mcm_resumed.partition);
+    EXPECT_EQ(mcm.get_best_log_ev(), mcm_resumed.get_best_log_ev());
+    EXPECT_EQ(trajectory, resumed_searcher.get_log_evidence_trajectory());
+    EXPECT_EQ(searcher.get_mcm_in().partition, resumed_searcher.get_mcm_in().partition);
+
+    // Checkpoint can only be resumed on the same data
+    try {
+        resumed_searcher.resume_search(other_data, "checkpoint_test.bin");
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The checkpoint was created for a different dataset."));
+    }
+
+    // Divide and conquer
+    mcm = searcher.divide_and_conquer(data);
+    mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_test.bin");
+    EXPECT_EQ(mcm.partition, mcm_resumed.partition);
+    EXPECT_EQ(mcm.get_best_log_ev(), mcm_resumed.get_best_log_ev());
+
+    // Exhaustive search with the k best partitions
+    searcher.set_top_k(5);
+    searcher.set_n_threads(2);
+    mcm = searcher.exhaustive_search(other_data);
+    mcm_resumed = resumed_searcher.resume_search(other_data, "checkpoint_test.bin");
+    EXPECT_EQ(mcm.partition, mcm_resumed.partition);
+    EXPECT_EQ(mcm.get_best_log_ev(), mcm_resumed.get_best_log_ev());
+    EXPECT_EQ(resumed_searcher.get_top_k(), 5);
+    std::vector<MCM> top_mcms = searcher.get_top_mcms();
+    std::vector<MCM> top_mcms_resumed = resumed_searcher.get_top_mcms();
+    ASSERT_EQ(top_mcms_resumed.size(), 5);
+    for (int i = 0; i < 5; i++){
+        EXPECT_EQ(top_mcms[i].partition, top_mcms_resumed[i].partition);
+    }
+
+    // Exhaustive search that stores the full trajectory (logged next to the checkpoint), resumed after it was stopped
+    // (on one thread such that the search is stopped at the same task in every run)
+    searcher.set_top_k(0);
+    searcher.set_n_threads(1);
+    MCMSearch reference_searcher = MCMSearch();
+    reference_searcher.exhaustive_search(data);
+    int n_calls = 0;
+    searcher.set_progress_callback([&](const SearchProgress& progress){return ++n_calls < 300;}, 1e-9);
+    mcm = searcher.exhaustive_search(data);
+    EXPECT_TRUE(mcm.truncated);
+    searcher.set_progress_callback(ProgressCallback(), 1);
+    mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_test.bin");
+    EXPECT_FALSE(mcm_resumed.truncated);
+    EXPECT_EQ(mcm_resumed.partition, reference_searcher.get_mcm_out().partition);
+    EXPECT_EQ(resumed_searcher.get_log_evidence_trajectory(), reference_searcher.get_log_evidence_trajectory());
+
+    // Simulated annealing
+    searcher.set_SA_max_iter(500);
+    mcm = searcher.simulated_annealing(data);
+    mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_test.bin");
+    EXPECT_TRUE(mcm_resumed.optimized);
+    EXPECT_EQ(resumed_searcher.get_SA_max_iter(), 500);
+
+    // Parallel tempering
+    searcher.set_PT_n_replicas(3);
+    searcher.set_PT_swap_interval(50);
+    mcm = searcher.parallel_tempering(data);
+    mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_test.bin");
+    EXPECT_TRUE(mcm_resumed.optimized);
+    EXPECT_EQ(resumed_searcher.get_PT_n_replicas(), 3);
+    EXPECT_EQ(resumed_searcher.get_PT_swap_interval(), 50);
+    EXPECT_EQ(resumed_searcher.get_PT_swap_acceptance().size(), 2);
+
+    std::remove("checkpoint_test.bin");
+    std::remove("checkpoint_test.bin.trajectory");
+    std::remove("checkpoint_test.bin.cache");
+}
+
+TEST(search, exhaustive_shards) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    Data other_data("../tests/test.dat", 3, 3);
+    MCMSearch searcher = MCMSearch();
+
+    try {
+        searcher.exhaustive_search(data, 3, 3);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The index of the shard should be between 0 and the number of shards - 1."));
+    }
+
+    searcher.set_top_k(5);
+    MCM mcm = searcher.exhaustive_search(data);
+    std::vector<MCM> top_mcms = searcher.get_top_mcms();
+
+    // Every shard is searched by a separate object (as in separate processes)
+    std::vector<std::string> result_files;
+    for (int shard = 0; shard < 3; shard++){
+        MCMSearch shard_searcher = MCMSearch();
+        shard_searcher.set_top_k(5);
+        shard_searcher.set_n_threads(shard + 1);
+        result_files.push_back("shard_test_" + std::to_string(shard) + ".bin");
+        MCM shard_mcm = shard_searcher.exhaustive_search(data, shard, 3, result_files.back());
+        EXPECT_LE(shard_mcm.get_best_log_ev(), mcm.get_best_log_ev());
+    }
+
+    MCMSearch merger = MCMSearch();
+    // All shards are needed
+    try {
+        merger.merge_shards(data, std::vector<std::string>(result_files.begin(), result_files.begin() + 2));
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The result of shard 2 is missing."));
+    }
+    try {
+        merger.merge_shards(other_data, result_files);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The shard results were created for a different dataset."));
+    }
+
+    MCM merged_mcm = merger.merge_shards(data, {result_files[2], result_files[0], result_files[1]});
+    EXPECT_EQ(merged_mcm.partition, mcm.partition);
+    EXPECT_EQ(merged_mcm.get_best_log_ev(), mcm.get_best_log_ev());
+    EXPECT_EQ(merged_mcm.n_comp, 2);
+    EXPECT_EQ(merger.get_log_evidence_summary().count, 21147);
+    EXPECT_EQ(merger.get_log_evidence_summary().max, mcm.get_best_log_ev());
+    std::vector<MCM> merged_top_mcms = merger.get_top_mcms();
+    ASSERT_EQ(merged_top_mcms.size(), 5);
+    for (int i = 0; i < 5; i++){
+        EXPECT_EQ(merged_top_mcms[i].partition, top_mcms[i].partition);
+    }
+
+    for (std::string& file : result_files){
+        std::remove(file.c_str());
+    }
+}
+
+TEST(search, exhaustive_max_component_size) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+
+    try {
+        searcher.set_max_component_size(-1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The maximum number of variables in a component should be a non-negative number."));
+    }
+
+    // Reference: all partitions with components of at most 3 variables, in enumeration order
+    int n = 9;
+    std::vector<int> a(n, 0);
+    std::vector<int> b(n, 1);
+    std::vector<double> admissible_evs;
+    do {
+        std::vector<__uint128_t> partition(n, 0);
+        convert_partition(a.data(), partition, n);
+        bool admissible = true;
+        double log_ev = 0;
+        for (__uint128_t component : partition){
+            if (bit_count(component) > 3){admissible = false;}
+            if (component){log_ev += data.calc_log_ev_icc(component);}
+        }
+        if (admissible){admissible_evs.push_back(log_ev);}
+    } while (generate_next_partition(a.data(), b.data(), n));
+    EXPECT_EQ(count_partitions_with_prefix(std::vector<int>(1, 0), n, 3), admissible_evs.size());
+
+    searcher.set_max_component_size(3);
+    EXPECT_EQ(searcher.get_max_component_size(), 3);
+    MCM mcm = searcher.exhaustive_search(data);
+    EXPECT_EQ(searcher.get_log_evidence_trajectory(), admissible_evs);
+    EXPECT_EQ(mcm.get_best_log_ev(), *std::max_element(admissible_evs.begin(), admissible_evs.end()));
+    for (__uint128_t component : mcm.partition){
+        EXPECT_LE(bit_count(component), 3);
+    }
+
+    // Same order and result when the search is divided over threads
+    searcher.set_n_threads(3);
+    searcher.set_trajectory_policy("every_k");
+    searcher.set_trajectory_interval(7);
+    MCM mcm_parallel = searcher.exhaustive_search(data);
+    EXPECT_EQ(mcm.partition, mcm_parallel.partition);
+    std::vector<double> values = searcher.get_log_evidence_trajectory();
+    std::vector<unsigned long long> steps = searcher.get_log_evidence_trajectory_steps();
+    ASSERT_EQ(values.size(), (admissible_evs.size() + 6) / 7);
+    for (int i = 0; i < values.size(); i++){
+        EXPECT_EQ(steps[i], 7 * i);
+        EXPECT_EQ(values[i], admissible_evs[7 * i]);
+    }
+
+    // A maximum of at least n variables doesn't restrict the search
+    searcher.set_max_component_size(9);
+    searcher.set_trajectory_policy("all");
+    searcher.exhaustive_search(data);
+    EXPECT_EQ(searcher.get_log_evidence_trajectory().size(), 21147);
+}
+
+TEST(search, greedy_priority_queue) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    MCM mcm = searcher.greedy_search(data);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+
+    // Reference: rescan all pairs of components after every merge
+    int n = 9;
+    MCM ref(n, "independent");
+    std::vector<double> log_ev_per_icc(n);
+    double log_ev = 0;
+    for (int i = 0; i < n; i++){
+        log_ev_per_icc[i] = data.calc_log_ev_icc(ref.partition[i]);
+        log_ev += log_ev_per_icc[i];
+    }
+    std::vector<double> ref_trajectory(1, log_ev);
+    while (true){
+        double best_diff = 0;
+        double best_log_ev = 0;
+        int best_i = -1;
+        int best_j = -1;
+        for (int i = 0; i < n; i++){
+            if (ref.partition[i] == 0){continue;}
+            for (int j = i+1; j < n; j++){
+                if (ref.partition[j] == 0){continue;}
+                double log_ev_ij = data.calc_log_ev_icc(ref.partition[i] + ref.partition[j]);
+                double diff = log_ev_ij - log_ev_per_icc[i] - log_ev_per_icc[j];
+                if (diff > best_diff){
+                    best_diff = diff;
+                    best_log_ev = log_ev_ij;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        if (best_i < 0){break;}
+        ref.partition[best_i] += ref.partition[best_j];
+        ref.partition[best_j] = 0;
+        log_ev_per_icc[best_i] = best_log_ev;
+        log_ev_per_icc[best_j] = 0;
+        log_ev += best_diff;
+        ref_trajectory.push_back(log_ev);
+    }
+    place_empty_entries_last(ref.partition);
+
+    EXPECT_EQ(mcm.partition, ref.partition);
+    EXPECT_EQ(trajectory, ref_trajectory);
+    EXPECT_EQ(mcm.get_best_log_ev(), log_ev);
+}
+
+TEST(search, greedy_threads) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    MCM mcm_serial = searcher.greedy_search(data);
+    std::vector<double> trajectory_serial = searcher.get_log_evidence_trajectory();
+
+    // Candidates are evaluated in parallel, the merges are chosen in the same order
+    searcher.set_n_threads(4);
+    MCM mcm_parallel = searcher.greedy_search(data);
+    EXPECT_EQ(mcm_serial.partition, mcm_parallel.partition);
+    EXPECT_EQ(mcm_serial.get_best_log_ev(), mcm_parallel.get_best_log_ev());
+    EXPECT_EQ(trajectory_serial, searcher.get_log_evidence_trajectory());
+
+    // The final merging pass of simulated annealing uses the same parallel stage
+    searcher.set_SA_max_iter(2000);
+    MCM mcm_annealing = searcher.simulated_annealing(data);
+    EXPECT_TRUE(mcm_annealing.optimized);
+    EXPECT_NEAR(mcm_annealing.get_best_log_ev(), data.calc_log_ev(mcm_annealing.partition), 1e-6);
+}
+
+TEST(search, greedy_beam) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_THROW(searcher.set_beam_width(0), std::invalid_argument);
+    EXPECT_EQ(searcher.get_beam_width(), 1);
+    MCM mcm_greedy = searcher.greedy_search(data);
+
+    // A beam of width B explores the B best merges of the B best partitions in every round
+    searcher.set_beam_width(4);
+    MCM mcm_beam = searcher.greedy_search(data);
+    EXPECT_TRUE(mcm_beam.optimized);
+    EXPECT_GE(mcm_beam.get_best_log_ev(), mcm_greedy.get_best_log_ev() - 1e-9);
+    EXPECT_NEAR(mcm_beam.get_best_log_ev(), data.calc_log_ev(mcm_beam.partition), 1e-6);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    for (size_t i = 1; i < trajectory.size(); i++){
+        EXPECT_GE(trajectory[i], trajectory[i-1]);
+    }
+
+    // The beam does not depend on the number of threads
+    searcher.set_n_threads(3);
+    MCM mcm_parallel = searcher.greedy_search(data);
+    EXPECT_EQ(mcm_beam.partition, mcm_parallel.partition);
+    EXPECT_EQ(mcm_beam.get_best_log_ev(), mcm_parallel.get_best_log_ev());
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+
+    // The beam is stored in the checkpoint
+    searcher.set_checkpoint("checkpoint_beam_test.bin", 0);
+    searcher.greedy_search(data);
+    MCMSearch resumed_searcher = MCMSearch();
+    MCM mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_beam_test.bin");
+    EXPECT_EQ(resumed_searcher.get_beam_width(), 4);
+    EXPECT_EQ(mcm_beam.partition, mcm_resumed.partition);
+    EXPECT_EQ(trajectory, resumed_searcher.get_log_evidence_trajectory());
+    std::remove("checkpoint_beam_test.bin");
+    std::remove("checkpoint_beam_test.bin.trajectory");
+    std::remove("checkpoint_beam_test.bin.cache");
+}
+
+TEST(search, greedy_dendrogram) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    MCM mcm_greedy = searcher.greedy_search(data);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+
+    // By default, the tree ends at the result of the search
+    EXPECT_FALSE(searcher.get_full_dendrogram());
+    EXPECT_EQ(searcher.get_dendrogram().get_n_merges(), trajectory.size() - 1);
+    EXPECT_EQ(searcher.get_dendrogram().get_best_n_merges(), trajectory.size() - 1);
+
+    // The full tree continues merging until a single component is left, the result doesn't change
+    searcher.set_full_dendrogram(true);
+    MCM mcm_full = searcher.greedy_search(data);
+    EXPECT_EQ(mcm_greedy.partition, mcm_full.partition);
+    EXPECT_EQ(mcm_greedy.get_best_log_ev(), mcm_full.get_best_log_ev());
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+
+    const Dendrogram& dendrogram = searcher.get_dendrogram();
+    EXPECT_EQ(dendrogram.get_n_merges(), 8);
+    EXPECT_EQ(dendrogram.get_best_n_merges(), trajectory.size() - 1);
+    for (int k = 0; k <= dendrogram.get_n_merges(); k++){
+        MCM mcm_cut = searcher.get_dendrogram_cut(k);
+        EXPECT_EQ(mcm_cut.n_comp, 9 - k);
+        EXPECT_NEAR(mcm_cut.get_best_log_ev(), data.calc_log_ev(mcm_cut.partition), 1e-6);
+    }
+    EXPECT_EQ(searcher.get_dendrogram_cut(dendrogram.get_best_n_merges()).partition, mcm_greedy.partition);
+    EXPECT_THROW(searcher.get_dendrogram_cut(9), std::invalid_argument);
+
+    // The tree is part of the checkpoint
+    searcher.set_checkpoint("checkpoint_dendrogram_test.bin", 0);
+    searcher.greedy_search(data);
+    MCMSearch resumed_searcher = MCMSearch();
+    MCM mcm_resumed = resumed_searcher.resume_search(data, "checkpoint_dendrogram_test.bin");
+    EXPECT_EQ(mcm_greedy.partition, mcm_resumed.partition);
+    EXPECT_EQ(resumed_searcher.get_dendrogram().get_n_merges(), 8);
+    EXPECT_EQ(resumed_searcher.get_dendrogram_cut(8).n_comp, 1);
+    searcher.set_checkpoint("", 0);
+    std::remove("checkpoint_dendrogram_test.bin");
+    std::remove("checkpoint_dendrogram_test.bin.trajectory");
+    std::remove("checkpoint_dendrogram_test.bin.cache");
+
+    // Other search methods don't record a tree
+    searcher.divide_and_conquer(data);
+    EXPECT_EQ(searcher.get_dendrogram().get_n_merges(), 0);
+    EXPECT_THROW(searcher.get_dendrogram_cut(0), std::runtime_error);
+}
+
+TEST(search, div_and_conq_threads) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    MCM mcm_serial = searcher.divide_and_conquer(data);
+    std::vector<double> trajectory_serial = searcher.get_log_evidence_trajectory();
+
+    // Components on the stack and the moves within a component are evaluated in parallel, the splits are applied in the same order
+    for (int n_threads : {2, 4, 16}){
+        searcher.set_n_threads(n_threads);
+        MCM mcm_parallel = searcher.divide_and_conquer(data);
+        EXPECT_EQ(mcm_serial.partition, mcm_parallel.partition);
+        EXPECT_EQ(mcm_serial.get_best_log_ev(), mcm_parallel.get_best_log_ev());
+        EXPECT_EQ(trajectory_serial, searcher.get_log_evidence_trajectory());
+    }
+
+    // Same result when starting from a given partition
+    MCM mcm_in(9, std::vector<__uint128_t>{0b000001111, 0b111110000});
+    searcher.set_n_threads(1);
+    mcm_serial = searcher.divide_and_conquer(data, &mcm_in);
+    searcher.set_n_threads(4);
+    MCM mcm_parallel = searcher.divide_and_conquer(data, &mcm_in);
+    EXPECT_EQ(mcm_serial.partition, mcm_parallel.partition);
+    EXPECT_EQ(mcm_serial.get_best_log_ev(), mcm_parallel.get_best_log_ev());
+}
+
+TEST(search, refine) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+
+    // Refinement needs a partition
+    try {
+        searcher.refine(data);
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch(std::runtime_error const & err) {
+        EXPECT_EQ(err.what(), std::string("No search has been run before, give the MCM that should be refined."));
+    }
+
+    // Refining a poor partition
+    MCM mcm_in(9, std::vector<__uint128_t>{0b101010101, 0b010101010});
+    MCM mcm_refined = searcher.refine(data, &mcm_in);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    EXPECT_TRUE(mcm_refined.optimized);
+    EXPECT_GT(mcm_refined.get_best_log_ev(), data.calc_log_ev(mcm_in.partition));
+    EXPECT_NEAR(mcm_refined.get_best_log_ev(), data.calc_log_ev(mcm_refined.partition), 1e-6);
+    for (size_t i = 1; i < trajectory.size(); i++){
+        EXPECT_GT(trajectory[i], trajectory[i-1]);
+    }
+
+    // No single move of a variable improves the refined partition
+    for (int v = 0; v < 9; v++){
+        __uint128_t bit = (__uint128_t) 1 << v;
+        int from = 0;
+        while (!(mcm_refined.partition[from] & bit)){from++;}
+        for (int to = 0; to < 9; to++){
+            if (to == from || (mcm_refined.partition[to] == 0 && bit_count(mcm_refined.partition[from]) == 1)){continue;}
+            std::vector<__uint128_t> partition = mcm_refined.partition;
+            partition[from] -= bit;
+            partition[to] += bit;
+            EXPECT_LE(data.calc_log_ev(partition), mcm_refined.get_best_log_ev() + 1e-6);
+        }
+    }
+
+    // The result does not depend on the number of threads
+    searcher.set_n_threads(4);
+    MCM mcm_parallel = searcher.refine(data, &mcm_in);
+    EXPECT_EQ(mcm_refined.partition, mcm_parallel.partition);
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+
+    // Post-processing of the result of a search
+    MCM mcm_greedy = searcher.greedy_search(data);
+    MCM mcm_post = searcher.refine(data);
+    EXPECT_GE(mcm_post.get_best_log_ev(), mcm_greedy.get_best_log_ev() - 1e-6);
+    EXPECT_EQ(searcher.get_mcm_in().partition, mcm_greedy.partition);
+
+    // Wrong number of variables
+    MCM mcm_wrong(4);
+    EXPECT_THROW(searcher.refine(data, &mcm_wrong), std::invalid_argument);
+}
+
+TEST(search, greedy_pruning) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+
+    // The bound is never below the gain of a merge
+    std::vector<__uint128_t> components = {1, 2, 3, 12, 48, 7, 256, 448, 120};
+    for (__uint128_t a : components){
+        for (__uint128_t b : components){
+            if (a & b){continue;}
+            double log_ev_a = data.calc_log_ev_icc(a);
+            double log_ev_b = data.calc_log_ev_icc(b);
+            EXPECT_GE(merge_gain_bound(data, a, b, log_ev_a, log_ev_b), data.calc_log_ev_icc(a + b) - log_ev_a - log_ev_b);
+        }
+    }
+
+    // Two groups of four coupled variables and four variables that are almost always 0
+    std::mt19937 generator(3);
+    std::ofstream file("sparse_test.dat");
+    for (int s = 0; s < 1000; s++){
+        int a = generator() % 2;
+        int b = generator() % 2;
+        for (int i = 0; i < 12; i++){
+            if (i < 4){file << ((generator() % 10 == 0) ? 1-a : a);}
+            else if (i < 8){file << ((generator() % 10 == 0) ? 1-b : b);}
+            else {file << (generator() % 500 == 0);}
+        }
+        file << "\n";
+    }
+    file.close();
+    data = Data("sparse_test.dat", 12, 2);
+    std::remove("sparse_test.dat");
+
+    MCMSearch searcher = MCMSearch();
+    EXPECT_TRUE(searcher.get_merge_pruning());
+    MCM mcm_pruned = searcher.greedy_search(data);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    MergeStatistics statistics = searcher.get_merge_statistics();
+    EXPECT_EQ(statistics.n_candidates, statistics.n_evaluated + statistics.n_pruned_bound + statistics.n_pruned_best);
+    EXPECT_LT(statistics.n_evaluated, statistics.n_candidates);
+
+    // Pruning doesn't change the result
+    searcher.set_merge_pruning(false);
+    MCM mcm_full = searcher.greedy_search(data);
+    EXPECT_EQ(mcm_pruned.partition, mcm_full.partition);
+    EXPECT_EQ(mcm_pruned.get_best_log_ev(), mcm_full.get_best_log_ev());
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+    statistics = searcher.get_merge_statistics();
+    EXPECT_EQ(statistics.n_candidates, statistics.n_evaluated);
+    EXPECT_EQ(statistics.n_pruned_bound + statistics.n_pruned_best, 0);
+
+    // Also not with several threads or for the full merge tree
+    searcher.set_merge_pruning(true);
+    searcher.set_n_threads(3);
+    searcher.set_full_dendrogram(true);
+    MCM mcm_parallel = searcher.greedy_search(data);
+    EXPECT_EQ(mcm_pruned.partition, mcm_parallel.partition);
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+    EXPECT_EQ(searcher.get_dendrogram().get_n_merges(), 11);
+}
+
+TEST(search, interaction_graph) {
+    // Mutual information from the entropies of the pairs
+    auto entropy = [](Data& data, __uint128_t component){
+        double H = 0;
+        for (auto& count : build_histogram(data, component)){
+            double p = (double) count.second / data.N;
+            H -= p * log(p) / log(data.q);
+        }
+        return H;
+    };
+    Data data_q3("../tests/test.dat", 3, 3);
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    for (Data* d : {&data_q3, &data}){
+        std::vector<double> mutual_information = calc_mutual_information(*d, 2);
+        for (int i = 0; i < d->n; i++){
+            EXPECT_EQ(mutual_information[i * d->n + i], 0);
+            for (int j = i+1; j < d->n; j++){
+                __uint128_t var_i = (__uint128_t) 1 << i;
+                __uint128_t var_j = (__uint128_t) 1 << j;
+                EXPECT_NEAR(mutual_information[i * d->n + j], entropy(*d, var_i) + entropy(*d, var_j) - entropy(*d, var_i + var_j), 1e-9);
+                EXPECT_EQ(mutual_information[i * d->n + j], mutual_information[j * d->n + i]);
+            }
+        }
+    }
+
+    // Symmetric k-nearest-neighbour graph
+    std::vector<__uint128_t> graph = build_interaction_graph(calc_mutual_information(data), 9, 2);
+    for (int i = 0; i < 9; i++){
+        EXPECT_GE(bit_count(graph[i]), 2);
+        EXPECT_EQ(graph[i] & ((__uint128_t) 1 << i), 0);
+        for (int j = 0; j < 9; j++){
+            EXPECT_EQ((bool) (graph[i] & ((__uint128_t) 1 << j)), (bool) (graph[j] & ((__uint128_t) 1 << i)));
+        }
+    }
+    EXPECT_EQ(neighbourhood(graph, 3), graph[0] | graph[1]);
+
+    MCMSearch searcher = MCMSearch();
+    EXPECT_THROW(searcher.set_interaction_neighbours(-1), std::invalid_argument);
+    MCM mcm_greedy = searcher.greedy_search(data);
+    MergeStatistics statistics = searcher.get_merge_statistics();
+    EXPECT_TRUE(searcher.get_interaction_graph().empty());
+
+    // With n-1 neighbours, all pairs interact
+    searcher.set_interaction_neighbours(8);
+    EXPECT_EQ(searcher.greedy_search(data).partition, mcm_greedy.partition);
+    EXPECT_TRUE(searcher.get_interaction_graph().empty());
+
+    // Only the pairs of the graph are candidates
+    searcher.set_interaction_neighbours(2);
+    MCM mcm_sparse = searcher.greedy_search(data);
+    EXPECT_EQ(searcher.get_interaction_graph(), graph);
+    EXPECT_EQ(searcher.get_mutual_information().size(), 81);
+    EXPECT_LT(searcher.get_merge_statistics().n_candidates, statistics.n_candidates);
+    EXPECT_NEAR(mcm_sparse.get_best_log_ev(), data.calc_log_ev(mcm_sparse.partition), 1e-6);
+
+    // The divisive search and simulated annealing use the same graph
+    MCM mcm_div = searcher.divide_and_conquer(data);
+    EXPECT_NEAR(mcm_div.get_best_log_ev(), data.calc_log_ev(mcm_div.partition), 1e-6);
+    searcher.set_SA_max_iter(5000);
+    MCM mcm_sa = searcher.simulated_annealing(data);
+    EXPECT_NEAR(mcm_sa.get_best_log_ev(), data.calc_log_ev(mcm_sa.partition), 1e-6);
+    EXPECT_EQ(searcher.get_interaction_graph(), graph);
+}
+
+TEST(search, multilevel) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_multilevel_group_size(), 4);
+    EXPECT_EQ(searcher.get_multilevel_coarse_search(), "greedy");
+    try {
+        searcher.set_multilevel_group_size(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The maximum number of variables in a group of the multilevel search should be a positive number."));
+    }
+    try {
+        searcher.set_multilevel_coarse_search("exhaustive");
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Invalid search method for the coarsest level. Options are 'greedy' or 'annealing'."));
+    }
+
+    MCM mcm_multilevel = searcher.multilevel_search(data);
+    EXPECT_TRUE(mcm_multilevel.optimized);
+    EXPECT_NEAR(mcm_multilevel.get_best_log_ev(), data.calc_log_ev(mcm_multilevel.partition), 1e-6);
+
+    // Every level divides the variables into groups that are at most as large as the maximum size
+    std::vector<std::vector<__uint128_t>> levels = searcher.get_coarsening_levels();
+    EXPECT_GT(levels.size(), 1);
+    EXPECT_EQ(levels[0].size(), 9);
+    for (size_t l = 0; l < levels.size(); l++){
+        __uint128_t variables = 0;
+        for (__uint128_t group : levels[l]){
+            EXPECT_EQ(variables & group, 0);
+            EXPECT_LE(bit_count(group), 4);
+            variables += group;
+        }
+        EXPECT_EQ(variables, 511);
+        if (l > 0){EXPECT_LT(levels[l].size(), levels[l-1].size());}
+    }
+
+    // No single move of a variable improves the result
+    for (int v = 0; v < 9; v++){
+        __uint128_t bit = (__uint128_t) 1 << v;
+        int from = 0;
+        while (!(mcm_multilevel.partition[from] & bit)){from++;}
+        for (int to = 0; to < 9; to++){
+            if (to == from || (mcm_multilevel.partition[to] == 0 && bit_count(mcm_multilevel.partition[from]) == 1)){continue;}
+            std::vector<__uint128_t> partition = mcm_multilevel.partition;
+            partition[from] -= bit;
+            partition[to] += bit;
+            EXPECT_LE(data.calc_log_ev(partition), mcm_multilevel.get_best_log_ev() + 1e-6);
+        }
+    }
+
+    // The result does not depend on the number of threads
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    searcher.set_n_threads(3);
+    EXPECT_EQ(searcher.multilevel_search(data).partition, mcm_multilevel.partition);
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+
+    // Without coarsening, the search starts from the independent model
+    searcher.set_multilevel_group_size(1);
+    MCM mcm_single = searcher.multilevel_search(data);
+    EXPECT_EQ(searcher.get_coarsening_levels().size(), 1);
+    EXPECT_GE(mcm_single.get_best_log_ev(), searcher.greedy_search(data).get_best_log_ev() - 1e-6);
+
+    // Simulated annealing on the coarsest level
+    searcher.set_multilevel_group_size(4);
+    searcher.set_multilevel_coarse_search("annealing");
+    searcher.set_SA_max_iter(5000);
+    MCM mcm_sa = searcher.multilevel_search(data);
+    EXPECT_NEAR(mcm_sa.get_best_log_ev(), data.calc_log_ev(mcm_sa.partition), 1e-6);
+}
+
+TEST(search, polish) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_polish_size(), 12);
+    try {
+        searcher.polish(data);
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch(std::runtime_error const & err) {
+        EXPECT_EQ(err.what(), std::string("No search has been run before, give the MCM that should be polished."));
+    }
+    try {
+        searcher.set_polish_size(21);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The maximum number of variables in a polished union of components should be between 1 and 20."));
+    }
+
+    // With all variables in a single union, the result is the best partition
+    MCM mcm_exhaustive = searcher.exhaustive_search(data);
+    MCM mcm_in(9, std::vector<__uint128_t>{0b101010101, 0b010101010});
+    MCM mcm_polished = searcher.polish(data, &mcm_in);
+    EXPECT_TRUE(mcm_polished.optimized);
+    EXPECT_NEAR(mcm_polished.get_best_log_ev(), mcm_exhaustive.get_best_log_ev(), 1e-6);
+    EXPECT_NEAR(mcm_polished.get_best_log_ev(), data.calc_log_ev(mcm_polished.partition), 1e-6);
+
+    // Unions of at most 4 variables starting from small components
+    searcher.set_polish_size(4);
+    mcm_in = MCM(9, std::vector<__uint128_t>{0b100000001, 0b000000110, 0b000011000, 0b001100000, 0b010000000});
+    mcm_polished = searcher.polish(data, &mcm_in);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    EXPECT_GT(mcm_polished.get_best_log_ev(), data.calc_log_ev(mcm_in.partition));
+    EXPECT_NEAR(mcm_polished.get_best_log_ev(), data.calc_log_ev(mcm_polished.partition), 1e-6);
+    for (size_t i = 1; i < trajectory.size(); i++){
+        EXPECT_GT(trajectory[i], trajectory[i-1]);
+    }
+    for (int i = 0; i < mcm_polished.n_comp; i++){
+        EXPECT_LE(bit_count(mcm_polished.partition[i]), 4);
+    }
+
+    // The result does not depend on the number of threads
+    searcher.set_n_threads(4);
+    EXPECT_EQ(searcher.polish(data, &mcm_in).partition, mcm_polished.partition);
+    EXPECT_EQ(trajectory, searcher.get_log_evidence_trajectory());
+
+    // Post-processing of the result of a search doesn't decrease the evidence
+    searcher.set_polish_size(12);
+    MCM mcm_greedy = searcher.greedy_search(data);
+    EXPECT_GE(searcher.polish(data).get_best_log_ev(), mcm_greedy.get_best_log_ev() - 1e-6);
+
+    // Wrong number of variables
+    MCM mcm_wrong(4);
+    EXPECT_THROW(searcher.polish(data, &mcm_wrong), std::invalid_argument);
+}
+
+TEST(search, parallel_tempering) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_THROW(searcher.get_PT_swap_acceptance(), std::runtime_error);
+    try {
+        searcher.set_PT_n_replicas(1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of replicas should be at least 2."));
+    }
+    EXPECT_THROW(searcher.set_PT_min_temp(0), std::invalid_argument);
+    EXPECT_THROW(searcher.set_PT_max_temp(-1), std::invalid_argument);
+    EXPECT_THROW(searcher.set_PT_swap_interval(0), std::invalid_argument);
+
+    // Geometric temperature ladder
+    searcher.set_PT_n_replicas(3);
+    searcher.set_PT_min_temp(2);
+    searcher.set_PT_max_temp(50);
+    std::vector<double> temperatures = searcher.get_PT_temperatures();
+    ASSERT_EQ(temperatures.size(), 3);
+    EXPECT_NEAR(temperatures[0], 2, 1e-9);
+    EXPECT_NEAR(temperatures[1], 10, 1e-9);
+    EXPECT_NEAR(temperatures[2], 50, 1e-9);
+
+    searcher.set_PT_min_temp(100);
+    try {
+        searcher.parallel_tempering(data);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The minimum temperature of the replicas should not be larger than the maximum temperature."));
+    }
+
+    // Replicas in parallel through the shared evidence cache
+    searcher.set_PT_min_temp(1);
+    searcher.set_PT_n_replicas(4);
+    searcher.set_SA_max_iter(2000);
+    searcher.set_n_threads(2);
+    MCM mcm_pt = searcher.parallel_tempering(data);
+    EXPECT_TRUE(mcm_pt.optimized);
+    EXPECT_NEAR(mcm_pt.get_best_log_ev(), data.calc_log_ev(mcm_pt.partition), 1e-6);
+    MCM mcm_in = searcher.get_mcm_in();
+    EXPECT_GE(mcm_pt.get_best_log_ev(), data.calc_log_ev(mcm_in.partition));
+
+    // A trajectory value after every round of swaps
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    EXPECT_GE(trajectory.size(), 2000 / searcher.get_PT_swap_interval() + 1);
+    for (size_t i = 1; i < trajectory.size(); i++){
+        EXPECT_GE(trajectory[i], trajectory[i-1]);
+    }
+
+    std::vector<double> acceptance = searcher.get_PT_swap_acceptance();
+    ASSERT_EQ(acceptance.size(), 3);
+    for (double rate : acceptance){
+        EXPECT_GE(rate, 0);
+        EXPECT_LE(rate, 1);
+    }
+}
+
+TEST(search, multistart) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_multistart_restarts(), 16);
+    EXPECT_EQ(searcher.get_multistart_patience(), 0);
+    EXPECT_THROW(searcher.get_multistart_log_evidences(), std::runtime_error);
+    EXPECT_THROW(searcher.set_multistart_restarts(0), std::invalid_argument);
+    EXPECT_THROW(searcher.set_multistart_patience(-1), std::invalid_argument);
+    try {
+        searcher.multistart_search(data, "exhaustive");
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Invalid search method for the restarts. Options are 'greedy', 'divide_and_conquer' or 'annealing'."));
+    }
+
+    // The best restart is at least as good as every single restart
+    searcher.set_multistart_restarts(8);
+    searcher.set_n_threads(3);
+    searcher.set_seed(7);
+    MCM mcm_best = searcher.multistart_search(data, "greedy");
+    EXPECT_TRUE(mcm_best.optimized);
+    EXPECT_NEAR(mcm_best.get_best_log_ev(), data.calc_log_ev(mcm_best.partition), 1e-6);
+    std::vector<double> log_evidences = searcher.get_multistart_log_evidences();
+    ASSERT_EQ(log_evidences.size(), 8);
+    for (double log_ev : log_evidences){
+        EXPECT_LE(log_ev, mcm_best.get_best_log_ev() + 1e-9);
+    }
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    ASSERT_EQ(trajectory.size(), 8);
+    EXPECT_NEAR(trajectory.back(), mcm_best.get_best_log_ev(), 1e-9);
+
+    // A restart from the best starting partition gives the same result
+    MCM mcm_in = searcher.get_mcm_in();
+    EXPECT_EQ(searcher.greedy_search(data, &mcm_in).partition, mcm_best.partition);
+
+    // The greedy restarts are deterministic, so the result doesn't depend on the number of threads
+    searcher.set_n_threads(1);
+    searcher.set_seed(7);
+    EXPECT_EQ(searcher.multistart_search(data, "greedy").partition, mcm_best.partition);
+    EXPECT_EQ(searcher.get_multistart_log_evidences(), log_evidences);
+
+    // Early stopping once the best value is found twice
+    searcher.set_multistart_patience(2);
+    searcher.set_n_threads(2);
+    searcher.set_multistart_restarts(50);
+    searcher.set_seed(7);
+    mcm_best = searcher.multistart_search(data, "greedy");
+    log_evidences = searcher.get_multistart_log_evidences();
+    EXPECT_LT(log_evidences.size(), 50);
+    int n_best = 0;
+    for (double log_ev : log_evidences){
+        if (std::abs(log_ev - mcm_best.get_best_log_ev()) < 1e-6){n_best++;}
+    }
+    EXPECT_EQ(n_best, 2);
+
+    searcher.set_SA_max_iter(2000);
+    searcher.set_multistart_restarts(4);
+    searcher.set_multistart_patience(0);
+    for (std::string method : {"divide_and_conquer", "annealing"}){
+        mcm_best = searcher.multistart_search(data, method);
+        EXPECT_EQ(searcher.get_multistart_log_evidences().size(), 4);
+        EXPECT_NEAR(mcm_best.get_best_log_ev(), data.calc_log_ev(mcm_best.partition), 1e-6);
+    }
+}
+
+TEST(search, seed) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    searcher.set_seed(3);
+    EXPECT_EQ(searcher.get_seed(), 3);
+    searcher.set_SA_max_iter(2000);
+
+    // The same seed gives the same annealing run
+    MCM mcm_sa = searcher.simulated_annealing(data);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    searcher.set_seed(3);
+    EXPECT_EQ(searcher.simulated_annealing(data).partition, mcm_sa.partition);
+    EXPECT_EQ(searcher.get_log_evidence_trajectory(), trajectory);
+
+    // Every replica and every restart has its own stream, so the result doesn't depend on the number of threads
+    searcher.set_PT_n_replicas(3);
+    searcher.set_seed(3);
+    MCM mcm_pt = searcher.parallel_tempering(data);
+    trajectory = searcher.get_log_evidence_trajectory();
+    searcher.set_n_threads(3);
+    searcher.set_seed(3);
+    EXPECT_EQ(searcher.parallel_tempering(data).partition, mcm_pt.partition);
+    EXPECT_EQ(searcher.get_log_evidence_trajectory(), trajectory);
+
+    searcher.set_multistart_restarts(4);
+    MCM mcm_ms = searcher.multistart_search(data, "annealing");
+    std::vector<double> log_evidences = searcher.get_multistart_log_evidences();
+    searcher.set_n_threads(1);
+    searcher.set_seed(3);
+    searcher.parallel_tempering(data);
+    EXPECT_EQ(searcher.multistart_search(data, "annealing").partition, mcm_ms.partition);
+    EXPECT_EQ(searcher.get_multistart_log_evidences(), log_evidences);
+}
+
+TEST(search, component_index) {
+    std::vector<__uint128_t> partition = {0b0000011, 0, 0b1111100, 0};
+    partition.resize(7, 0);
+    ComponentIndex index;
+    index.build(partition);
+    EXPECT_EQ(index.n_occupied(), 2);
+    EXPECT_EQ(index.n_splittable(), 2);
+    EXPECT_EQ(index.occupied_mask(), 0b101);
+    EXPECT_EQ(index.empty_component(), 1);
+    EXPECT_EQ(index.component_of(4), 2);
+    EXPECT_EQ(index.components_of(0b0100001), 0b101);
+
+    // Every non-trivial split of a component of 5 variables is drawn
+    RandomGenerator generator(1);
+    std::set<__uint128_t> splits;
+    for (int i = 0; i < 2000; i++){
+        __uint128_t split = index.random_split(2, generator);
+        EXPECT_NE(split, 0);
+        EXPECT_NE(split, partition[2]);
+        EXPECT_EQ(split & ~partition[2], 0);
+        splits.insert(split);
+
+        int unit = index.random_unit(2, generator);
+        EXPECT_TRUE((partition[2] >> unit) & 1);
+        EXPECT_NE(index.random_other_occupied(0, generator), 0);
+    }
+    EXPECT_EQ(splits.size(), 30);
+
+    // Split into the first empty component, move a variable and merge again
+    index.split(2, index.empty_component(), 0b0001100);
+    EXPECT_EQ(index.n_occupied(), 3);
+    EXPECT_EQ(index.component_of(3), 1);
+    EXPECT_EQ(index.empty_component(), 3);
+    index.move(0, 1);
+    EXPECT_EQ(index.n_splittable(), 2);
+    EXPECT_EQ(index.size(1), 3);
+    index.merge(2, 0);
+    EXPECT_EQ(index.n_occupied(), 2);
+    EXPECT_EQ(index.size(2), 4);
+    EXPECT_EQ(index.occupied_mask(), 0b110);
+    EXPECT_EQ(index.empty_component(), 0);
+
+    // An index of groups of variables only splits and moves whole groups
+    std::vector<__uint128_t> units = {0b0000011, 0b0001100, 0b0110000, 0b1000000};
+    index.build(partition, units);
+    EXPECT_EQ(index.n_units(), 4);
+    EXPECT_EQ(index.n_splittable(), 1);
+    EXPECT_EQ(index.size(2), 3);
+    EXPECT_EQ(index.component_of(5), 2);
+    splits.clear();
+    for (int i = 0; i < 2000; i++){
+        __uint128_t split = index.random_split(2, generator);
+        for (__uint128_t unit : units){
+            EXPECT_TRUE((split & unit) == 0 || (split & unit) == unit);
+        }
+        EXPECT_NE(split, partition[2]);
+        splits.insert(split);
+
+        int unit = index.random_unit(2, generator);
+        EXPECT_EQ(units[unit] & ~partition[2], 0);
+    }
+    EXPECT_EQ(splits.size(), 6);
+    index.split(2, index.empty_component(), 0b0001100);
+    EXPECT_EQ(index.component_of(2), 1);
+    EXPECT_EQ(index.component_of(3), 1);
+    EXPECT_EQ(index.size(2), 2);
+    index.move(3, 0);
+    EXPECT_EQ(index.component_of(6), 0);
+    EXPECT_EQ(index.size(0), 2);
+    EXPECT_EQ(index.components_of(0b1000100), 0b11);
+}
+
+TEST(search, SA_batch) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_SA_batch_size(), 1);
+    try {
+        searcher.set_SA_batch_size(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of moves proposed at once should be a positive number."));
+    }
+
+    searcher.set_SA_max_iter(5000);
+    searcher.set_seed(5);
+    MCM mcm_seq = searcher.simulated_annealing(data);
+
+    // The batches are drawn from the generator of the search, so the result doesn't depend on the number of threads
+    searcher.set_SA_batch_size(8);
+    searcher.set_seed(5);
+    MCM mcm_batch = searcher.simulated_annealing(data);
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    EXPECT_EQ(searcher.get_SA_batch_size(), 8);
+    EXPECT_FLOAT_EQ(mcm_batch.get_best_log_ev(), data.calc_log_ev(mcm_batch.partition));
+    EXPECT_FLOAT_EQ(mcm_batch.get_best_log_ev(), mcm_seq.get_best_log_ev());
+
+    searcher.set_n_threads(3);
+    searcher.set_seed(5);
+    EXPECT_EQ(searcher.simulated_annealing(data).partition, mcm_batch.partition);
+    EXPECT_EQ(searcher.get_log_evidence_trajectory(), trajectory);
+}
+
+TEST(search, SA_schedule) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_SA_schedule(), "logarithmic");
+    EXPECT_EQ(searcher.get_SA_max_no_improve(), 10000);
+    EXPECT_EQ(searcher.get_SA_reheats(), 0);
+
+    try {
+        searcher.set_SA_schedule("exponential");
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Invalid cooling schedule. Options are 'logarithmic', 'geometric', 'linear' or 'adaptive'."));
+    }
+    try {
+        searcher.set_SA_cooling_rate(1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The cooling rate should be between 0 and 1."));
+    }
+    try {
+        searcher.set_SA_min_temp(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The minimum annealing temperature should be positive."));
+    }
+    try {
+        searcher.set_SA_target_acceptance(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The target acceptance rate should be between 0 and 1."));
+    }
+    try {
+        searcher.set_SA_max_no_improve(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of iterations without improvement should be a positive number."));
+    }
+    try {
+        searcher.set_SA_reheats(-1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of reheats should be a non-negative number."));
+    }
+
+    // Temperatures are floating point numbers
+    searcher.set_SA_init_temp(2.5);
+    EXPECT_DOUBLE_EQ(searcher.get_SA_init_temp(), 2.5);
+    searcher.set_SA_cooling_rate(0.9);
+    EXPECT_DOUBLE_EQ(searcher.get_SA_cooling_rate(), 0.9);
+    searcher.set_SA_min_temp(0.05);
+    EXPECT_DOUBLE_EQ(searcher.get_SA_min_temp(), 0.05);
+    searcher.set_SA_target_acceptance(0.3);
+    EXPECT_DOUBLE_EQ(searcher.get_SA_target_acceptance(), 0.3);
+
+    // Every schedule finds the best partition of this small dataset
+    searcher.set_seed(2);
+    searcher.set_SA_max_iter(5000);
+    MCM reference = searcher.simulated_annealing(data);
+    for (std::string schedule : {"geometric", "linear", "adaptive"}){
+        searcher.set_SA_schedule(schedule);
+        EXPECT_EQ(searcher.get_SA_schedule(), schedule);
+        MCM mcm = searcher.simulated_annealing(data);
+        EXPECT_FLOAT_EQ(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition));
+        EXPECT_FLOAT_EQ(mcm.get_best_log_ev(), reference.get_best_log_ev());
+    }
+
+    // Every reheat continues the annealing for at least another max_no_improve iterations
+    searcher.set_SA_max_no_improve(200);
+    searcher.set_seed(2);
+    searcher.simulated_annealing(data);
+    int n_steps = searcher.get_log_evidence_trajectory().size();
+    searcher.set_SA_reheats(3);
+    EXPECT_EQ(searcher.get_SA_reheats(), 3);
+    searcher.set_seed(2);
+    searcher.simulated_annealing(data);
+    EXPECT_GT(searcher.get_log_evidence_trajectory().size(), n_steps + 3 * 200 - 9);
+}
+
+TEST(search, auto_annealing) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    try {
+        searcher.get_SA_tuning();
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch(std::runtime_error const & err) {
+        EXPECT_EQ(err.what(), std::string("No tuning of the annealing has been ran."));
+    }
+    MCM mcm_in(4, "independent");
+    try {
+        searcher.auto_annealing(data, &mcm_in);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Number of variables in the data doesn't match the number of variables in the given MCM."));
+    }
+
+    searcher.set_seed(4);
+    searcher.set_n_threads(2);
+    MCM mcm = searcher.auto_annealing(data);
+    EXPECT_NEAR(mcm.get_best_log_ev(), -3300.4, 0.1);
+
+    // The chosen settings are only reported, the settings of the searcher don't change
+    SA_tuning tuning = searcher.get_SA_tuning();
+    EXPECT_GT(tuning.switch_delta, 0);
+    EXPECT_GT(tuning.init_temp, tuning.min_temp);
+    EXPECT_GT(tuning.min_temp, 0);
+    EXPECT_GT(tuning.cooling_rate, 0);
+    EXPECT_LT(tuning.cooling_rate, 1);
+    EXPECT_GT(tuning.update_schedule, 0);
+    EXPECT_GT(tuning.max_iter, 0);
+    MCMSearch default_searcher = MCMSearch();
+    EXPECT_DOUBLE_EQ(searcher.get_SA_init_temp(), default_searcher.get_SA_init_temp());
+    EXPECT_DOUBLE_EQ(searcher.get_SA_min_temp(), default_searcher.get_SA_min_temp());
+    EXPECT_DOUBLE_EQ(searcher.get_SA_cooling_rate(), default_searcher.get_SA_cooling_rate());
+    EXPECT_EQ(searcher.get_SA_update_schedule(), default_searcher.get_SA_update_schedule());
+    EXPECT_EQ(searcher.get_SA_max_iter(), default_searcher.get_SA_max_iter());
+    EXPECT_EQ(searcher.get_SA_schedule(), default_searcher.get_SA_schedule());
+
+    // The budget doubles until the pilot chains stop improving and never exceeds the maximum number of iterations
+    ASSERT_EQ(tuning.pilot_budgets.size(), tuning.pilot_log_evidences.size());
+    for (int i = 1; i < tuning.pilot_budgets.size(); i++){
+        EXPECT_EQ(tuning.pilot_budgets[i], 2 * tuning.pilot_budgets[i-1]);
+    }
+    EXPECT_LE(tuning.pilot_budgets.back(), 50000);
+    EXPECT_LE(tuning.max_iter, tuning.pilot_budgets.back());
+
+    // The result doesn't depend on the number of threads
+    searcher.set_seed(4);
+    searcher.set_n_threads(1);
+    EXPECT_EQ(searcher.auto_annealing(data).partition, mcm.partition);
+    EXPECT_EQ(searcher.get_SA_tuning().pilot_log_evidences, tuning.pilot_log_evidences);
+}
+
+// Enumerates all partitions of n variables as restricted growth strings
+static void enumerate_partitions(int var, int n, int n_comp, std::vector<int>& labels, std::vector<std::vector<int>>& partitions){
+    if (var == n){
+        partitions.push_back(labels);
+        return;
+    }
+    for (int k = 0; k <= n_comp; k++){
+        labels[var] = k;
+        enumerate_partitions(var + 1, n, std::max(n_comp, k + 1), labels, partitions);
+    }
+}
+
+TEST(search, posterior_sampling) {
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_sampling_chains(), 4);
+    EXPECT_EQ(searcher.get_sampling_iter(), 100000);
+    EXPECT_EQ(searcher.get_sampling_burn_in(), 10000);
+    try {
+        searcher.get_sampling_comembership();
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch(std::runtime_error const & err) {
+        EXPECT_EQ(err.what(), std::string("No posterior sampling has been ran."));
+    }
+    try {
+        searcher.set_sampling_chains(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of chains should be a positive number."));
+    }
+    try {
+        searcher.set_sampling_iter(0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of sampling iterations should be a positive number."));
+    }
+    try {
+        searcher.set_sampling_burn_in(-1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The number of burn-in iterations should be a non-negative number."));
+    }
+
+    // Few datapoints of five variables, such that the posterior is spread over many partitions
+    std::mt19937 generator(3);
+    std::ofstream file("posterior_test.dat");
+    for (int s = 0; s < 40; s++){
+        int a = generator() % 2;
+        int b = generator() % 2;
+        file << a << ((generator() % 5 == 0) ? 1-a : a) << b << ((generator() % 5 < 2) ? 1-b : b) << generator() % 2 << "\n";
+    }
+    file.close();
+    int n = 5;
+    Data data("posterior_test.dat", n, 2);
+    std::remove("posterior_test.dat");
+
+    // Exact posterior from all partitions
+    std::vector<std::vector<int>> partitions;
+    std::vector<int> labels(n, 0);
+    enumerate_partitions(0, n, 0, labels, partitions);
+    std::vector<double> log_evs;
+    double max_log_ev = -DBL_MAX;
+    for (std::vector<int>& p : partitions){
+        std::vector<__uint128_t> partition(n, 0);
+        for (int i = 0; i < n; i++){partition[p[i]] |= ((__uint128_t) 1 << i);}
+        log_evs.push_back(data.calc_log_ev(partition));
+        max_log_ev = std::max(max_log_ev, log_evs.back());
+    }
+    double Z = 0;
+    for (double log_ev : log_evs){Z += exp(log_ev - max_log_ev);}
+    std::vector<std::vector<double>> comembership(n, std::vector<double>(n, 0));
+    std::vector<double> n_comp(n + 1, 0);
+    for (int p = 0; p < partitions.size(); p++){
+        double prob = exp(log_evs[p] - max_log_ev) / Z;
+        n_comp[*std::max_element(partitions[p].begin(), partitions[p].end()) + 1] += prob;
+        for (int i = 0; i < n; i++){
+            for (int j = 0; j < n; j++){
+                if (partitions[p][i] == partitions[p][j]){comembership[i][j] += prob;}
+            }
+        }
+    }
+
+    searcher.set_seed(2);
+    searcher.set_n_threads(2);
+    MCM mcm = searcher.posterior_sampling(data);
+    EXPECT_NEAR(mcm.get_best_log_ev(), max_log_ev, 1e-6);
+    std::vector<std::vector<double>> estimate = searcher.get_sampling_comembership();
+    std::vector<double> estimate_n_comp = searcher.get_sampling_n_comp();
+    ASSERT_EQ(estimate.size(), n);
+    ASSERT_EQ(estimate_n_comp.size(), n + 1);
+    for (int i = 0; i < n; i++){
+        EXPECT_DOUBLE_EQ(estimate[i][i], 1);
+        for (int j = 0; j < n; j++){
+            EXPECT_DOUBLE_EQ(estimate[i][j], estimate[j][i]);
+            EXPECT_NEAR(estimate[i][j], comembership[i][j], 0.02);
+        }
+    }
+    double total = 0;
+    for (int k = 0; k <= n; k++){
+        EXPECT_NEAR(estimate_n_comp[k], n_comp[k], 0.02);
+        total += estimate_n_comp[k];
+    }
+    EXPECT_NEAR(total, 1, 1e-9);
+    EXPECT_EQ(searcher.get_sampling_acceptance().size(), 4);
+    for (double rate : searcher.get_sampling_acceptance()){
+        EXPECT_GT(rate, 0);
+        EXPECT_LE(rate, 1);
+    }
+
+    // The result doesn't depend on the number of threads
+    searcher.set_seed(2);
+    searcher.set_n_threads(1);
+    searcher.posterior_sampling(data);
+    EXPECT_EQ(searcher.get_sampling_comembership(), estimate);
+    EXPECT_EQ(searcher.get_sampling_n_comp(), estimate_n_comp);
+
+    // Mismatch between the data and the starting partition
+    MCM mcm_in(4, "independent");
+    try {
+        searcher.posterior_sampling(data, &mcm_in);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("Number of variables in the data doesn't match the number of variables in the given MCM."));
+    }
+}
+
+TEST(search, stop_condition) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_EQ(searcher.get_time_limit(), 0);
+    try {
+        searcher.set_time_limit(-1);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The time limit should be a non-negative number."));
+    }
+    try {
+        searcher.set_progress_callback([](const SearchProgress& progress){return true;}, 0);
+        FAIL() << "Expected std::invalid_argument";
+    }
+    catch(std::invalid_argument const & err) {
+        EXPECT_EQ(err.what(), std::string("The interval between two progress reports should be positive."));
+    }
+
+    // A search without limits finishes
+    searcher.set_seed(1);
+    MCM mcm = searcher.greedy_search(data);
+    EXPECT_FALSE(mcm.truncated);
+
+    // An annealing that never converges stops at the time limit with the best partition so far
+    searcher.set_SA_max_iter(2000000000);
+    searcher.set_SA_max_no_improve(2000000000);
+    searcher.set_time_limit(0.2);
+    auto start = std::chrono::steady_clock::now();
+    mcm = searcher.simulated_annealing(data);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_TRUE(searcher.get_mcm_out().truncated);
+    EXPECT_GE(elapsed, 0.2);
+    EXPECT_LT(elapsed, 5);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+
+    // The searches within a search share the time limit of the outermost search
+    start = std::chrono::steady_clock::now();
+    mcm = searcher.multistart_search(data, "annealing");
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_LT(elapsed, 5);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+
+    // Cancellation from another thread
+    searcher.set_time_limit(0);
+    CancellationToken token;
+    searcher.set_cancellation_token(token);
+    std::thread canceller([token]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        token.cancel();
+    });
+    searcher.set_n_threads(2);
+    mcm = searcher.parallel_tempering(data);
+    canceller.join();
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+
+    // Every search returns a valid partition when it is cancelled before it starts
+    mcm = searcher.greedy_search(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_EQ(mcm.n_comp, 9);
+    mcm = searcher.divide_and_conquer(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_EQ(mcm.n_comp, 1);
+    mcm = searcher.exhaustive_search(data, 0, 1, "stopped_shard.dat");
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+    // The result of a shard is only written if all its partitions were enumerated
+    EXPECT_FALSE(std::ifstream("stopped_shard.dat").good());
+    for (std::string method : {"greedy", "divide_and_conquer", "annealing"}){
+        mcm = searcher.multistart_search(data, method);
+        EXPECT_TRUE(mcm.truncated);
+        EXPECT_EQ(searcher.get_multistart_log_evidences().size(), 1);
+        EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+    }
+    MCM mcm_in(9, "random", 3);
+    mcm = searcher.refine(data, &mcm_in);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm_in.partition), 1e-6);
+    mcm = searcher.multilevel_search(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+
+    // The estimates of a stopped sampling are based on the samples so far
+    mcm = searcher.posterior_sampling(data);
+    EXPECT_TRUE(mcm.truncated);
+    std::vector<double> n_comp = searcher.get_sampling_n_comp();
+    double total = 0;
+    for (double p : n_comp){total += p;}
+    EXPECT_NEAR(total, 1, 1e-9);
+    EXPECT_DOUBLE_EQ(searcher.get_sampling_comembership()[0][0], 1);
+
+    // The token is not reset by the search
+    token.reset();
+    mcm = searcher.greedy_search(data);
+    EXPECT_FALSE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), -3300.4, 0.1);
+
+    // The progress callback is called by the thread that runs the search, the search stops if it returns false
+    int n_calls = 0;
+    double last_elapsed = 0;
+    double last_log_ev = -DBL_MAX;
+    searcher.set_n_threads(1);
+    searcher.set_progress_callback([&](const SearchProgress& progress){
+        n_calls++;
+        last_elapsed = progress.elapsed;
+        last_log_ev = progress.log_ev;
+        return n_calls < 3;
+    }, 0.05);
+    mcm = searcher.simulated_annealing(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_EQ(n_calls, 3);
+    EXPECT_GE(last_elapsed, 0.15);
+    EXPECT_GT(last_log_ev, -DBL_MAX);
+    EXPECT_LE(last_log_ev, mcm.get_best_log_ev() + 1e-6);
+
+    // The tuning of the annealing shares the condition of the annealing it runs
+    n_calls = 0;
+    searcher.set_progress_callback([&](const SearchProgress& progress){return false;}, 1e-9);
+    mcm = searcher.auto_annealing(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+
+    // The stop is checked within the evaluation of the merges and splits, an interrupted round results in no merge or split
+    searcher.set_progress_callback([&](const SearchProgress& progress){return ++n_calls < 2;}, 1e-9);
+    n_calls = 0;
+    mcm = searcher.greedy_search(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_EQ(mcm.n_comp, 9);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+    n_calls = 0;
+    mcm = searcher.divide_and_conquer(data);
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_EQ(mcm.n_comp, 1);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+}
+
+TEST(search, portfolio) {
+    Data data("../input/US_SupremeCourt_n9_N895.dat", 9, 2);
+    MCMSearch searcher = MCMSearch();
+    EXPECT_THROW(searcher.get_portfolio_winner(), std::runtime_error);
+    EXPECT_THROW(searcher.get_portfolio_log_evidences(), std::runtime_error);
+
+    // The strategies run concurrently, the result is at least as good as the best strategy
+    searcher.set_n_threads(3);
+    searcher.set_seed(2);
+    MCM mcm = searcher.portfolio_search(data);
+    EXPECT_TRUE(mcm.optimized);
+    EXPECT_FALSE(mcm.truncated);
+    EXPECT_NEAR(mcm.get_best_log_ev(), -3300.4, 0.1);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+    std::vector<double> log_evidences = searcher.get_portfolio_log_evidences();
+    ASSERT_EQ(log_evidences.size(), 3);
+    for (double log_ev : log_evidences){
+        EXPECT_LE(log_ev, mcm.get_best_log_ev() + 1e-6);
+    }
+    std::string winner = searcher.get_portfolio_winner();
+    EXPECT_TRUE(winner == "greedy" || winner == "divide_and_conquer" || winner == "annealing");
+    std::vector<double> trajectory = searcher.get_log_evidence_trajectory();
+    EXPECT_NEAR(trajectory.back(), mcm.get_best_log_ev(), 1e-9);
+
+    // With one thread the strategies run in order, the annealing starts from the best partition of the greedy searches
+    searcher.set_n_threads(1);
+    searcher.set_seed(2);
+    mcm = searcher.portfolio_search(data);
+    log_evidences = searcher.get_portfolio_log_evidences();
+    EXPECT_GE(log_evidences[2], std::max(log_evidences[0], log_evidences[1]) - 1e-6);
+    EXPECT_NEAR(mcm.get_best_log_ev(), -3300.4, 0.1);
+    // The winner is the first strategy that found the best partition
+    double best = *std::max_element(log_evidences.begin(), log_evidences.end());
+    int first = (log_evidences[0] > best - 1e-6) ? 0 : ((log_evidences[1] > best - 1e-6) ? 1 : 2);
+    EXPECT_EQ(searcher.get_portfolio_winner(), std::vector<std::string>({"greedy", "divide_and_conquer", "annealing"})[first]);
+
+    // The time limit is the budget of the portfolio
+    searcher.set_n_threads(3);
+    searcher.set_SA_max_iter(2000000000);
+    searcher.set_SA_max_no_improve(2000000000);
+    searcher.set_time_limit(0.2);
+    auto start = std::chrono::steady_clock::now();
+    mcm = searcher.portfolio_search(data);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_TRUE(mcm.truncated);
+    EXPECT_LT(elapsed, 5);
+    EXPECT_NEAR(mcm.get_best_log_ev(), data.calc_log_ev(mcm.partition), 1e-6);
+}
@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+#include "../../include/utilities/parallel.h"
+
+#include <stdexcept>
+
+TEST(parallel, thread_pool){
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+
+    // The threads are reused by every call, every task is executed exactly once
+    for (int n_tasks : {0, 1, 3, 100}){
+        std::vector<int> counts(n_tasks, 0);
+        pool.run(n_tasks, [&](int i, int thread){
+            EXPECT_GE(thread, 0);
+            EXPECT_LT(thread, 4);
+            counts[i]++;
+        });
+        for (int count : counts){
+            EXPECT_EQ(count, 1);
+        }
+    }
+
+    // An exception of a task is rethrown by run, the pool can be used afterwards
+    try {
+        pool.run(50, [&](int i, int thread){
+            if (i == 10){throw std::runtime_error("Failed task");}
+        });
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch(std::runtime_error const & err) {
+        EXPECT_EQ(err.what(), std::string("Failed task"));
+    }
+    std::vector<int> counts(20, 0);
+    pool.run(20, [&](int i, int thread){counts[i]++;});
+    EXPECT_EQ(counts, std::vector<int>(20, 1));
+
+    // A pool of one thread runs the tasks on the calling thread
+    ThreadPool single(1);
+    EXPECT_EQ(single.size(), 1);
+    single.run(5, [&](int i, int thread){EXPECT_EQ(thread, 0);});
+}
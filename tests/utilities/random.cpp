@@ -0,0 +1,80 @@
+#include "gtest/gtest.h"
+#include "../../include/utilities/random.h"
+#include "../../include/utilities/miscellaneous.h"
+#include "../../include/utilities/partition.h"
+
+TEST(random, seed){
+    // The same seed gives the same sequence
+    RandomGenerator generator_1(42);
+    RandomGenerator generator_2(42);
+    RandomGenerator generator_3(43);
+    int n_equal = 0;
+    for (int i = 0; i < 100; i++){
+        uint64_t value = generator_1();
+        EXPECT_EQ(value, generator_2());
+        if (value == generator_3()){n_equal++;}
+    }
+    EXPECT_EQ(n_equal, 0);
+
+    // Seeding again restarts the sequence
+    generator_1.seed(42);
+    generator_2.seed(42);
+    EXPECT_EQ(generator_1(), generator_2());
+}
+
+TEST(random, jump){
+    // Jumped copies give different streams, jumping twice is the same as two copies that jump once
+    RandomGenerator generator(7);
+    RandomGenerator stream_1 = generator;
+    generator.jump();
+    RandomGenerator stream_2 = generator;
+
+    RandomGenerator twice(7);
+    twice.jump();
+    twice.jump();
+    generator.jump();
+    EXPECT_EQ(twice(), generator());
+    EXPECT_NE(stream_1(), stream_2());
+}
+
+TEST(random, uniform){
+    RandomGenerator generator(1);
+    std::vector<int> counts(3, 0);
+    for (int i = 0; i < 30000; i++){
+        int value = generator.uniform_int(3);
+        ASSERT_GE(value, 0);
+        ASSERT_LT(value, 3);
+        counts[value]++;
+
+        double u = generator.uniform_real();
+        ASSERT_GE(u, 0);
+        ASSERT_LT(u, 1);
+    }
+    for (int count : counts){
+        EXPECT_NEAR(count, 10000, 500);
+    }
+
+    // Random bits only below n
+    EXPECT_EQ(random_128_int(5, generator) >> 5, 0);
+    EXPECT_EQ(random_128_int(0, generator), 0);
+
+    // Random index of a bit that is set
+    __uint128_t integer = ((__uint128_t) 1 << 100) + 0b1010;
+    for (int i = 0; i < 100; i++){
+        int index = randomBitIndex(integer, generator);
+        EXPECT_TRUE(index == 1 || index == 3 || index == 100);
+    }
+}
+
+TEST(random, seeded_generator){
+    // A non-negative seed is reproducible
+    RandomGenerator generator_1 = seeded_generator(5);
+    RandomGenerator generator_2 = seeded_generator(5);
+    EXPECT_EQ(generator_1(), generator_2());
+    EXPECT_EQ(generate_random_partition(20, generator_1), generate_random_partition(20, generator_2));
+
+    // A negative seed continues the generator of the thread with a new stream
+    generator_1 = seeded_generator(-1);
+    generator_2 = seeded_generator(-1);
+    EXPECT_NE(generator_1(), generator_2());
+}